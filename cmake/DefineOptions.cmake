@@ -8,6 +8,10 @@ MACRO (DEFINE_OPTIONS extraOptions extraLibs)
     SET (${extraOptions} "${${extraOptions}} -DLUCENE_FS_MMAP")
   ENDIF(ENABLE_MMAP)
 
+  IF(ENABLE_ARENA)
+    SET (${extraOptions} "${${extraOptions}} -DLUCENE_ENABLE_ARENA")
+  ENDIF(ENABLE_ARENA)
+
   IF(ENABLE_DMALLOC)
     SET (${extraOptions} "${${extraOptions}} -DDMALLOC")
     IF ( DISABLE_MULTITHREADING )
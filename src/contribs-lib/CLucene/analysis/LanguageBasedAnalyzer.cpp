@@ -35,16 +35,36 @@ void LanguageBasedAnalyzer::setLanguage(const TCHAR* language){
 void LanguageBasedAnalyzer::setStem(bool stem){
 	this->stem = stem;
 }
-TokenStream* LanguageBasedAnalyzer::tokenStream(const TCHAR* fieldName, Reader* reader) {
+class LanguageBasedAnalyzer::SavedStreams : public TokenStream {
+public:
+	Tokenizer* tokenStream;
+	TokenStream* filteredTokenStream;
+	TCHAR lang[100];
+	bool stem;
+
+	SavedStreams():tokenStream(NULL), filteredTokenStream(NULL), stem(false)
+	{
+		lang[0] = 0;
+	}
+	virtual ~SavedStreams()
+	{
+		_CLDELETE(filteredTokenStream); // the tokenStream is deleted by the filters
+	}
+
+	void close(){}
+	Token* next(Token* /*token*/) {return NULL;}
+};
+
+TokenStream* LanguageBasedAnalyzer::createStream(Reader* reader, Tokenizer*& source) {
 	TokenStream* ret = NULL;
 	if ( _tcscmp(lang, _T("cjk"))==0 ){
-		ret = _CLNEW CL_NS2(analysis,cjk)::CJKTokenizer(reader);
+		ret = source = _CLNEW CL_NS2(analysis,cjk)::CJKTokenizer(reader);
 	}else{
     BufferedReader* bufferedReader = reader->__asBufferedReader();
     if ( bufferedReader == NULL )
-      ret =  _CLNEW StandardTokenizer( _CLNEW FilteredBufferedReader(reader, false), true );
+      ret = source = _CLNEW StandardTokenizer( _CLNEW FilteredBufferedReader(reader, false), true );
     else
-      ret = _CLNEW StandardTokenizer(bufferedReader);
+      ret = source = _CLNEW StandardTokenizer(bufferedReader);
 
 		ret = _CLNEW StandardFilter(ret,true);
 
@@ -64,4 +84,25 @@ TokenStream* LanguageBasedAnalyzer::tokenStream(const TCHAR* fieldName, Reader*
 	return ret;
 }
 
+TokenStream* LanguageBasedAnalyzer::tokenStream(const TCHAR* /*fieldName*/, Reader* reader) {
+	Tokenizer* source;
+	return createStream(reader, source);
+}
+
+TokenStream* LanguageBasedAnalyzer::reusableTokenStream(const TCHAR* /*fieldName*/, Reader* reader) {
+	SavedStreams* streams = reinterpret_cast<SavedStreams*>(getPreviousTokenStream());
+	if ( streams != NULL && streams->stem == stem && _tcscmp(streams->lang, lang) == 0 ){
+		streams->tokenStream->reset(reader);
+		return streams->filteredTokenStream;
+	}
+
+	// replaces the streams of another language, if any
+	streams = _CLNEW SavedStreams();
+	streams->filteredTokenStream = createStream(reader, streams->tokenStream);
+	_tcsncpy(streams->lang, lang, 100);
+	streams->stem = stem;
+	setPreviousTokenStream(streams);
+	return streams->filteredTokenStream;
+}
+
 CL_NS_END
@@ -14,12 +14,17 @@ CL_NS_DEF(analysis)
 class CLUCENE_CONTRIBS_EXPORT LanguageBasedAnalyzer: public CL_NS(analysis)::Analyzer{
 	TCHAR lang[100];
 	bool stem;
+	class SavedStreams;
+	TokenStream* createStream(CL_NS(util)::Reader* reader, Tokenizer*& source);
 public:
 	LanguageBasedAnalyzer(const TCHAR* language=NULL, bool stem=true);
 	~LanguageBasedAnalyzer();
 	void setLanguage(const TCHAR* language);
 	void setStem(bool stem);
 	TokenStream* tokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader);
+	/** Like tokenStream(), but reuses the streams of the previous call of the calling thread
+	* if the language and stemming did not change since */
+	TokenStream* reusableTokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader);
   };
 
 CL_NS_END
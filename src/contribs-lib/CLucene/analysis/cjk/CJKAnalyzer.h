@@ -84,6 +84,9 @@ public:
      */
 	CL_NS(analysis)::Token* next(CL_NS(analysis)::Token* token);
 
+	/** Reads from in from now on, so that the tokenizer can be reused */
+	void reset(CL_NS(util)::Reader* in);
+
 	bool getIgnoreSurrogates(){ return ignoreSurrogates; };
 	void setIgnoreSurrogates(bool ignoreSurrogates){ this->ignoreSurrogates = ignoreSurrogates; };
 };
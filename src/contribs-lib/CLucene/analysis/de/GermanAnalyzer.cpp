@@ -45,6 +45,10 @@ CL_NS_USE2(analysis,standard)
       SavedStreams():tokenStream(NULL), filteredTokenStream(NULL)
       {
       }
+      virtual ~SavedStreams()
+      {
+          _CLDELETE(filteredTokenStream); // the tokenStream is deleted by the filters
+      }
 
       void close(){}
       Token* next(Token* token) {return NULL;}
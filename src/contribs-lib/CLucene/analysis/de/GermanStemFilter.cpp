@@ -38,12 +38,11 @@ CL_NS_USE2(analysis,de)
       } else if (exclusionSet != NULL && exclusionSet->find(t->termBuffer()) != exclusionSet->end()) { // Check the exclusiontable
         return t;
       } else {
-        TCHAR* s = stemmer->stem(t->termBuffer(), t->termLength());
-        // If not stemmed, dont waste the time creating a new token
+        const TCHAR* s = stemmer->stemInBuffer(t->termBuffer(), t->termLength());
+        // If not stemmed, dont waste the time copying it into the token
         if (_tcscmp(s, t->termBuffer()) != 0) {
           t->setText(s);
         }
-        _CLDELETE_ARRAY(s);
         return t;
       }
     }
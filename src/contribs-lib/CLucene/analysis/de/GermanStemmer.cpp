@@ -16,16 +16,20 @@ CL_NS_USE2(analysis,de)
     }
 
     TCHAR* GermanStemmer::stem(const TCHAR* term, size_t length) {
-      if (length < 0) {
+      return STRDUP_TtoT(stemInBuffer(term, length));
+    }
+
+    const TCHAR* GermanStemmer::stemInBuffer(const TCHAR* term, size_t length) {
+      if (length == (size_t)-1) {
         length = _tcslen(term);
       }
 
-      // Reset the StringBuffer.
-      sb.clear();
+      // Reset the StringBuffer, keeping its buffer.
+      sb.deleteChars(0, sb.length());
       sb.append(term, length);
 
       if (!isStemmable(sb.getBuffer(), sb.length()))
-        return sb.giveBuffer();
+        return sb.getBuffer();
 
       // Stemming starts here...
       substitute(sb);
@@ -34,7 +38,7 @@ CL_NS_USE2(analysis,de)
       resubstitute(sb);
       removeParticleDenotion(sb);
 
-      return sb.giveBuffer();
+      return sb.getBuffer();
     }
 
     bool GermanStemmer::isStemmable(const TCHAR* term, size_t length) const {
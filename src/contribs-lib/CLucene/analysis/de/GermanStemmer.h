@@ -44,6 +44,13 @@ public:
      */
     TCHAR* stem(const TCHAR* term, size_t length = -1);
 
+    /**
+     * Stems the given term like stem(), into a buffer of this stemmer.
+     *
+     * @return      Discriminator for <tt>term</tt>, valid until the next call
+     */
+    const TCHAR* stemInBuffer(const TCHAR* term, size_t length = -1);
+
 private:
 
     /**
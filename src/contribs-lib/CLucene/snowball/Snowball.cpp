@@ -19,25 +19,55 @@ CL_NS_USE2(analysis,standard)
 
 CL_NS_DEF2(analysis,snowball)
 
+  class SnowballAnalyzer::SavedStreams : public TokenStream {
+  public:
+      StandardTokenizer* tokenStream;
+      TokenStream* filteredTokenStream;
+
+      SavedStreams():tokenStream(NULL), filteredTokenStream(NULL)
+      {
+      }
+      virtual ~SavedStreams()
+      {
+          _CLDELETE(filteredTokenStream); // the tokenStream is deleted by the filters
+      }
+
+      void close(){}
+      Token* next(Token* /*token*/) {return NULL;}
+  };
+
   /** Builds the named analyzer with no stop words. */
   SnowballAnalyzer::SnowballAnalyzer(const TCHAR* language) {
     this->language = STRDUP_TtoT(language);
 	stopSet = NULL;
+	stemCacheSize = 0;
   }
 
   SnowballAnalyzer::~SnowballAnalyzer(){
 	  _CLDELETE_CARRAY(language);
 	  if ( stopSet != NULL )
-		  _CLDELETE(stopSet);
+		  _CLDECDELETE(stopSet);
   }
 
   /** Builds the named analyzer with the given stop words.
   */
   SnowballAnalyzer::SnowballAnalyzer(const TCHAR* language, const TCHAR** stopWords) {
     this->language = STRDUP_TtoT(language);
+    stopSet = _CLNEW StopWordSet(stopWords);
+	stemCacheSize = 0;
+  }
 
-    stopSet = _CLNEW CLTCSetList(true);
-	StopFilter::fillStopTable(stopSet,stopWords);
+  SnowballAnalyzer::SnowballAnalyzer(const TCHAR* language, StopWordSet* stopWords) {
+    this->language = STRDUP_TtoT(language);
+    stopSet = _CL_POINTER(stopWords);
+	stemCacheSize = 0;
+  }
+
+  int32_t SnowballAnalyzer::getStemCacheSize() const{
+	  return stemCacheSize;
+  }
+  void SnowballAnalyzer::setStemCacheSize(const int32_t size){
+	  stemCacheSize = size;
   }
 
   TokenStream* SnowballAnalyzer::tokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader) {
@@ -59,23 +89,54 @@ CL_NS_DEF2(analysis,snowball)
     result = _CLNEW CL_NS(analysis)::LowerCaseFilter(result, true);
     if (stopSet != NULL)
       result = _CLNEW CL_NS(analysis)::StopFilter(result, true, stopSet);
-    result = _CLNEW SnowballFilter(result, language, true);
+    result = _CLNEW SnowballFilter(result, language, true, stemCacheSize);
     return result;
   }
-  
-  
-  
-  
-  
-  
-  
+
+  TokenStream* SnowballAnalyzer::reusableTokenStream(const TCHAR* /*fieldName*/, CL_NS(util)::Reader* reader) {
+    SavedStreams* streams = reinterpret_cast<SavedStreams*>(getPreviousTokenStream());
+
+    if (streams == NULL) {
+      streams = _CLNEW SavedStreams();
+      BufferedReader* bufferedReader = reader->__asBufferedReader();
+
+      if ( bufferedReader == NULL )
+        streams->tokenStream = _CLNEW StandardTokenizer( _CLNEW FilteredBufferedReader(reader, false), true );
+      else
+        streams->tokenStream = _CLNEW StandardTokenizer(bufferedReader);
+
+      streams->filteredTokenStream = _CLNEW StandardFilter(streams->tokenStream, true);
+      streams->filteredTokenStream = _CLNEW CL_NS(analysis)::LowerCaseFilter(streams->filteredTokenStream, true);
+      if (stopSet != NULL)
+        streams->filteredTokenStream = _CLNEW CL_NS(analysis)::StopFilter(streams->filteredTokenStream, true, stopSet);
+      streams->filteredTokenStream = _CLNEW SnowballFilter(streams->filteredTokenStream, language, true, stemCacheSize);
+      setPreviousTokenStream(streams);
+    } else
+      streams->tokenStream->reset(reader);
+
+    return streams->filteredTokenStream;
+  }
+
+  struct SnowballFilter::CacheEntry{
+	  int32_t keyLength;	// -1 if the entry is empty
+	  int32_t stemLength;
+	  TCHAR key[MAX_CACHED_LENGTH];
+	  TCHAR stem[MAX_CACHED_LENGTH];
+  };
+
     /** Construct the named stemming filter.
    *
    * @param in the input tokens to stem
    * @param name the name of a stemmer
    */
-	SnowballFilter::SnowballFilter(TokenStream* in, const TCHAR* language, bool deleteTS):
-		TokenFilter(in,deleteTS)
+	SnowballFilter::SnowballFilter(TokenStream* in, const TCHAR* language, bool deleteTS, int32_t cacheSize):
+		TokenFilter(in,deleteTS),
+		utf8(NULL),
+		utf8Len(0),
+		cache(NULL),
+		cacheMask(0),
+		cacheHits(0),
+		cacheMisses(0)
 	{
 		TCHAR tlang[50];
 		char lang[50];
@@ -88,10 +149,22 @@ CL_NS_DEF2(analysis,snowball)
 		if ( stemmer == NULL ){
 			_CLTHROWA(CL_ERR_IllegalArgument, "language not available for stemming\n"); //todo: richer error
 		}
+
+		if ( cacheSize > 0 ){
+			int32_t size = 1;
+			while ( size < cacheSize && size < 0x40000000 )
+				size <<= 1;
+			cache = _CL_NEWARRAY(CacheEntry, size);
+			for ( int32_t i=0;i<size;i++ )
+				cache[i].keyLength = -1;
+			cacheMask = size - 1;
+		}
     }
 
 	SnowballFilter::~SnowballFilter(){
 		sb_stemmer_delete(stemmer);
+		_CLDELETE_LARRAY(utf8);
+		_CLDELETE_LARRAY(cache);
 	}
 
   /** Returns the next input Token, after being stemmed */
@@ -99,39 +172,99 @@ CL_NS_DEF2(analysis,snowball)
     if (input->next(token) == NULL)
       return NULL;
 
-	unsigned char uctext[LUCENE_MAX_WORD_LEN+1];
-	TCHAR tchartext[LUCENE_MAX_WORD_LEN+1];
+	const int32_t len = token->termLength();
+	if ( cache == NULL || len > MAX_CACHED_LENGTH ){
+		stem(token);
+		return token;
+	}
 
-#ifdef _UCS2
-	char utf8text[4*LUCENE_MAX_WORD_LEN+1];
+	const TCHAR* text = token->termBuffer();
+	CacheEntry& entry = cache[Misc::thashCode(text, len) & cacheMask];
+	if ( entry.keyLength == len && memcmp(entry.key, text, len * sizeof(TCHAR)) == 0 ){
+		cacheHits++;
+		// only the text changes, the position increment of a stop filter is kept
+		TCHAR* buffer = token->resizeTermBuffer(entry.stemLength + 1);
+		memcpy(buffer, entry.stem, entry.stemLength * sizeof(TCHAR));
+		buffer[entry.stemLength] = 0;
+		token->setTermLength(entry.stemLength);
+		return token;
+	}
+
+	cacheMisses++;
+	// the key is only valid again once stem() returned, it may throw
+	entry.keyLength = -1;
+	memcpy(entry.key, text, len * sizeof(TCHAR));
+	stem(token);
+	const int32_t stemLength = token->termLength();
+	if ( stemLength <= MAX_CACHED_LENGTH ){
+		memcpy(entry.stem, token->termBuffer(), stemLength * sizeof(TCHAR));
+		entry.stemLength = stemLength;
+		entry.keyLength = len;
+	}else
+		entry.keyLength = -1;
+	return token;
+  }
+
+  void SnowballFilter::stem(Token* token){
+	const TCHAR* text = token->termBuffer();
+	const int32_t len = token->termLength();
+
+	// a character takes up to 6 bytes in the encoding of lucene_wctoutf8
+	if ( utf8Len < len * 6 + 1 ){
+		_CLDELETE_LARRAY(utf8);
+		utf8Len = len * 6 + 1;
+		utf8 = _CL_NEWARRAY(sb_symbol, utf8Len);
+	}
 
-	size_t len = lucene_wcstoutf8(utf8text,token->termBuffer(),4*LUCENE_MAX_WORD_LEN);
-	memcpy(uctext,utf8text,len);
-	uctext[len]='\0';
+	int32_t utf8Count = 0;
+	for ( int32_t i=0;i<len;i++ ){
+#ifdef _UCS2
+		const uint32_t c = static_cast<uint32_t>(text[i]);
+		if ( c < 0x80 )
+			utf8[utf8Count++] = static_cast<sb_symbol>(c);
+		else
+			utf8Count += lucene_wctoutf8(reinterpret_cast<char*>(utf8 + utf8Count), text[i]);
 #else
-	const char* tmp = token->termText();
-	int len = token->termTextLength();
-	for (int i=0;i<len+1;i++)
-		uctext[i]=tmp[i];
+		utf8[utf8Count++] = static_cast<sb_symbol>(text[i]);
 #endif
+	}
+	utf8[utf8Count] = 0;
 
-    const sb_symbol* stemmed = sb_stemmer_stem(stemmer, uctext, len);
+    const sb_symbol* stemmed = sb_stemmer_stem(stemmer, utf8, utf8Count);
 	if ( stemmed == NULL )
 		_CLTHROWA(CL_ERR_Runtime,"Out of memory");
 
-	int stemmedLen=sb_stemmer_length(stemmer);
+	const int32_t stemmedLen = sb_stemmer_length(stemmer);
 
+	// the stem is decoded into the token, it has no more characters than bytes.
+	// only the text changes, the position increment of a stop filter is kept
+	TCHAR* buffer = token->resizeTermBuffer(stemmedLen + 1);
+	int32_t count = 0;
+	for ( int32_t i=0;i<stemmedLen; ){
 #ifdef _UCS2
-	memcpy(utf8text,stemmed,stemmedLen);
-	utf8text[stemmedLen]=0;
-	lucene_utf8towcs(tchartext,utf8text,LUCENE_MAX_WORD_LEN);
+		if ( stemmed[i] < 0x80 ){
+			buffer[count++] = stemmed[i++];
+		}else{
+			wchar_t wc;
+			const size_t l = lucene_utf8towc(wc, reinterpret_cast<const char*>(stemmed + i));
+			if ( l == 0 )
+				break; // not valid, the stem ends here
+			buffer[count++] = wc;
+			i += (int32_t)l;
+		}
 #else
-	for (int i=0;i<stemmedLen+1;i++)
-		tchartext[i]=stemmed[i];
+		buffer[count++] = static_cast<TCHAR>(stemmed[i++]);
 #endif
-	token->set(tchartext,token->startOffset(), token->endOffset(), token->type());
-	return token;
+	}
+	buffer[count] = 0;
+	token->setTermLength(count);
   }
 
+  int64_t SnowballFilter::getCacheHits() const{
+	  return cacheHits;
+  }
+  int64_t SnowballFilter::getCacheMisses() const{
+	  return cacheMisses;
+  }
 
 CL_NS_END2
@@ -10,6 +10,7 @@
 #include "CLucene/analysis/AnalysisHeader.h"
 
 CL_CLASS_DEF(util,BufferedReader)
+CL_CLASS_DEF(analysis,StopWordSet)
 CL_NS_DEF2(analysis,snowball)
 
 /** Filters {@link StandardTokenizer} with {@link StandardFilter}, {@link
@@ -21,7 +22,9 @@ CL_NS_DEF2(analysis,snowball)
  */
 class CLUCENE_CONTRIBS_EXPORT SnowballAnalyzer: public Analyzer {
   TCHAR* language;
-  CLTCSetList* stopSet;
+  StopWordSet* stopSet;
+  int32_t stemCacheSize;
+  class SavedStreams;
 
 public:
   /** Builds the named analyzer with no stop words. */
@@ -31,12 +34,29 @@ public:
   */
   SnowballAnalyzer(const TCHAR* language, const TCHAR** stopWords);
 
+  /** Builds the named analyzer with the given stop words.
+  * @memory a reference to stopWords is held until the analyzer is deleted
+  */
+  SnowballAnalyzer(const TCHAR* language, StopWordSet* stopWords);
+
   ~SnowballAnalyzer();
 
+  /** The number of stems each {@link SnowballFilter} of this analyzer caches, 0 by default */
+  int32_t getStemCacheSize() const;
+  /**
+  * Sets the number of stems each {@link SnowballFilter} of this analyzer
+  * caches, or 0 for no cache. Applies to the token streams created after
+  * the call; the streams reused by a thread keep their cache.
+  */
+  void setStemCacheSize(const int32_t size);
+
   /** Constructs a {@link StandardTokenizer} filtered by a {@link
       StandardFilter}, a {@link LowerCaseFilter} and a {@link StopFilter}. */
   TokenStream* tokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader);
   TokenStream* tokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader, bool deleteReader);
+
+  /** Like tokenStream(), but reuses the streams of the previous call of the calling thread */
+  TokenStream* reusableTokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader);
 };
 
 CL_NS_END2
@@ -18,23 +18,53 @@ CL_NS_DEF2(analysis,snowball)
  * stemmer is the part of the class name before "Stemmer", e.g., the stemmer in
  * {@link EnglishStemmer} is named "English".
  *
- * Note: todo: This is not thread safe...
+ * The text of a token is encoded for the stemmer into a buffer of the filter
+ * and the stem is decoded straight into the term buffer of the token, so no
+ * memory is allocated once the buffers are large enough.
+ *
+ * The filter can keep the stems of the words it has seen in a cache of a
+ * fixed number of entries. A word that is found there is not stemmed again,
+ * which pays off for the frequent words of a text. The cache belongs to the
+ * filter, so filters reused by {@link Analyzer#reusableTokenStream} keep
+ * one cache per thread.
+ *
+ * Note: a filter must not be used by several threads at once.
  */
 class CLUCENE_CONTRIBS_EXPORT SnowballFilter: public TokenFilter {
+	struct CacheEntry;
+
 	struct sb_stemmer * stemmer;
+	sb_symbol* utf8;		// the text of the current token, encoded for the stemmer
+	int32_t utf8Len;		// the size of utf8
+	CacheEntry* cache;		// NULL if there is no cache
+	int32_t cacheMask;		// the size of the cache - 1
+	int64_t cacheHits;
+	int64_t cacheMisses;
+
+	// stems the text of token in place
+	void stem(Token* token);
 public:
+	/** Words longer than this are not kept in the cache, nor are their stems */
+	LUCENE_STATIC_CONSTANT(int32_t, MAX_CACHED_LENGTH=24);
 
   /** Construct the named stemming filter.
    *
    * @param in the input tokens to stem
    * @param name the name of a stemmer
+   * @param cacheSize the number of stems to cache, rounded up to a power
+   *                  of two, or 0 for no cache
    */
-	SnowballFilter(TokenStream* in, const TCHAR* language, bool deleteTS);
+	SnowballFilter(TokenStream* in, const TCHAR* language, bool deleteTS, int32_t cacheSize = 0);
 
 	~SnowballFilter();
 
     /** Returns the next input Token, after being stemmed */
     Token* next(Token* token);
+
+	/** The number of tokens whose stem was found in the cache */
+	int64_t getCacheHits() const;
+	/** The number of tokens that could be cached but were stemmed */
+	int64_t getCacheMisses() const;
 };
 
 CL_NS_END2
@@ -0,0 +1,193 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "stdafx.h"
+#include "Corpus.h"
+
+#include <algorithm>
+
+using namespace lucene::util;
+using namespace lucene::document;
+
+BenchmarkCorpus::BenchmarkCorpus():
+	nextDoc(0)
+{
+}
+BenchmarkCorpus::~BenchmarkCorpus(){
+}
+
+bool BenchmarkCorpus::next(Document& doc){
+	int32_t n;
+	{
+		SCOPED_LOCK_MUTEX(THIS_LOCK)
+		if ( nextDoc >= size() )
+			return false;
+		n = nextDoc++;
+	}
+
+	CorpusString title, body;
+	getDocument(n, title, body);
+
+	TCHAR buf[20];
+	_itot(n, buf, 10);
+	doc.add(*_CLNEW Field(_T("id"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+	//a rank that is not in index order, to sort on
+	_itot((n * 7919) % 10007, buf, 10);
+	doc.add(*_CLNEW Field(_T("rank"), buf, Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+	doc.add(*_CLNEW Field(_T("title"), title.c_str(), Field::STORE_YES | Field::INDEX_TOKENIZED));
+	doc.add(*_CLNEW Field(_T("body"), body.c_str(), Field::STORE_YES | Field::INDEX_TOKENIZED));
+	return true;
+}
+
+void BenchmarkCorpus::reset(){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	nextDoc = 0;
+}
+
+void BenchmarkCorpus::getBody(int32_t n, CorpusString& body){
+	CorpusString title;
+	getDocument(n, title, body);
+}
+
+
+ReutersCorpus::ReutersCorpus(){
+	char srcdir[1024];
+	strcpy(srcdir, clucene_data_location);
+	strcat(srcdir, "reuters-21578");
+
+	std::vector<std::string> files;
+	if ( !Misc::listFiles(srcdir, files, false) )
+		_CLTHROWA(CL_ERR_IO, "reuters-21578 data not found");
+	std::sort(files.begin(), files.end());
+
+	char path[1024];
+	for ( size_t i=0;i<files.size();i++ ){
+		if ( files[i].length() < 4 || files[i].compare(files[i].length()-4, 4, ".sgm") != 0 )
+			continue;
+		strcpy(path, srcdir);
+		strcat(path, "/");
+		strcat(path, files[i].c_str());
+		parse(path);
+	}
+	if ( bodies.empty() )
+		_CLTHROWA(CL_ERR_IO, "no reuters-21578 articles found");
+}
+
+//the text between open and close inside [from,to), or an empty string
+static CorpusString extract(const std::string& data, size_t from, size_t to, const char* open, const char* close){
+	CorpusString ret;
+	size_t start = data.find(open, from);
+	if ( start == std::string::npos || start >= to )
+		return ret;
+	start += strlen(open);
+	size_t end = data.find(close, start);
+	if ( end == std::string::npos || end > to )
+		return ret;
+	ret.reserve(end - start);
+	for ( size_t i=start;i<end;i++ )
+		ret += (TCHAR)(unsigned char)data[i];
+	return ret;
+}
+
+void ReutersCorpus::parse(const char* path){
+	FILE* f = fopen(path, "rb");
+	if ( f == NULL )
+		_CLTHROWA(CL_ERR_IO, "could not open reuters-21578 file");
+	std::string data;
+	char buf[8192];
+	size_t read;
+	while ( (read = fread(buf, 1, sizeof(buf), f)) > 0 )
+		data.append(buf, read);
+	fclose(f);
+
+	size_t pos = 0;
+	while ( (pos = data.find("<REUTERS", pos)) != std::string::npos ){
+		size_t end = data.find("</REUTERS>", pos);
+		if ( end == std::string::npos )
+			break;
+		CorpusString body = extract(data, pos, end, "<BODY>", "</BODY>");
+		if ( !body.empty() ){
+			titles.push_back(extract(data, pos, end, "<TITLE>", "</TITLE>"));
+			bodies.push_back(body);
+		}
+		pos = end;
+	}
+}
+
+void ReutersCorpus::getDocument(int32_t n, CorpusString& title, CorpusString& body){
+	title = titles[n];
+	body = bodies[n];
+}
+const char* ReutersCorpus::getName(){
+	return "reuters";
+}
+int32_t ReutersCorpus::size(){
+	return (int32_t)bodies.size();
+}
+
+
+#define SYNTHETIC_VOCABULARY 20000
+static const TCHAR* syllables[] = {
+	_T("ka"), _T("lo"), _T("mi"), _T("ne"), _T("ru"), _T("sa"), _T("te"), _T("vo"),
+	_T("zi"), _T("po"), _T("da"), _T("fe"), _T("gu"), _T("hi"), _T("jo"), _T("be")
+};
+
+//a small linear congruential generator, the same on all platforms
+static inline uint32_t nextRandom(uint32_t& seed){
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 8) & 0xFFFFFF;
+}
+
+SyntheticCorpus::SyntheticCorpus(int32_t numDocs):
+	numDocs(numDocs)
+{
+	double total = 0;
+	for ( int32_t i=0;i<SYNTHETIC_VOCABULARY;i++ ){
+		//zipf: the weight of a word is inversely proportional to its rank
+		total += 1.0 / (i + 1);
+		cumulative.push_back(total);
+
+		CorpusString w;
+		int32_t n = i + 16; //at least two syllables
+		while ( n > 0 ){
+			w += syllables[n % 16];
+			n /= 16;
+		}
+		words.push_back(w);
+	}
+}
+
+const TCHAR* SyntheticCorpus::word(uint32_t& seed){
+	double r = nextRandom(seed) / (double)0x1000000 * cumulative.back();
+	size_t i = std::upper_bound(cumulative.begin(), cumulative.end(), r) - cumulative.begin();
+	if ( i >= words.size() )
+		i = words.size() - 1;
+	return words[i].c_str();
+}
+
+void SyntheticCorpus::getDocument(int32_t n, CorpusString& title, CorpusString& body){
+	uint32_t seed = (uint32_t)n * 2654435761U + 1;
+	int32_t titleLength = 3 + nextRandom(seed) % 6;
+	int32_t bodyLength = 50 + nextRandom(seed) % 350;
+
+	title.clear();
+	for ( int32_t i=0;i<titleLength;i++ ){
+		if ( i > 0 ) title += _T(' ');
+		title += word(seed);
+	}
+	body.clear();
+	for ( int32_t i=0;i<bodyLength;i++ ){
+		if ( i > 0 ) body += (i % 12 == 0 ? _T('.') : _T(' '));
+		if ( i % 12 == 0 && i > 0 ) body += _T(' ');
+		body += word(seed);
+	}
+}
+const char* SyntheticCorpus::getName(){
+	return "synthetic";
+}
+int32_t SyntheticCorpus::size(){
+	return numDocs;
+}
@@ -0,0 +1,69 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#pragma once
+
+#include <string>
+#include <vector>
+
+typedef std::basic_string<TCHAR> CorpusString;
+
+/**
+* The documents indexed by the benchmarks. Every document has a tokenized
+* title and body, an untokenized id and an integer rank to sort on.
+* next() may be called by several indexing threads.
+*/
+class BenchmarkCorpus{
+	DEFINE_MUTEX(THIS_LOCK)
+	int32_t nextDoc;
+protected:
+	/** Sets the text of document n */
+	virtual void getDocument(int32_t n, CorpusString& title, CorpusString& body) = 0;
+public:
+	BenchmarkCorpus();
+	virtual ~BenchmarkCorpus();
+
+	virtual const char* getName() = 0;
+	virtual int32_t size() = 0;
+
+	/** Fills doc with the next document, returns false after the last one */
+	bool next(lucene::document::Document& doc);
+	/** Starts over with the first document */
+	void reset();
+
+	/** The body of document n, to pick phrases from */
+	void getBody(int32_t n, CorpusString& body);
+};
+
+/** The articles of the bundled reuters-21578 collection, read once */
+class ReutersCorpus: public BenchmarkCorpus{
+	std::vector<CorpusString> titles;
+	std::vector<CorpusString> bodies;
+	void parse(const char* path);
+protected:
+	void getDocument(int32_t n, CorpusString& title, CorpusString& body);
+public:
+	ReutersCorpus();
+	const char* getName();
+	int32_t size();
+};
+
+/**
+* Generated documents of any size: a zipf distributed vocabulary of
+* pronounceable words. Document n is always the same text.
+*/
+class SyntheticCorpus: public BenchmarkCorpus{
+	int32_t numDocs;
+	std::vector<double> cumulative;	//cumulative word weights
+	std::vector<CorpusString> words;
+	const TCHAR* word(uint32_t& seed);
+protected:
+	void getDocument(int32_t n, CorpusString& title, CorpusString& body);
+public:
+	SyntheticCorpus(int32_t numDocs);
+	const char* getName();
+	int32_t size();
+};
@@ -6,6 +6,10 @@
 ------------------------------------------------------------------------------*/
 #include "stdafx.h"
 #include "TestCLString.h"
+#include "TestPhraseQueries.h"
+#include "TestIndexing.h"
+#include "TestQueryMix.h"
+#include "Results.h"
 
 #ifdef COMPILER_MSVC
 #ifdef _DEBUG
@@ -44,8 +48,14 @@ int main( int argc, char** argv ){
 
 	Benchmarker bench;
 	TestCLString clstring;
+	TestPhraseQueries phrases;
+	TestIndexing indexing;
+	TestQueryMix queryMix;
 	bool ret_result = false;
 
+	if ( !parseBenchmarkOptions(argc, argv) )
+		return 1;
+
 	cl_tempDir = NULL;
 	if ( Misc::dir_Exists("/tmp") )
 		cl_tempDir = "/tmp";
@@ -92,11 +102,15 @@ int main( int argc, char** argv ){
 
 
 	bench.Add(&clstring);
+	bench.Add(&phrases);
+	bench.Add(&indexing);
+	bench.Add(&queryMix);
 	ret_result = bench.run();
 
 
 
 exit_point:
+	closeResults();
 	_lucene_shutdown(); //clears all static memory
     //print lucenebase debug
    
@@ -0,0 +1,159 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "stdafx.h"
+#include "Results.h"
+
+#include <algorithm>
+#include <stdlib.h>
+#ifndef _WIN32
+	#include <sys/resource.h>
+#endif
+
+using namespace lucene::store;
+
+BenchmarkOptions benchmarkOptions = {
+	"reuters",	//corpus
+	20000,		//syntheticDocs
+	16,			//ramBufferMB
+	0,			//maxBufferedDocs
+	10,			//mergeFactor
+	false,		//tieredMerges
+	1,			//threads
+	5,			//queryPasses
+	NULL,		//indexDir
+	NULL		//resultsFile
+};
+
+static FILE* resultsOut = NULL;
+
+static void printUsage(const char* name){
+	fprintf(stderr, "usage: %s [options]\n", name);
+	fprintf(stderr, "  -corpus reuters|synthetic  corpus of the query benchmark (reuters)\n");
+	fprintf(stderr, "  -docs n                    documents of the synthetic corpus (20000)\n");
+	fprintf(stderr, "  -ram mb                    RAM buffer of the writer (16)\n");
+	fprintf(stderr, "  -maxbuffered n             flush every n documents instead\n");
+	fprintf(stderr, "  -mergefactor n             merge factor (10)\n");
+	fprintf(stderr, "  -tiered                    use the TieredMergePolicy\n");
+	fprintf(stderr, "  -threads n                 indexing and search threads (1)\n");
+	fprintf(stderr, "  -passes n                  times each thread replays the queries (5)\n");
+	fprintf(stderr, "  -dir path                  index in this directory instead of in RAM\n");
+	fprintf(stderr, "  -o file                    write the results to file\n");
+}
+
+bool parseBenchmarkOptions(int argc, char** argv){
+	for ( int i=1;i<argc;i++ ){
+		const char* arg = argv[i];
+		const char* value = i+1 < argc ? argv[i+1] : NULL;
+		if ( strcmp(arg, "-tiered") == 0 ){
+			benchmarkOptions.tieredMerges = true;
+			continue;
+		}
+		if ( value == NULL ){
+			printUsage(argv[0]);
+			return false;
+		}
+		i++;
+		if ( strcmp(arg, "-corpus") == 0 && (strcmp(value, "reuters") == 0 || strcmp(value, "synthetic") == 0) )
+			benchmarkOptions.corpus = value;
+		else if ( strcmp(arg, "-docs") == 0 && atoi(value) > 0 )
+			benchmarkOptions.syntheticDocs = atoi(value);
+		else if ( strcmp(arg, "-ram") == 0 && atof(value) > 0 )
+			benchmarkOptions.ramBufferMB = (float_t)atof(value);
+		else if ( strcmp(arg, "-maxbuffered") == 0 && atoi(value) > 1 )
+			benchmarkOptions.maxBufferedDocs = atoi(value);
+		else if ( strcmp(arg, "-mergefactor") == 0 && atoi(value) > 1 )
+			benchmarkOptions.mergeFactor = atoi(value);
+		else if ( strcmp(arg, "-threads") == 0 && atoi(value) > 0 )
+			benchmarkOptions.threads = atoi(value);
+		else if ( strcmp(arg, "-passes") == 0 && atoi(value) > 0 )
+			benchmarkOptions.queryPasses = atoi(value);
+		else if ( strcmp(arg, "-dir") == 0 )
+			benchmarkOptions.indexDir = value;
+		else if ( strcmp(arg, "-o") == 0 )
+			benchmarkOptions.resultsFile = value;
+		else{
+			printUsage(argv[0]);
+			return false;
+		}
+	}
+
+	if ( benchmarkOptions.resultsFile != NULL ){
+		resultsOut = fopen(benchmarkOptions.resultsFile, "w");
+		if ( resultsOut == NULL ){
+			fprintf(stderr, "can't write to %s\n", benchmarkOptions.resultsFile);
+			return false;
+		}
+	}
+	return true;
+}
+
+void reportResult(const char* benchmark, const char* metric, double value){
+	if ( resultsOut != NULL ){
+		fprintf(resultsOut, "%s\t%s\t%.3f\n", benchmark, metric, value);
+		fflush(resultsOut);
+	}else
+		printf("RESULT\t%s\t%s\t%.3f\n", benchmark, metric, value);
+}
+
+void closeResults(){
+	if ( resultsOut != NULL ){
+		fclose(resultsOut);
+		resultsOut = NULL;
+	}
+}
+
+int64_t peakMemoryKB(){
+#ifndef _WIN32
+	struct rusage usage;
+	if ( getrusage(RUSAGE_SELF, &usage) == 0 ){
+	#ifdef __APPLE__
+		return usage.ru_maxrss / 1024; //bytes
+	#else
+		return usage.ru_maxrss;
+	#endif
+	}
+#endif
+	return 0;
+}
+
+int64_t directorySize(Directory* dir){
+	std::vector<std::string> files;
+	dir->list(&files);
+	int64_t size = 0;
+	for ( size_t i=0;i<files.size();i++ )
+		size += dir->fileLength(files[i].c_str());
+	return size;
+}
+
+
+void LatencyStats::add(int32_t micros){
+	samples.push_back(micros);
+}
+void LatencyStats::addAll(const LatencyStats& other){
+	samples.insert(samples.end(), other.samples.begin(), other.samples.end());
+}
+size_t LatencyStats::count() const{
+	return samples.size();
+}
+int32_t LatencyStats::percentile(double p){
+	if ( samples.empty() )
+		return 0;
+	std::sort(samples.begin(), samples.end());
+	size_t i = (size_t)(p / 100 * samples.size());
+	if ( i >= samples.size() )
+		i = samples.size() - 1;
+	return samples[i];
+}
+void LatencyStats::report(const char* benchmark, int64_t wallMicros){
+	reportResult(benchmark, "count", (double)samples.size());
+	if ( wallMicros > 0 )
+		reportResult(benchmark, "per_sec", samples.size() * 1000000.0 / wallMicros);
+	reportResult(benchmark, "p50_us", percentile(50));
+	reportResult(benchmark, "p90_us", percentile(90));
+	reportResult(benchmark, "p99_us", percentile(99));
+	reportResult(benchmark, "max_us", percentile(100));
+}
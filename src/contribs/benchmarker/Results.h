@@ -0,0 +1,53 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#pragma once
+
+#include <vector>
+
+//settings of the indexing and search benchmarks, set from the command line
+struct BenchmarkOptions{
+	const char* corpus;		//-corpus reuters|synthetic: corpus of the query benchmark
+	int32_t syntheticDocs;	//-docs n: size of the synthetic corpus
+	float_t ramBufferMB;	//-ram mb: RAM buffer of the writer
+	int32_t maxBufferedDocs;//-maxbuffered n: flush by doc count instead of RAM
+	int32_t mergeFactor;	//-mergefactor n
+	bool tieredMerges;		//-tiered: TieredMergePolicy instead of the default policy
+	int32_t threads;		//-threads n: indexing and searching threads
+	int32_t queryPasses;	//-passes n: times each thread replays the query mix
+	const char* indexDir;	//-dir path: index on disk instead of in RAM
+	const char* resultsFile;//-o file: where the results are written, stdout by default
+};
+extern BenchmarkOptions benchmarkOptions;
+
+/** Parses the options, returns false and prints the usage if they are wrong */
+bool parseBenchmarkOptions(int argc, char** argv);
+
+/**
+* Writes a result as a tab separated line: benchmark, metric, value.
+* The lines go to the -o file, or to stdout prefixed with RESULT.
+*/
+void reportResult(const char* benchmark, const char* metric, double value);
+void closeResults();
+
+/** Peak resident memory of the process in KB, or 0 if unknown */
+int64_t peakMemoryKB();
+
+/** Size of all files in a directory */
+int64_t directorySize(lucene::store::Directory* dir);
+
+/** Latencies of one kind of operation, in microseconds */
+class LatencyStats{
+	std::vector<int32_t> samples;
+public:
+	void add(int32_t micros);
+	void addAll(const LatencyStats& other);
+	size_t count() const;
+	/** The latency that p percent of the samples don't exceed */
+	int32_t percentile(double p);
+	/** Reports count, throughput over wallMicros and p50/p90/p99/max */
+	void report(const char* benchmark, int64_t wallMicros);
+};
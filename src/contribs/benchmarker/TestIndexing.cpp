@@ -0,0 +1,142 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "stdafx.h"
+#include "TestIndexing.h"
+#include "Corpus.h"
+#include "Results.h"
+#include "CLucene/index/MergePolicy.h"
+
+using namespace lucene::util;
+using namespace lucene::analysis;
+using namespace lucene::analysis::standard;
+using namespace lucene::document;
+using namespace lucene::index;
+using namespace lucene::store;
+
+struct IndexingThread{
+	IndexWriter* writer;
+	BenchmarkCorpus* corpus;
+	int32_t docs;
+	bool failed;
+};
+
+_LUCENE_THREAD_FUNC(indexingThread, _arg){
+	IndexingThread* arg = (IndexingThread*)_arg;
+	try{
+		for (;;){
+			Document doc;
+			if ( !arg->corpus->next(doc) )
+				break;
+			arg->writer->addDocument(&doc);
+			arg->docs++;
+		}
+	}catch(CLuceneError& err){
+		fprintf(stderr, "\n > indexing error: %s\n", err.what());
+		arg->failed = true;
+	}
+	_LUCENE_THREAD_FUNC_RETURN(0);
+}
+
+int32_t indexCorpus(BenchmarkCorpus* corpus, Directory* dir, const char* benchmark){
+	StandardAnalyzer an;
+	IndexWriter writer(dir, &an, true);
+	writer.setMaxFieldLength(0x7FFFFFFF);
+	if ( benchmarkOptions.maxBufferedDocs > 0 ){
+		writer.setMaxBufferedDocs(benchmarkOptions.maxBufferedDocs);
+		writer.setRAMBufferSizeMB(IndexWriter::DISABLE_AUTO_FLUSH);
+	}else
+		writer.setRAMBufferSizeMB(benchmarkOptions.ramBufferMB);
+	if ( benchmarkOptions.tieredMerges ){
+		TieredMergePolicy* policy = _CLNEW TieredMergePolicy();
+		policy->setSegmentsPerTier(benchmarkOptions.mergeFactor);
+		policy->setMaxMergeAtOnce(benchmarkOptions.mergeFactor);
+		writer.setMergePolicy(policy);
+	}else
+		writer.setMergeFactor(benchmarkOptions.mergeFactor);
+
+	corpus->reset();
+	const int32_t threadCount = benchmarkOptions.threads;
+	IndexingThread* args = _CL_NEWARRAY(IndexingThread, threadCount);
+	_LUCENE_THREADID_TYPE* threads = _CL_NEWARRAY(_LUCENE_THREADID_TYPE, threadCount);
+
+	//adding includes the flushes and merges triggered while adding
+	int64_t start = Misc::currentTimeMicros();
+	for ( int32_t i=0;i<threadCount;i++ ){
+		args[i].writer = &writer;
+		args[i].corpus = corpus;
+		args[i].docs = 0;
+		args[i].failed = false;
+		threads[i] = _LUCENE_THREAD_CREATE(&indexingThread, &args[i]);
+	}
+	int32_t docs = 0;
+	bool failed = false;
+	for ( int32_t i=0;i<threadCount;i++ ){
+		_LUCENE_THREAD_JOIN(threads[i]);
+		docs += args[i].docs;
+		failed |= args[i].failed;
+	}
+	_CLDELETE_ARRAY(threads);
+	_CLDELETE_ARRAY(args);
+	int64_t added = Misc::currentTimeMicros();
+
+	writer.flush();
+	int64_t flushed = Misc::currentTimeMicros();
+	writer.optimize();
+	int64_t optimized = Misc::currentTimeMicros();
+	writer.close();
+
+	if ( failed )
+		_CLTHROWA(CL_ERR_Runtime, "indexing failed");
+
+	if ( benchmark != NULL ){
+		reportResult(benchmark, "docs", docs);
+		reportResult(benchmark, "add_ms", (added - start) / 1000.0);
+		reportResult(benchmark, "flush_ms", (flushed - added) / 1000.0);
+		reportResult(benchmark, "optimize_ms", (optimized - flushed) / 1000.0);
+		reportResult(benchmark, "docs_per_sec", docs * 1000000.0 / (flushed - start > 0 ? flushed - start : 1));
+		reportResult(benchmark, "index_bytes", (double)directorySize(dir));
+		reportResult(benchmark, "peak_rss_kb", (double)peakMemoryKB());
+	}
+	return docs;
+}
+
+static int runIndexing(Timer* timerCase, BenchmarkCorpus* corpus, const char* benchmark){
+	Directory* dir;
+	if ( benchmarkOptions.indexDir != NULL )
+		dir = FSDirectory::getDirectory(benchmarkOptions.indexDir);
+	else
+		dir = _CLNEW RAMDirectory();
+
+	int32_t docs = 0;
+	try{
+		timerCase->start();
+		docs = indexCorpus(corpus, dir, benchmark);
+		timerCase->stop();
+	}_CLFINALLY(
+		dir->close();
+		_CLDECDELETE(dir);
+	)
+	return docs == corpus->size() ? 0 : 1;
+}
+
+static ReutersCorpus* reuters = NULL;
+
+int BenchmarkIndexReuters(Timer* timerCase){
+	//the articles are read once, outside of the timed region
+	if ( reuters == NULL )
+		reuters = _CLNEW ReutersCorpus();
+	return runIndexing(timerCase, reuters, "index.reuters");
+}
+
+int BenchmarkIndexSynthetic(Timer* timerCase){
+	SyntheticCorpus corpus(benchmarkOptions.syntheticDocs);
+	return runIndexing(timerCase, &corpus, "index.synthetic");
+}
+
+void CleanupIndexing(){
+	_CLDELETE(reuters);
+}
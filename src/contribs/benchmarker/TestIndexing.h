@@ -0,0 +1,35 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#pragma once
+
+class BenchmarkCorpus;
+
+int BenchmarkIndexReuters(Timer*);
+int BenchmarkIndexSynthetic(Timer*);
+void CleanupIndexing();
+
+/**
+* Indexes the whole corpus into dir with the writer settings of the
+* command line, using the -threads indexing threads, and optimizes it.
+* Reports the indexing results under benchmark if it is not NULL.
+* @return the number of documents indexed
+*/
+int32_t indexCorpus(BenchmarkCorpus* corpus, lucene::store::Directory* dir, const char* benchmark);
+
+class TestIndexing:public Unit
+{
+protected:
+	void runTests(){
+		this->runTest("BenchmarkIndexReuters",BenchmarkIndexReuters,3);
+		this->runTest("BenchmarkIndexSynthetic",BenchmarkIndexSynthetic,3);
+		CleanupIndexing();
+	}
+public:
+	const char* getName(){
+		return "TestIndexing";
+	}
+};
@@ -0,0 +1,115 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "stdafx.h"
+#include "TestPhraseQueries.h"
+#include "CLucene/util/StringBuffer.h"
+
+#include <string>
+#include <vector>
+
+using namespace lucene::util;
+using namespace lucene::analysis;
+using namespace lucene::analysis::standard;
+using namespace lucene::document;
+using namespace lucene::index;
+using namespace lucene::store;
+using namespace lucene::search;
+using namespace lucene::queryParser;
+
+//a phrase-heavy query log: mixes rare/common terms, repeated terms
+//and phrases that only partially occur, like real user searches do
+static const TCHAR* phraseLog[] = {
+	_T("interest rates"), _T("stock exchange"), _T("the company said"),
+	_T("new york"), _T("per cent"), _T("central bank"), _T("oil prices"),
+	_T("federal reserve"), _T("trade deficit"), _T("of the"), _T("in the world"),
+	_T("the united states"), _T("foreign exchange"), _T("the the"),
+	_T("gross domestic product"), _T("crude oil production"), _T("a a"),
+	_T("agreement in principle"), _T("natural resources"), _T("money market"),
+	NULL
+};
+
+static RAMDirectory* phraseDirectory = NULL;
+
+static RAMDirectory* getPhraseDirectory(){
+	if ( phraseDirectory != NULL )
+		return phraseDirectory;
+
+	char srcdir[1024];
+	strcpy(srcdir, clucene_data_location);
+	strcat(srcdir, "reuters-21578");
+
+	std::vector<std::string> files;
+	if ( !Misc::listFiles(srcdir, files, false) )
+		_CLTHROWA(CL_ERR_IO, "reuters-21578 data not found");
+
+	phraseDirectory = _CLNEW RAMDirectory();
+	StandardAnalyzer an;
+	IndexWriter writer(phraseDirectory, &an, true);
+	writer.setMaxFieldLength(0x7FFFFFFF);
+
+	char path[1024];
+	for ( size_t i=0;i<files.size();i++ ){
+		strcpy(path, srcdir);
+		strcat(path, "/");
+		strcat(path, files[i].c_str());
+
+		Document doc;
+		doc.add(*_CLNEW Field(_T("contents"), _CLNEW FileReader(path, "ASCII"), Field::INDEX_TOKENIZED));
+		writer.addDocument(&doc);
+	}
+	writer.optimize();
+	writer.close();
+	return phraseDirectory;
+}
+
+static int runPhraseLog(Timer* timerCase, const TCHAR* suffix){
+	StandardAnalyzer an;
+	IndexSearcher searcher(getPhraseDirectory());
+
+	//parse outside of the timed region, only scoring is measured
+	std::vector<Query*> queries;
+	StringBuffer qry;
+	for ( int i=0;phraseLog[i]!=NULL;i++ ){
+		qry.clear();
+		qry.appendChar(_T('"'));
+		qry.append(phraseLog[i]);
+		qry.appendChar(_T('"'));
+		qry.append(suffix);
+		queries.push_back(QueryParser::parse(qry.getBuffer(), _T("contents"), &an));
+	}
+
+	int32_t totalHits = 0;
+	timerCase->start();
+	for ( int pass=0;pass<10;pass++ ){
+		for ( size_t i=0;i<queries.size();i++ ){
+			TopDocs* top = searcher._search(queries[i], NULL, NULL, 10);
+			totalHits += top->totalHits;
+			_CLDELETE(top);
+		}
+	}
+	timerCase->stop();
+
+	for ( size_t i=0;i<queries.size();i++ )
+		_CLDELETE(queries[i]);
+	searcher.close();
+	return totalHits > 0 ? 0 : 1;
+}
+
+int BenchmarkExactPhrases(Timer* timerCase){
+	return runPhraseLog(timerCase, _T(""));
+}
+
+int BenchmarkSloppyPhrases(Timer* timerCase){
+	return runPhraseLog(timerCase, _T("~3"));
+}
+
+void CleanupPhraseQueries(){
+	if ( phraseDirectory != NULL ){
+		phraseDirectory->close();
+		_CLDELETE(phraseDirectory);
+	}
+}
@@ -0,0 +1,25 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#pragma once
+
+int BenchmarkExactPhrases(Timer*);
+int BenchmarkSloppyPhrases(Timer*);
+void CleanupPhraseQueries();
+
+class TestPhraseQueries:public Unit
+{
+protected:
+	void runTests(){
+		this->runTest("BenchmarkExactPhrases",BenchmarkExactPhrases,10);
+		this->runTest("BenchmarkSloppyPhrases",BenchmarkSloppyPhrases,10);
+		CleanupPhraseQueries();
+	}
+public:
+	const char* getName(){
+		return "TestPhraseQueries";
+	}
+};
@@ -0,0 +1,322 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "stdafx.h"
+#include "TestQueryMix.h"
+#include "TestIndexing.h"
+#include "Corpus.h"
+#include "Results.h"
+#include "CLucene/search/spans/SpanTermQuery.h"
+#include "CLucene/search/spans/SpanNearQuery.h"
+#include "CLucene/search/FieldDoc.h"
+
+#include <string>
+#include <vector>
+
+using namespace lucene::util;
+using namespace lucene::analysis;
+using namespace lucene::analysis::standard;
+using namespace lucene::index;
+using namespace lucene::store;
+using namespace lucene::search;
+using namespace lucene::search::spans;
+
+#define QUERIES_PER_KIND 32
+#define FUZZY_QUERIES 8		//each one enumerates the whole term dictionary
+#define MAX_PREFIX_TERMS 512
+
+//the queries of one kind, replayed by every search thread
+struct QueryKind{
+	const char* name;
+	bool sorted;
+	std::vector<Query*> queries;
+	QueryKind(const char* name, bool sorted):
+		name(name), sorted(sorted)
+	{
+	}
+};
+
+static BenchmarkCorpus* mixCorpus = NULL;
+static RAMDirectory* mixDirectory = NULL;
+
+static RAMDirectory* getMixDirectory(){
+	if ( mixDirectory != NULL )
+		return mixDirectory;
+	if ( strcmp(benchmarkOptions.corpus, "synthetic") == 0 )
+		mixCorpus = _CLNEW SyntheticCorpus(benchmarkOptions.syntheticDocs);
+	else
+		mixCorpus = _CLNEW ReutersCorpus();
+	mixDirectory = _CLNEW RAMDirectory();
+	indexCorpus(mixCorpus, mixDirectory, NULL);
+	return mixDirectory;
+}
+
+//body terms in at least two documents, evenly spread over the dictionary
+static void sampleTerms(IndexReader* reader, std::vector<Term*>& sample){
+	std::vector<Term*> candidates;
+	Term start(_T("body"), _T(""));
+	TermEnum* te = reader->terms(&start);
+	do{
+		Term* t = te->term(false);
+		if ( t == NULL || _tcscmp(t->field(), _T("body")) != 0 )
+			break;
+		if ( te->docFreq() >= 2 )
+			candidates.push_back(te->term());
+	}while ( te->next() );
+	te->close();
+	_CLDELETE(te);
+
+	size_t step = candidates.size() / (QUERIES_PER_KIND * 2) + 1;
+	for ( size_t i=0;i<candidates.size();i++ ){
+		if ( i % step == 0 )
+			sample.push_back(candidates[i]);
+		else
+			_CLDECDELETE(candidates[i]);
+	}
+}
+
+//number of terms a prefix query on prefix expands to, stops counting past the limit
+static int32_t countPrefixTerms(IndexReader* reader, Term* prefix){
+	int32_t count = 0;
+	size_t len = _tcslen(prefix->text());
+	TermEnum* te = reader->terms(prefix);
+	do{
+		Term* t = te->term(false);
+		if ( t == NULL || _tcscmp(t->field(), prefix->field()) != 0 || _tcsncmp(t->text(), prefix->text(), len) != 0 )
+			break;
+		count++;
+	}while ( count <= MAX_PREFIX_TERMS && te->next() );
+	te->close();
+	_CLDELETE(te);
+	return count;
+}
+
+//count consecutive tokens from the body of document n, a stop word gap starts over
+static bool samplePhrase(BenchmarkCorpus* corpus, int32_t n, size_t count, std::vector<CorpusString>& phrase){
+	CorpusString body;
+	corpus->getBody(n, body);
+	StandardAnalyzer an;
+	StringReader reader(body.c_str(), (int32_t)body.length(), false);
+	TokenStream* ts = an.tokenStream(_T("body"), &reader);
+	Token t;
+	int32_t skip = n % 7;
+	phrase.clear();
+	while ( phrase.size() < count && ts->next(&t) != NULL ){
+		if ( skip > 0 ){
+			skip--;
+			continue;
+		}
+		if ( t.getPositionIncrement() != 1 )
+			phrase.clear();
+		phrase.push_back(CorpusString(t.termBuffer(), t.termLength()));
+	}
+	ts->close();
+	_CLDELETE(ts);
+	return phrase.size() == count;
+}
+
+static void buildQueries(IndexReader* reader, BenchmarkCorpus* corpus, std::vector<QueryKind>& kinds){
+	std::vector<Term*> terms;
+	sampleTerms(reader, terms);
+	const size_t nterms = terms.size();
+
+	QueryKind term("search.term", false);
+	QueryKind conj("search.boolean_and", false);
+	QueryKind disj("search.boolean_or", false);
+	QueryKind phrase("search.phrase", false);
+	QueryKind prefix("search.prefix", false);
+	QueryKind fuzzy("search.fuzzy", false);
+	QueryKind span("search.span_near", false);
+	QueryKind sorted("search.sorted", true);
+
+	for ( size_t i=0;i<nterms && term.queries.size()<QUERIES_PER_KIND;i+=2 ){
+		term.queries.push_back(_CLNEW TermQuery(terms[i]));
+		sorted.queries.push_back(_CLNEW TermQuery(terms[i]));
+	}
+
+	//pair every term with one from the other half of the sample
+	for ( size_t i=0;i<nterms/2 && conj.queries.size()<QUERIES_PER_KIND;i++ ){
+		BooleanQuery* bq = _CLNEW BooleanQuery();
+		bq->add(_CLNEW TermQuery(terms[i]), true, BooleanClause::MUST);
+		bq->add(_CLNEW TermQuery(terms[i + nterms/2]), true, BooleanClause::MUST);
+		conj.queries.push_back(bq);
+
+		bq = _CLNEW BooleanQuery();
+		bq->add(_CLNEW TermQuery(terms[i]), true, BooleanClause::SHOULD);
+		bq->add(_CLNEW TermQuery(terms[i + nterms/2]), true, BooleanClause::SHOULD);
+		bq->add(_CLNEW TermQuery(terms[nterms - 1 - i]), true, BooleanClause::SHOULD);
+		disj.queries.push_back(bq);
+	}
+
+	for ( size_t i=0;i<nterms;i++ ){
+		const TCHAR* text = terms[i]->text();
+		size_t len = _tcslen(text);
+		if ( len >= 4 && prefix.queries.size() < QUERIES_PER_KIND ){
+			TCHAR buf[4];
+			_tcsncpy(buf, text, 3);
+			buf[3] = 0;
+			Term* p = _CLNEW Term(_T("body"), buf);
+			if ( countPrefixTerms(reader, p) <= MAX_PREFIX_TERMS )
+				prefix.queries.push_back(_CLNEW PrefixQuery(p));
+			_CLDECDELETE(p);
+		}
+		if ( len >= 5 && fuzzy.queries.size() < FUZZY_QUERIES )
+			fuzzy.queries.push_back(_CLNEW FuzzyQuery(terms[i], 0.7f));
+	}
+
+	//phrases and spans are cut from the documents, so that they do match
+	std::vector<CorpusString> words;
+	const int32_t docs = corpus->size();
+	for ( int32_t i=0;i<QUERIES_PER_KIND;i++ ){
+		int32_t n = (int32_t)(((int64_t)docs * i) / QUERIES_PER_KIND);
+		if ( samplePhrase(corpus, n, 2, words) ){
+			PhraseQuery* pq = _CLNEW PhraseQuery();
+			for ( size_t j=0;j<words.size();j++ ){
+				Term* t = _CLNEW Term(_T("body"), words[j].c_str());
+				pq->add(t);
+				_CLDECDELETE(t);
+			}
+			phrase.queries.push_back(pq);
+		}
+		if ( samplePhrase(corpus, n + 1 < docs ? n + 1 : n, 3, words) ){
+			//the first and the last word of three, in order and at most one word apart
+			SpanQuery* clauses[2];
+			for ( size_t j=0;j<2;j++ ){
+				Term* t = _CLNEW Term(_T("body"), words[j * 2].c_str());
+				clauses[j] = _CLNEW SpanTermQuery(t);
+				_CLDECDELETE(t);
+			}
+			span.queries.push_back(_CLNEW SpanNearQuery(clauses, clauses + 2, 1, 0, true, true));
+		}
+	}
+
+	for ( size_t i=0;i<nterms;i++ )
+		_CLDECDELETE(terms[i]);
+
+	kinds.push_back(term);
+	kinds.push_back(conj);
+	kinds.push_back(disj);
+	kinds.push_back(phrase);
+	kinds.push_back(prefix);
+	kinds.push_back(fuzzy);
+	kinds.push_back(span);
+	kinds.push_back(sorted);
+}
+
+struct SearchThread{
+	IndexSearcher* searcher;
+	const std::vector<QueryKind>* kinds;
+	Sort* sort;
+	std::vector<LatencyStats> stats;
+	int64_t hits;
+	bool failed;
+};
+
+_LUCENE_THREAD_FUNC(searchThread, _arg){
+	SearchThread* arg = (SearchThread*)_arg;
+	const std::vector<QueryKind>& kinds = *arg->kinds;
+
+	//queries are not shared between threads
+	std::vector< std::vector<Query*> > queries(kinds.size());
+	size_t longest = 0;
+	for ( size_t k=0;k<kinds.size();k++ ){
+		for ( size_t i=0;i<kinds[k].queries.size();i++ )
+			queries[k].push_back(kinds[k].queries[i]->clone());
+		if ( queries[k].size() > longest )
+			longest = queries[k].size();
+	}
+
+	try{
+		//interleave the kinds, like a query log would
+		for ( int32_t pass=0;pass<benchmarkOptions.queryPasses;pass++ ){
+			for ( size_t i=0;i<longest;i++ ){
+				for ( size_t k=0;k<kinds.size();k++ ){
+					if ( i >= queries[k].size() )
+						continue;
+					int64_t start = Misc::currentTimeMicros();
+					TopDocs* top;
+					if ( kinds[k].sorted )
+						top = arg->searcher->_search(queries[k][i], NULL, NULL, 10, arg->sort);
+					else
+						top = arg->searcher->_search(queries[k][i], NULL, NULL, 10);
+					arg->stats[k].add((int32_t)(Misc::currentTimeMicros() - start));
+					arg->hits += top->totalHits;
+					_CLDELETE(top);
+				}
+			}
+		}
+	}catch(CLuceneError& err){
+		fprintf(stderr, "\n > search error: %s\n", err.what());
+		arg->failed = true;
+	}
+
+	for ( size_t k=0;k<queries.size();k++ )
+		for ( size_t i=0;i<queries[k].size();i++ )
+			_CLDELETE(queries[k][i]);
+	_LUCENE_THREAD_FUNC_RETURN(0);
+}
+
+int BenchmarkQueryMix(Timer* timerCase){
+	//the index is built once, outside of the timed region
+	IndexSearcher searcher(getMixDirectory());
+	std::vector<QueryKind> kinds;
+	buildQueries(searcher.getReader(), mixCorpus, kinds);
+	Sort sort(_CLNEW SortField(_T("rank"), SortField::INT, false));
+
+	const int32_t threadCount = benchmarkOptions.threads;
+	SearchThread* args = _CL_NEWARRAY(SearchThread, threadCount);
+	_LUCENE_THREADID_TYPE* threads = _CL_NEWARRAY(_LUCENE_THREADID_TYPE, threadCount);
+
+	timerCase->start();
+	int64_t start = Misc::currentTimeMicros();
+	for ( int32_t i=0;i<threadCount;i++ ){
+		args[i].searcher = &searcher;
+		args[i].kinds = &kinds;
+		args[i].sort = &sort;
+		args[i].stats.resize(kinds.size());
+		args[i].hits = 0;
+		args[i].failed = false;
+		threads[i] = _LUCENE_THREAD_CREATE(&searchThread, &args[i]);
+	}
+	for ( int32_t i=0;i<threadCount;i++ )
+		_LUCENE_THREAD_JOIN(threads[i]);
+	int64_t wall = Misc::currentTimeMicros() - start;
+	timerCase->stop();
+
+	int64_t hits = 0;
+	bool failed = false;
+	LatencyStats all;
+	for ( size_t k=0;k<kinds.size();k++ ){
+		LatencyStats stats;
+		for ( int32_t i=0;i<threadCount;i++ )
+			stats.addAll(args[i].stats[k]);
+		all.addAll(stats);
+		//throughput of a kind is relative to the whole run, as the kinds are interleaved
+		stats.report(kinds[k].name, 0);
+	}
+	for ( int32_t i=0;i<threadCount;i++ ){
+		hits += args[i].hits;
+		failed |= args[i].failed;
+	}
+	all.report("search.all", wall);
+	reportResult("search.all", "peak_rss_kb", (double)peakMemoryKB());
+
+	_CLDELETE_ARRAY(threads);
+	_CLDELETE_ARRAY(args);
+	for ( size_t k=0;k<kinds.size();k++ )
+		for ( size_t i=0;i<kinds[k].queries.size();i++ )
+			_CLDELETE(kinds[k].queries[i]);
+	searcher.close();
+	return !failed && hits > 0 ? 0 : 1;
+}
+
+void CleanupQueryMix(){
+	if ( mixDirectory != NULL ){
+		mixDirectory->close();
+		_CLDELETE(mixDirectory);
+	}
+	_CLDELETE(mixCorpus);
+}
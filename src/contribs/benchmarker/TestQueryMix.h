@@ -0,0 +1,28 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#pragma once
+
+int BenchmarkQueryMix(Timer*);
+void CleanupQueryMix();
+
+/**
+* Replays a mix of term, boolean, phrase, prefix, fuzzy, span and sorted
+* queries against an index of the -corpus corpus and reports the latency
+* percentiles and throughput of each kind of query.
+*/
+class TestQueryMix:public Unit
+{
+protected:
+	void runTests(){
+		this->runTest("BenchmarkQueryMix",BenchmarkQueryMix,3);
+		CleanupQueryMix();
+	}
+public:
+	const char* getName(){
+		return "TestQueryMix";
+	}
+};
@@ -18,6 +18,8 @@
 
 #include "CLucene.h"
 #include "CLucene/_clucene-config.h"
+#include "CLucene/config/repl_tchar.h"
+#include "CLucene/config/repl_wchar.h"
 #include "CLucene/util/Misc.h"
 #include "CLucene/store/RAMDirectory.h"
 
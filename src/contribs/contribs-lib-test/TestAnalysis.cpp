@@ -7,7 +7,8 @@
 #include "test.h"
 #include "CLucene/analysis/cjk/CJKAnalyzer.h"
 #include "CLucene/analysis/LanguageBasedAnalyzer.h"
-// #include "CLucene/snowball/SnowballFilter.h"
+#include "CLucene/analysis/de/GermanAnalyzer.h"
+#include "CLucene/snowball/SnowballAnalyzer.h"
 
 #include <fcntl.h>
 #ifdef _CL_HAVE_IO_H
@@ -25,7 +26,8 @@
 #include <errno.h>
 
 CL_NS_USE2(analysis, cjk)
-// CL_NS_USE2(analysis, snowball)
+CL_NS_USE2(analysis, de)
+CL_NS_USE2(analysis, snowball)
 
 void test(CuTest *tc, char* orig, Reader* reader, bool verbose, int64_t bytes) {
     StandardAnalyzer analyzer;
@@ -178,12 +180,66 @@ void testLanguageBasedAnalyzer(CuTest* tc) {
     _CLDELETE(ts);
 }
 
+// Analyzes input twice with the reusable stream of a, and checks that the
+// stream is reused and returns the same terms, offsets and position
+// increments both times. The expected tokens are given as "term start end
+// increment" lines.
+void assertReusableAnalyzesTo(CuTest* tc, Analyzer* a, const TCHAR* input, const TCHAR** expected) {
+    TokenStream* first = NULL;
+    Token t;
+    for (int32_t pass = 0; pass < 2; pass++) {
+        CL_NS(util)::StringReader reader(input);
+        TokenStream* ts = a->reusableTokenStream(_T("contents"), &reader);
+        if (pass == 0)
+            first = ts;
+        else
+            CuAssert(tc, _T("stream not reused"), ts == first);
+
+        for (int32_t i = 0; expected[i] != NULL; i++) {
+            CuAssert(tc, _T("token expected"), ts->next(&t) != NULL);
+            TCHAR actual[LUCENE_MAX_WORD_LEN + 40];
+            _sntprintf(actual, LUCENE_MAX_WORD_LEN + 40, _T("%s %d %d %d"), t.termBuffer(),
+                       t.startOffset(), t.endOffset(), t.getPositionIncrement());
+            CuAssertStrEquals(tc, _T("token"), expected[i], actual);
+        }
+        CuAssert(tc, _T("no further token expected"), ts->next(&t) == NULL);
+    }
+}
+
+void testGermanReusableTokenStream(CuTest* tc) {
+    GermanAnalyzer a;
+    const TCHAR* expected[] = { _T("hau 4 10 1"), _T("sind 11 15 1"), _T("schon 16 21 1"), NULL };
+    assertReusableAnalyzesTo(tc, &a, _T("Die H\x00e4user sind sch\x00f6n"), expected);
+}
+
+void testCJKReusableTokenStream(CuTest* tc) {
+    LanguageBasedAnalyzer a(_T("cjk"), false);
+    const TCHAR* expected[] = { _T("ab 0 2 1"), _T("\x5564\x9152 3 5 1"), _T("\x9152\x5564 4 6 1"), _T("cd 7 9 1"), NULL };
+    assertReusableAnalyzesTo(tc, &a, _T("ab \x5564\x9152\x5564 cd"), expected);
+}
+
+void testLanguageBasedReusableTokenStream(CuTest* tc) {
+    LanguageBasedAnalyzer a(_T("English"), true);
+    const TCHAR* expected[] = { _T("he 0 2 1"), _T("abhorred 3 11 1"), _T("cafe 12 16 1"), NULL };
+    assertReusableAnalyzesTo(tc, &a, _T("He abhorred caf\x00e9"), expected);
+}
+
+void testSnowballReusableTokenStream(CuTest* tc) {
+    SnowballAnalyzer a(_T("English"));
+    const TCHAR* expected[] = { _T("the 0 3 1"), _T("run 4 11 1"), _T("dog 12 16 1"), NULL };
+    assertReusableAnalyzesTo(tc, &a, _T("The running dogs"), expected);
+}
+
 CuSuite *testanalysis(void) {
     CuSuite *suite = CuSuiteNew(_T("CLucene Analysis Test"));
 
     SUITE_ADD_TEST(suite, testFile);
     SUITE_ADD_TEST(suite, testCJK);
     SUITE_ADD_TEST(suite, testLanguageBasedAnalyzer);
+    SUITE_ADD_TEST(suite, testGermanReusableTokenStream);
+    SUITE_ADD_TEST(suite, testCJKReusableTokenStream);
+    SUITE_ADD_TEST(suite, testLanguageBasedReusableTokenStream);
+    SUITE_ADD_TEST(suite, testSnowballReusableTokenStream);
 
     return suite;
 }
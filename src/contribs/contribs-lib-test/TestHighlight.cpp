@@ -117,7 +117,7 @@ void doSearching(CuTest* tc, const TCHAR* queryString) {
 
     if (hl_hits != NULL)
         _CLDELETE(hl_hits);
-    hl_hits = hl_searcher->search(hl_query);
+    hl_hits = hl_searcher->search(hl_query, NULL);
     hl_formatter.numHighlights = 0;
 }
 
@@ -7,6 +7,7 @@
 #include "test.h"
 
 #include "CLucene/snowball/SnowballAnalyzer.h"
+#include "CLucene/snowball/SnowballFilter.h"
 
 CL_NS_USE2(analysis, snowball);
 
@@ -27,10 +28,68 @@ void testSnowball(CuTest *tc) {
     _CLDELETE(ts);
 }
 
+void testSnowballCache(CuTest *tc) {
+    // the same words, with the long one and the non ascii one repeated
+    const TCHAR* text = _T("running runs ran running antidisestablishmentarianisms ")
+        _T("r\xe9sum\xe9s runs antidisestablishmentarianisms r\xe9sum\xe9s running");
+
+    CL_NS(util)::StringReader reader1(text);
+    CL_NS(util)::StringReader reader2(text);
+    WhitespaceTokenizer* tokenizer1 = _CLNEW WhitespaceTokenizer(&reader1);
+    WhitespaceTokenizer* tokenizer2 = _CLNEW WhitespaceTokenizer(&reader2);
+    SnowballFilter plain(tokenizer1, _T("English"), true);
+    SnowballFilter cached(tokenizer2, _T("English"), true, 3);
+
+    Token t1, t2;
+    int32_t count = 0;
+    while ( plain.next(&t1) != NULL ){
+        CLUCENE_ASSERT(cached.next(&t2) != NULL);
+        CLUCENE_ASSERT(t1.termLength() == t2.termLength());
+        CLUCENE_ASSERT(_tcscmp(t1.termBuffer(), t2.termBuffer()) == 0);
+        count++;
+    }
+    CLUCENE_ASSERT(cached.next(&t2) == NULL);
+    CLUCENE_ASSERT(count == 10);
+    CLUCENE_ASSERT(plain.getCacheHits() == 0 && plain.getCacheMisses() == 0);
+    // the long word is not cached
+    CLUCENE_ASSERT(cached.getCacheHits() + cached.getCacheMisses() == 8);
+    CLUCENE_ASSERT(cached.getCacheHits() > 0);
+
+    CL_NS(util)::StringReader reader3(_T("r\xe9sum\xe9s"));
+    SnowballFilter filter(_CLNEW WhitespaceTokenizer(&reader3), _T("English"), true, 16);
+    CLUCENE_ASSERT(filter.next(&t1) != NULL);
+    CLUCENE_ASSERT(_tcscmp(t1.termBuffer(), _T("r\xe9sum\xe9")) == 0);
+    CLUCENE_ASSERT(t1.termLength() == 6);
+}
+
+void testSnowballStopWords(CuTest *tc) {
+    const TCHAR* words[] = {_T("the"), _T("a"), NULL};
+    StopWordSet* stopWords = _CLNEW StopWordSet(words);
+    SnowballAnalyzer an(_T("English"), stopWords);
+    _CLDECDELETE(stopWords);
+    an.setStemCacheSize(64);
+    CLUCENE_ASSERT(an.getStemCacheSize() == 64);
+
+    for ( int32_t i=0;i<2;i++ ){
+        CL_NS(util)::StringReader reader(_T("the cats chased a cat"));
+        TokenStream* ts = an.reusableTokenStream(_T("test"), &reader);
+        Token t;
+        CLUCENE_ASSERT(ts->next(&t)!=NULL);
+        CLUCENE_ASSERT(_tcscmp(t.termBuffer(), _T("cat")) == 0);
+        CLUCENE_ASSERT(ts->next(&t)!=NULL);
+        CLUCENE_ASSERT(_tcscmp(t.termBuffer(), _T("chase")) == 0);
+        CLUCENE_ASSERT(ts->next(&t)!=NULL);
+        CLUCENE_ASSERT(_tcscmp(t.termBuffer(), _T("cat")) == 0);
+        CLUCENE_ASSERT(ts->next(&t) == NULL);
+    }
+}
+
 CuSuite *testsnowball(void) {
     CuSuite *suite = CuSuiteNew(_T("CLucene Snowball Test"));
 
     SUITE_ADD_TEST(suite, testSnowball);
+    SUITE_ADD_TEST(suite, testSnowballCache);
+    SUITE_ADD_TEST(suite, testSnowballStopWords);
 
     return suite;
 }
@@ -7,8 +7,8 @@
 #include "test.h"
 
 unittest tests[] = {
-    {"analysis", testanalysis}
-    // {"snowball", testsnowball},
+    {"analysis", testanalysis},
+    {"snowball", testsnowball},
     {"highlighter",testhighlighter},
     {"streams",teststreams},
     {"utf8",testutf8},
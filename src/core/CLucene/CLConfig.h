@@ -98,6 +98,12 @@
 //and when _CLDECDELETE is called, the reference is decremented and only deleted
 //if the refcount is zero.
 //#define LUCENE_ENABLE_REFCOUNT
+//
+//define this to allocate the weights, scorers, term docs and phrase positions
+//of a search from an arena (see IndexSearcher::setUseArena). When not defined,
+//these objects always come straight from the heap, without the per object
+//header and the check for a current arena.
+//#define LUCENE_ENABLE_ARENA
 
 
 ////////////////////////////////////////////////////////////////////
@@ -182,6 +188,9 @@
 //The initial value set to BooleanQuery::maxClauseCount. Default is 1024
 #define LUCENE_BOOLEANQUERY_MAXCLAUSECOUNT 1024
 //
+//Default memory budget of a QueryResultCache, in bytes. Default is 16MB
+#define LUCENE_DEFAULT_QUERY_RESULT_CACHE_BYTES (16*1024*1024)
+//
 //bvk: 12.3.2005
 //==============================================================================
 //Previously the way the tokenizer has worked has been changed to optionally
@@ -200,6 +209,11 @@
 //Size of the CharTokenizer buffersize. Required.
 #define LUCENE_IO_BUFFER_SIZE 1024
 //
+//Size of the chunks in which CompoundFileWriter copies the segment files
+//into a compound file. Between chunks the merge checks whether it was
+//aborted. Default is 1MB
+#define LUCENE_COMPOUND_FILE_COPY_CHUNK_SIZE (1024*1024)
+//
 ////////////////////////////////////////////////////////////////////
 
 
@@ -23,6 +23,7 @@
 #include "CLucene/document/FieldSelector.cpp"
 #include "CLucene/document/NumberTools.cpp"
 #include "CLucene/document/Field.cpp"
+#include "CLucene/index/BatchIndexer.cpp"
 #include "CLucene/index/CompoundFile.cpp"
 #include "CLucene/index/DirectoryIndexReader.cpp"
 #include "CLucene/index/DocumentsWriter.cpp"
@@ -95,6 +96,8 @@
 #include "CLucene/search/PhraseQuery.cpp"
 #include "CLucene/search/PhraseScorer.cpp"
 #include "CLucene/search/PrefixQuery.cpp"
+#include "CLucene/search/QueryResultCache.cpp"
+#include "CLucene/search/QueryProfile.cpp"
 #include "CLucene/search/QueryFilter.cpp"
 #include "CLucene/search/RangeQuery.cpp"
 #include "CLucene/search/RangeFilter.cpp"
@@ -106,6 +109,7 @@
 #include "CLucene/search/Sort.cpp"
 #include "CLucene/search/TermQuery.cpp"
 #include "CLucene/search/TermScorer.cpp"
+#include "CLucene/search/TopFieldDocsCollector.cpp"
 #include "CLucene/search/WildcardQuery.cpp"
 #include "CLucene/search/WildcardTermEnum.cpp"
 #include "CLucene/search/spans/NearSpansOrdered.cpp"
@@ -128,10 +132,15 @@
 #include "CLucene/store/IndexOutput.cpp"
 #include "CLucene/store/Directory.cpp"
 #include "CLucene/store/RAMDirectory.cpp"
+#include "CLucene/store/RateLimiter.cpp"
+#include "CLucene/store/StatsDirectory.cpp"
+#include "CLucene/util/Arena.cpp"
 #include "CLucene/util/BitSet.cpp"
+#include "CLucene/util/CharTables.cpp"
 #include "CLucene/util/Equators.cpp"
 #include "CLucene/util/FastCharStream.cpp"
 #include "CLucene/util/MD5Digester.cpp"
+#include "CLucene/util/ProfileHook.cpp"
 #include "CLucene/util/Reader.cpp"
 #include "CLucene/util/StringIntern.cpp"
 #include "CLucene/util/ThreadLocal.cpp"
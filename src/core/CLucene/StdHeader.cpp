@@ -16,6 +16,7 @@
 #include "CLucene/store/LockFactory.h"
 #include "CLucene/util/_StringIntern.h"
 #include "CLucene/util/_ThreadLocal.h"
+#include "CLucene/util/CharTables.h"
 
 #if defined(_MSC_VER) && defined(_DEBUG)
 	#define CRTDBG_MAP_ALLOC
@@ -40,5 +41,6 @@ void _lucene_shutdown(){
   NoLockFactory::_shutdown();
   _ThreadLocal::_shutdown();
   IndexFileNameFilter::_shutdown();
+  CharTables::_shutdown();
   _CLDELETE (TermVectorOffsetInfo_EMPTY_OFFSET_INFO);
 }
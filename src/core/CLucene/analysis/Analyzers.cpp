@@ -8,6 +8,7 @@
 #include "Analyzers.h"
 #include "CLucene/util/StringBuffer.h"
 #include "CLucene/util/Misc.h"
+#include "CLucene/util/CharTables.h"
 #include <assert.h>
 
 CL_NS_USE(util)
@@ -81,7 +82,7 @@ LetterTokenizer::LetterTokenizer(CL_NS(util)::Reader* in):
 LetterTokenizer::~LetterTokenizer(){}
 
 bool LetterTokenizer::isTokenChar(const TCHAR c) const {
-	return _istalpha(c)!=0;
+	return CharTables::isLetter(c);
 }
 
 LowerCaseTokenizer::LowerCaseTokenizer(CL_NS(util)::Reader* in):
@@ -92,7 +93,7 @@ LowerCaseTokenizer::~LowerCaseTokenizer(){
 }
 
 TCHAR LowerCaseTokenizer::normalize(const TCHAR chr) const {
-	return _totlower(chr);
+	return CharTables::toLower(chr);
 }
 
 WhitespaceTokenizer::WhitespaceTokenizer(CL_NS(util)::Reader* in):CharTokenizer(in) {
@@ -101,7 +102,7 @@ WhitespaceTokenizer::~WhitespaceTokenizer(){
 }
 
 bool WhitespaceTokenizer::isTokenChar(const TCHAR c)  const{
-	return _istspace(c)==0; //(return true if NOT a space)
+	return !CharTables::isSpace(c); //(return true if NOT a space)
 }
 
 WhitespaceAnalyzer::WhitespaceAnalyzer(){
@@ -150,10 +151,117 @@ LowerCaseFilter::~LowerCaseFilter(){
 Token* LowerCaseFilter::next(Token* t){
 	if (input->next(t) == NULL)
 		return NULL;
- 	stringCaseFold( t->termBuffer() );
+	CharTables::caseFold( t->termBuffer(), t->termLength() );
 	return t;
 }
 
+struct StopWordSet::Slot{
+	size_t hash;
+	int32_t offset;		// of the word in chars
+	int32_t length;		// -1 for an empty slot
+};
+
+StopWordSet::StopWordSet(const TCHAR** words, const bool ignoreCase):
+	chars(NULL), slots(NULL), mask(0), count(0)
+{
+	size_t n = 0;
+	while ( words[n] != NULL )
+		n++;
+	init(words, n, ignoreCase);
+}
+StopWordSet::StopWordSet(const CLTCSetList* words, const bool ignoreCase):
+	chars(NULL), slots(NULL), mask(0), count(0)
+{
+	const TCHAR** list = _CL_NEWARRAY(const TCHAR*, words->size() + 1);
+	size_t n = 0;
+	for ( CLTCSetList::const_iterator itr = words->begin(); itr != words->end(); ++itr )
+		list[n++] = *itr;
+	try{
+		init(list, n, ignoreCase);
+	}_CLFINALLY(
+		_CLDELETE_ARRAY(list);
+	);
+}
+StopWordSet::~StopWordSet(){
+	_CLDELETE_LARRAY(chars);
+	_CLDELETE_LARRAY(slots);
+}
+
+void StopWordSet::init(const TCHAR* const* words, size_t wordCount, const bool ignoreCase){
+	// at most half of the slots are used, so that probes are short
+	int32_t size = 8;
+	while ( (size_t)size < wordCount * 2 )
+		size <<= 1;
+	mask = size - 1;
+	slots = _CL_NEWARRAY(Slot, size);
+	for ( int32_t i=0;i<size;i++ )
+		slots[i].length = -1;
+
+	size_t total = 0;
+	for ( size_t i=0;i<wordCount;i++ )
+		total += _tcslen(words[i]);
+	chars = _CL_NEWARRAY(TCHAR, total + 1);
+
+	int32_t offset = 0;
+	for ( size_t i=0;i<wordCount;i++ ){
+		const int32_t length = (int32_t)_tcslen(words[i]);
+		TCHAR* word = chars + offset;
+		_tcsncpy(word, words[i], length);
+		if ( ignoreCase )
+			CharTables::caseFold(word, length);
+		add(word, length, offset);
+	}
+}
+
+void StopWordSet::add(const TCHAR* word, const int32_t length, int32_t& offset){
+	const size_t h = hash(word, length);
+	int32_t i = (int32_t)h & mask;
+	while ( slots[i].length >= 0 ){
+		// the same word twice, or twice once folded
+		if ( slots[i].hash == h && slots[i].length == length
+				&& _tcsncmp(chars + slots[i].offset, word, length) == 0 )
+			return;
+		i = (i + 1) & mask;
+	}
+	slots[i].hash = h;
+	slots[i].offset = offset;
+	slots[i].length = length;
+	offset += length;
+	count++;
+}
+
+size_t StopWordSet::hash(const TCHAR* word, const int32_t length){
+	size_t h = Misc::thashCode(word, length);
+	// the low bits pick the slot, so mix the high bits into them
+	h ^= h >> 15;
+	h *= 0x2c1b3c6d;
+	h ^= h >> 12;
+	return h;
+}
+
+const StopWordSet::Slot* StopWordSet::find(const TCHAR* word, const int32_t length, const size_t h) const{
+	int32_t i = (int32_t)h & mask;
+	while ( slots[i].length >= 0 ){
+		if ( slots[i].hash == h && slots[i].length == length
+				&& memcmp(chars + slots[i].offset, word, length * sizeof(TCHAR)) == 0 )
+			return slots + i;
+		i = (i + 1) & mask;
+	}
+	return NULL;
+}
+
+bool StopWordSet::contains(const TCHAR* word, const int32_t length) const{
+	return find(word, length, hash(word, length)) != NULL;
+}
+bool StopWordSet::contains(const TCHAR* word) const{
+	const int32_t length = (int32_t)_tcslen(word);
+	return find(word, length, hash(word, length)) != NULL;
+}
+size_t StopWordSet::size() const{
+	return count;
+}
+
+
 bool StopFilter::ENABLE_POSITION_INCREMENTS_DEFAULT = false;
 
 
@@ -164,6 +272,7 @@ StopFilter::StopFilter(TokenStream* in, bool deleteTokenStream, CLTCSetList* sto
 	TokenFilter(in, deleteTokenStream),
 	stopWords (stopTable),
 	deleteStopTable(_deleteStopTable),
+	stopSet(NULL),
 	enablePositionIncrements(ENABLE_POSITION_INCREMENTS_DEFAULT),
 	ignoreCase(false)
 {
@@ -171,17 +280,28 @@ StopFilter::StopFilter(TokenStream* in, bool deleteTokenStream, CLTCSetList* sto
 
 StopFilter::StopFilter(TokenStream* in, bool deleteTokenStream, const TCHAR** _stopWords, const bool _ignoreCase):
 	TokenFilter(in, deleteTokenStream),
+	stopWords(NULL),
+	deleteStopTable(false),
+	stopSet(_CLNEW StopWordSet(_stopWords, _ignoreCase)),
+	enablePositionIncrements(ENABLE_POSITION_INCREMENTS_DEFAULT),
+	ignoreCase(_ignoreCase)
+{
+}
+
+StopFilter::StopFilter(TokenStream* in, bool deleteTokenStream, StopWordSet* _stopSet, const bool _ignoreCase):
+	TokenFilter(in, deleteTokenStream),
+	stopWords(NULL),
+	deleteStopTable(false),
+	stopSet(_CL_POINTER(_stopSet)),
 	enablePositionIncrements(ENABLE_POSITION_INCREMENTS_DEFAULT),
 	ignoreCase(_ignoreCase)
 {
-	deleteStopTable = true;
-	stopWords = _CLNEW CLTCSetList(true);
-	fillStopTable( stopWords,_stopWords, _ignoreCase );
 }
 
 StopFilter::~StopFilter(){
 	if (deleteStopTable)
 		_CLLDELETE(stopWords);
+	_CLDECDELETE(stopSet);
 }
 //static
 bool StopFilter::getEnablePositionIncrementsDefault() {
@@ -201,7 +321,7 @@ void StopFilter::fillStopTable(CLTCSetList* stopTable, const TCHAR** stopWords,
 	if ( _ignoreCase ){
 		for (int32_t i = 0; stopWords[i]!=NULL; i++){
       tmp = STRDUP_TtoT(stopWords[i]);
-      stringCaseFold(tmp);
+      CharTables::caseFold(tmp, _tcslen(tmp));
 			stopTable->insert( tmp );
     }
 	}else{
@@ -218,9 +338,11 @@ Token* StopFilter::next(Token* token) {
 	while (input->next(token)){
 		TCHAR* termText = token->termBuffer();
     if ( ignoreCase ){
-      stringCaseFold(termText);
+      CharTables::caseFold(termText, token->termLength());
     }
-		if (stopWords->find(termText)==stopWords->end()){
+		const bool stopped = stopSet != NULL ? stopSet->contains(termText, token->termLength())
+			: stopWords->find(termText)!=stopWords->end();
+		if (!stopped){
 			if (enablePositionIncrements) {
 				token->setPositionIncrement(token->getPositionIncrement() + skippedPositions);
 			}
@@ -234,23 +356,30 @@ Token* StopFilter::next(Token* token) {
 }
 
 StopAnalyzer::StopAnalyzer(const char* stopwordsFile, const char* enc):
-	stopTable(_CLNEW CLTCSetList(true))
+	stopSet(NULL)
 {
 	if ( enc == NULL )
 		enc = "ASCII";
-	WordlistLoader::getWordSet(stopwordsFile, enc, stopTable);
+	CLTCSetList words(true);
+	WordlistLoader::getWordSet(stopwordsFile, enc, &words);
+	stopSet = _CLNEW StopWordSet(&words);
 }
 
 StopAnalyzer::StopAnalyzer(CL_NS(util)::Reader* stopwordsReader, const bool _bDeleteReader):
-	stopTable(_CLNEW CLTCSetList(true))
+	stopSet(NULL)
 {
-	WordlistLoader::getWordSet(stopwordsReader, stopTable, _bDeleteReader);
+	CLTCSetList words(true);
+	WordlistLoader::getWordSet(stopwordsReader, &words, _bDeleteReader);
+	stopSet = _CLNEW StopWordSet(&words);
 }
 
 StopAnalyzer::StopAnalyzer():
-	stopTable(_CLNEW CLTCSetList(true))
+	stopSet(_CLNEW StopWordSet(ENGLISH_STOP_WORDS))
+{
+}
+StopAnalyzer::StopAnalyzer(StopWordSet* stopWords):
+	stopSet(_CL_POINTER(stopWords))
 {
-	StopFilter::fillStopTable(stopTable,ENGLISH_STOP_WORDS);
 }
 class StopAnalyzer::SavedStreams : public TokenStream {
 public:
@@ -258,6 +387,9 @@ public:
     TokenStream* result;
 
     SavedStreams():source(NULL), result(NULL) {}
+    virtual ~SavedStreams(){
+        _CLDELETE(result); // the source is deleted by the result
+    }
 
     void close(){}
     Token* next(Token* token) {return NULL;}
@@ -266,15 +398,14 @@ StopAnalyzer::~StopAnalyzer()
 {
     SavedStreams* t = reinterpret_cast<SavedStreams*>(this->getPreviousTokenStream());
     if (t) _CLDELETE(t->result);
-    _CLDELETE(stopTable);
+    _CLDECDELETE(stopSet);
 }
 StopAnalyzer::StopAnalyzer( const TCHAR** stopWords):
-	stopTable(_CLNEW CLTCSetList(true))
+	stopSet(_CLNEW StopWordSet(stopWords))
 {
-	StopFilter::fillStopTable(stopTable,stopWords);
 }
 TokenStream* StopAnalyzer::tokenStream(const TCHAR* /*fieldName*/, Reader* reader) {
-	return _CLNEW StopFilter(_CLNEW LowerCaseTokenizer(reader),true, stopTable);
+	return _CLNEW StopFilter(_CLNEW LowerCaseTokenizer(reader),true, stopSet);
 }
 
 /** Filters LowerCaseTokenizer with StopFilter. */
@@ -283,7 +414,7 @@ TokenStream* StopAnalyzer::reusableTokenStream(const TCHAR* fieldName, Reader* r
     if (streams == NULL) {
         streams = _CLNEW SavedStreams();
         streams->source = _CLNEW LowerCaseTokenizer(reader);
-        streams->result = _CLNEW StopFilter(streams->source, true, stopTable);
+        streams->result = _CLNEW StopFilter(streams->source, true, stopSet);
         setPreviousTokenStream(streams);
     } else
         streams->source->reset(reader);
@@ -350,157 +481,35 @@ ISOLatin1AccentFilter::~ISOLatin1AccentFilter(){
 Token* ISOLatin1AccentFilter::next(Token* token){
 	if ( input->next(token) != NULL ){
 		int32_t l = token->termLength();
-		const TCHAR* chars = token->termBuffer();
-		bool doProcess = false;
-		for (int32_t i = 0; i < l; ++i) {
-			#ifdef _UCS2
-			if ( chars[i] >= 0xC0 && chars[i] <= 0x178 ) {
-			#else
-			if ( (chars[i] >= 0xC0 && chars[i] <= 0xFF) || chars[i] < 0 ) {
-			#endif
-				doProcess = true;
-				break;
-			}
-
-		}
-		if ( !doProcess ) {
+		int32_t foldedLen = CharTables::foldedAccentsLength(token->termBuffer(), l);
+		if ( foldedLen < 0 )
 			return token;
-		}
 
-		StringBuffer output(l*2);
-		for (int32_t j = 0; j < l; j++) {
-			#ifdef _UCS2
-			TCHAR c = chars[j];
-			#else
-			unsigned char c = chars[j];
-			#endif
-			switch (c) {
-				case 0xC0 : // �
-				case 0xC1 : // �
-				case 0xC2 : // �
-				case 0xC3 : // �
-				case 0xC4 : // �
-				case 0xC5 : // �
-					output.appendChar('A');
-					break;
-				case 0xC6 : // �
-					output.append(_T("AE"));
-					break;
-				case 0xC7 : // �
-					output.appendChar('C');
-					break;
-				case 0xC8 : // �
-				case 0xC9 : // �
-				case 0xCA : // �
-				case 0xCB : // �
-					output.appendChar('E');
-					break;
-				case 0xCC : // �
-				case 0xCD : // �
-				case 0xCE : // �
-				case 0xCF : // �
-					output.appendChar('I');
-					break;
-				case 0xD0 : // �
-					output.appendChar('D');
-					break;
-				case 0xD1 : // �
-					output.appendChar('N');
-					break;
-				case 0xD2 : // �
-				case 0xD3 : // �
-				case 0xD4 : // �
-				case 0xD5 : // �
-				case 0xD6 : // �
-				case 0xD8 : // �
-					output.appendChar('O');
-					break;
-				case 0xDE : // �
-					output.append(_T("TH"));
-					break;
-				case 0xD9 : // �
-				case 0xDA : // �
-				case 0xDB : // �
-				case 0xDC : // �
-					output.appendChar('U');
-					break;
-				case 0xDD : // �
-					output.appendChar('Y');
-					break;
-				case 0xE0 : // �
-				case 0xE1 : // �
-				case 0xE2 : // �
-				case 0xE3 : // �
-				case 0xE4 : // �
-				case 0xE5 : // �
-					output.appendChar('a');
-					break;
-				case 0xE6 : // �
-					output.append(_T("ae"));
-					break;
-				case 0xE7 : // �
-					output.appendChar('c');
-					break;
-				case 0xE8 : // �
-				case 0xE9 : // �
-				case 0xEA : // �
-				case 0xEB : // �
-					output.appendChar('e');
-					break;
-				case 0xEC : // �
-				case 0xED : // �
-				case 0xEE : // �
-				case 0xEF : // �
-					output.appendChar('i');
-					break;
-				case 0xF0 : // �
-					output.appendChar('d');
-					break;
-				case 0xF1 : // �
-					output.appendChar('n');
-					break;
-				case 0xF2 : // �
-				case 0xF3 : // �
-				case 0xF4 : // �
-				case 0xF5 : // �
-				case 0xF6 : // �
-				case 0xF8 : // �
-					output.appendChar('o');
-					break;
-				case 0xDF : // �
-					output.append(_T("ss"));
-					break;
-				case 0xFE : // �
-					output.append(_T("th"));
-					break;
-				case 0xF9 : // �
-				case 0xFA : // �
-				case 0xFB : // �
-				case 0xFC : // �
-					output.appendChar('u');
-					break;
-				case 0xFD : // �
-				case 0xFF : // �
-					output.appendChar('y');
-					break;
-
-				#ifdef _UCS2
-				case 0x152 : // �
-					output.append(_T("OE"));
-					break;
-				case 0x153 : // �
-					output.append(_T("oe"));
-					break;
-				case 0x178 : // �
-					output.appendChar('Y');
-					break;
-				#endif
-				default :
-					output.appendChar(c);
-					break;
+		// each character is replaced by at most two, in the buffer of the token
+		TCHAR* chars = token->termBuffer();
+#ifdef LUCENE_TOKEN_WORD_LENGTH
+		// the buffer has a fixed size, the folded term is cut to it: only the
+		// characters that are folded into its first maxLen ones are folded. The
+		// last of them may leave one character over, in the place of the 0
+		const int32_t maxLen = (int32_t)token->bufferLength() - 1;
+		if ( foldedLen > maxLen ){
+			l = 0;
+			foldedLen = 0;
+			while ( foldedLen < maxLen ){
+				const TCHAR* f = CharTables::accentFolding(chars[l++]);
+				foldedLen += ( f != NULL && f[1] != 0 ) ? 2 : 1;
 			}
 		}
-		token->setText(output.getBuffer());
+		CharTables::foldAccents(chars, l, foldedLen);
+		if ( foldedLen > maxLen )
+			foldedLen = maxLen;
+#else
+		if ( token->bufferLength() < (size_t)foldedLen + 1 )
+			chars = token->resizeTermBuffer(foldedLen + 1);
+		CharTables::foldAccents(chars, l, foldedLen);
+#endif
+		chars[foldedLen] = 0;
+		token->setTermLength(foldedLen);
 		return token;
 	}
 	return NULL;
@@ -126,6 +126,52 @@ public:
 };
 
 
+/**
+* An immutable set of words, such as the stop words of a {@link StopFilter}.
+*
+* <p>The words are copied into one array when the set is built, and are found
+* by open addressing in a table of their hashes and lengths, so that a lookup
+* costs one hash of the word and, for a word of the set, one comparison.</p>
+*
+* <p>A set is never changed after it is built, so it can be used by any
+* number of filters and analyzers in any number of threads. It is reference
+* counted: whoever keeps a set takes a reference with _CL_POINTER and
+* releases it with _CLDECDELETE.</p>
+*/
+class CLUCENE_EXPORT StopWordSet: LUCENE_REFBASE {
+	struct Slot;
+	TCHAR* chars;		// the words, one after the other
+	Slot* slots;
+	int32_t mask;		// the number of slots, minus one
+	size_t count;
+
+	void init(const TCHAR* const* words, size_t wordCount, const bool ignoreCase);
+	void add(const TCHAR* word, const int32_t length, int32_t& offset);
+	const Slot* find(const TCHAR* word, const int32_t length, const size_t hash) const;
+	static size_t hash(const TCHAR* word, const int32_t length);
+public:
+	/**
+	* Builds a set of the words of a NULL terminated array. If ignoreCase is
+	* set, the words are case folded, for a filter that folds its tokens.
+	*/
+	StopWordSet(const TCHAR** words, const bool ignoreCase = false);
+
+	/** Builds a set of the words of a list, such as one filled by {@link WordlistLoader} */
+	StopWordSet(const CLTCSetList* words, const bool ignoreCase = false);
+
+	virtual ~StopWordSet();
+
+	/** Returns true if the first length characters of word are a word of the set */
+	bool contains(const TCHAR* word, const int32_t length) const;
+
+	/** Returns true if word is a word of the set */
+	bool contains(const TCHAR* word) const;
+
+	/** The number of words of the set */
+	size_t size() const;
+};
+
+
 /**
  * Removes stop words from a token stream.
  */
@@ -136,6 +182,8 @@ private:
 	//ish: implement a radix/patricia tree for this?
 	CLTCSetList* stopWords;
 	bool deleteStopTable;
+	// the stop words, if the filter was not built with a CLTCSetList
+	StopWordSet* stopSet;
 
 	bool enablePositionIncrements;
 	const bool ignoreCase;
@@ -152,6 +200,14 @@ public:
 	*	TokenStream that are named in the CLSetList.
 	*/
 	StopFilter(TokenStream* in, bool deleteTokenStream, CLTCSetList* stopTable, bool _deleteStopTable=false);
+
+	/**
+	* Constructs a filter which removes words from the input TokenStream that
+	* are in stopSet. If ignoreCase is set, the tokens are case folded
+	* before they are looked up, so the set should be built with ignoreCase.
+	* @memory a reference to stopSet is held until the filter is deleted
+	*/
+	StopFilter(TokenStream* in, bool deleteTokenStream, StopWordSet* stopSet, const bool _ignoreCase = false);
 	
 	/**
 	* Builds a Hashtable from an array of stop words, appropriate for passing
@@ -235,7 +291,7 @@ public:
 
 /** Filters LetterTokenizer with LowerCaseFilter and StopFilter. */
 class CLUCENE_EXPORT StopAnalyzer: public Analyzer {
-	CLTCSetList* stopTable;
+	StopWordSet* stopSet;
     class SavedStreams;
 
 public:
@@ -256,6 +312,12 @@ public:
 	*/
 	StopAnalyzer(CL_NS(util)::Reader* stopwordsReader, const bool _bDeleteReader = false);
 
+	/** Builds an analyzer with the given stop words, which it shares with
+	* other analyzers and filters.
+	* @memory a reference to stopWords is held until the analyzer is deleted
+	*/
+	StopAnalyzer(StopWordSet* stopWords);
+
     /** Filters LowerCaseTokenizer with StopFilter. */
     TokenStream* tokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader);
     TokenStream* reusableTokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader);
@@ -20,29 +20,36 @@ CL_NS_USE(analysis)
 CL_NS_DEF2(analysis,standard)
 
 	StandardAnalyzer::StandardAnalyzer():
-		stopSet(_CLNEW CLTCSetList(true)), maxTokenLength(DEFAULT_MAX_TOKEN_LENGTH)
+		stopSet(_CLNEW StopWordSet(CL_NS(analysis)::StopAnalyzer::ENGLISH_STOP_WORDS)), maxTokenLength(DEFAULT_MAX_TOKEN_LENGTH)
 	{
-      StopFilter::fillStopTable( stopSet,CL_NS(analysis)::StopAnalyzer::ENGLISH_STOP_WORDS);
 	}
 
 	StandardAnalyzer::StandardAnalyzer( const TCHAR** stopWords):
-		stopSet(_CLNEW CLTCSetList(true)), maxTokenLength(DEFAULT_MAX_TOKEN_LENGTH)
+		stopSet(_CLNEW StopWordSet(stopWords)), maxTokenLength(DEFAULT_MAX_TOKEN_LENGTH)
 	{
-		StopFilter::fillStopTable( stopSet,stopWords );
 	}
 
 	StandardAnalyzer::StandardAnalyzer(const char* stopwordsFile, const char* enc):
-		stopSet(_CLNEW CLTCSetList(true)), maxTokenLength(DEFAULT_MAX_TOKEN_LENGTH)
+		stopSet(NULL), maxTokenLength(DEFAULT_MAX_TOKEN_LENGTH)
 	{
 		if ( enc == NULL )
 			enc = "ASCII";
-		WordlistLoader::getWordSet(stopwordsFile, enc, stopSet);
+		CLTCSetList words(true);
+		WordlistLoader::getWordSet(stopwordsFile, enc, &words);
+		stopSet = _CLNEW StopWordSet(&words);
 	}
 
 	StandardAnalyzer::StandardAnalyzer(CL_NS(util)::Reader* stopwordsReader, const bool _bDeleteReader):
-		stopSet(_CLNEW CLTCSetList(true)), maxTokenLength(DEFAULT_MAX_TOKEN_LENGTH)
+		stopSet(NULL), maxTokenLength(DEFAULT_MAX_TOKEN_LENGTH)
+	{
+		CLTCSetList words(true);
+		WordlistLoader::getWordSet(stopwordsReader, &words, _bDeleteReader);
+		stopSet = _CLNEW StopWordSet(&words);
+	}
+
+	StandardAnalyzer::StandardAnalyzer(StopWordSet* stopWords):
+		stopSet(_CL_POINTER(stopWords)), maxTokenLength(DEFAULT_MAX_TOKEN_LENGTH)
 	{
-		WordlistLoader::getWordSet(stopwordsReader, stopSet, _bDeleteReader);
 	}
 
         class StandardAnalyzer::SavedStreams : public TokenStream {
@@ -67,7 +74,7 @@ CL_NS_DEF2(analysis,standard)
 	StandardAnalyzer::~StandardAnalyzer(){
         SavedStreams* t = reinterpret_cast<SavedStreams*>(this->getPreviousTokenStream());
         if (t) _CLDELETE(t->filteredTokenStream);
-		_CLLDELETE(stopSet);
+		_CLDECDELETE(stopSet);
 	}
 
 
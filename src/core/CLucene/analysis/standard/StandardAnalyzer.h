@@ -8,6 +8,7 @@
 #define _lucene_analysis_standard_StandardAnalyzer
 
 CL_CLASS_DEF(util,BufferedReader)
+CL_CLASS_DEF(analysis,StopWordSet)
 #include "CLucene/analysis/AnalysisHeader.h"
 
 CL_NS_DEF2(analysis,standard)
@@ -20,7 +21,7 @@ CL_NS_DEF2(analysis,standard)
 	class CLUCENE_EXPORT StandardAnalyzer : public Analyzer 
 	{
 	private:
-		CLTCSetList* stopSet;
+		StopWordSet* stopSet;
         int32_t maxTokenLength;
 
         class SavedStreams;
@@ -44,6 +45,12 @@ CL_NS_DEF2(analysis,standard)
 		*/
 		StandardAnalyzer(CL_NS(util)::Reader* stopwordsReader, const bool _bDeleteReader = false);
 
+		/** Builds an analyzer with the given stop words, which it shares with
+		* other analyzers and filters.
+		* @memory a reference to stopWords is held until the analyzer is deleted
+		*/
+		StandardAnalyzer(StopWordSet* stopWords);
+
 		virtual ~StandardAnalyzer();
 
         /**
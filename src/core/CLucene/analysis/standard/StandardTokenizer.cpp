@@ -9,6 +9,7 @@
 #include "CLucene/util/StringBuffer.h"
 #include "CLucene/util/_FastCharStream.h"
 #include "CLucene/util/CLStreams.h"
+#include "CLucene/util/CharTables.h"
 
 CL_NS_USE(analysis)
 CL_NS_USE(util)
@@ -29,13 +30,48 @@ CL_NS_DEF2(analysis,standard)
   const TCHAR** tokenImage = tokenImageArray;
 
 
+  /* Classes of the ASCII characters, so that the common characters are not
+  ** classified by the _ist* functions one call at a time. The table is filled
+  ** with those functions, which agree on ASCII in every locale; all other
+  ** characters go through CharTables. */
+  enum CharClass{
+    CC_SPACE = 1,
+    CC_ALPHA = 2,
+    CC_ALNUM = 4,
+    CC_DIGIT = 8,
+    CC_UNDERSCORE = 16,
+    CC_SEPARATOR = 32,	// characters that next() skips between tokens
+    CC_WORD_END = 64	// characters that end an ALPHANUM token
+  };
+  static struct AsciiClasses{
+    uint8_t classes[128];
+    AsciiClasses(){
+      for ( int ch=0;ch<128;ch++ ){
+        uint8_t c = 0;
+        if ( _istspace((TCHAR)ch) ) c |= CC_SPACE;
+        if ( _istalpha((TCHAR)ch) ) c |= CC_ALPHA;
+        if ( _istalnum(ch) ) c |= CC_ALNUM;
+        if ( _istdigit(ch) ) c |= CC_DIGIT;
+        if ( ch == '_' ) c |= CC_UNDERSCORE;
+        if ( (c & (CC_ALPHA | CC_DIGIT | CC_UNDERSCORE)) == 0 && ch != '-' && ch != '.' )
+          c |= CC_SEPARATOR;
+        if ( (c & (CC_ALNUM | CC_UNDERSCORE)) == 0 && ch != '.' && ch != '\'' && ch != '@' && ch != '&' )
+          c |= CC_WORD_END;
+        classes[ch] = c;
+      }
+    }
+  } asciiClasses;
+
+  #define IS_ASCII(c)   (static_cast<uint32_t>(c) < 128)
+  #define CLASS_OF(cls, otherwise) (IS_ASCII(ch) ? (asciiClasses.classes[ch] & (cls)) != 0 : (otherwise))
+
   /* A bunch of shortcut macros, many of which make assumptions about variable
   ** names.  These macros enhance readability, not just convenience! */
   #define EOS           (ch==-1 || rd->Eos())
-  #define SPACE         (_istspace((TCHAR)ch) != 0)
-  #define ALPHA         (_istalpha((TCHAR)ch) != 0)
-  #define ALNUM         (_istalnum(ch) != 0)
-  #define DIGIT         (_istdigit(ch) != 0)
+  #define SPACE         CLASS_OF(CC_SPACE, CharTables::isSpace((TCHAR)ch))
+  #define ALPHA         CLASS_OF(CC_ALPHA, CharTables::isLetter((TCHAR)ch))
+  #define ALNUM         CLASS_OF(CC_ALNUM, CharTables::isAlnum((TCHAR)ch))
+  #define DIGIT         CLASS_OF(CC_DIGIT, CharTables::isDigit((TCHAR)ch))
   #define UNDERSCORE    (ch == '_')
   
   #define _CJK			(  (ch>=0x3040 && ch<=0x318f) || \
@@ -58,14 +94,18 @@ CL_NS_DEF2(analysis,standard)
   //freebsd seems to have a problem with defines over multiple lines, so this has to be one long line
   #define _CONSUME_AS_LONG_AS(conditionFails) while (true) { ch = readChar(); if (ch==-1 || (!(conditionFails) || str.len >= LUCENE_MAX_WORD_LEN)) { break; } str.appendChar(ch);}
 
-  #define CONSUME_ALPHAS _CONSUME_AS_LONG_AS(ALPHA)
+  /* Consumes the ASCII characters of class cls that are in the buffer in one
+  ** go, then the rest of the span one character at a time. */
+  #define _CONSUME_CLASS(cls, conditionFails) consumeAscii(str, cls); _CONSUME_AS_LONG_AS(conditionFails)
+
+  #define CONSUME_ALPHAS _CONSUME_CLASS(CC_ALPHA, ALPHA)
 
-  #define CONSUME_DIGITS _CONSUME_AS_LONG_AS(DIGIT)
+  #define CONSUME_DIGITS _CONSUME_CLASS(CC_DIGIT, DIGIT)
 
   /* otherMatches is a condition (possibly compound) under which a character
   ** that's not an ALNUM or UNDERSCORE can be considered not to break the
   ** span.  Callers should pass false if only ALNUM/UNDERSCORE are acceptable. */
-  #define CONSUME_WORD                  _CONSUME_AS_LONG_AS(ALNUM || UNDERSCORE)
+  #define CONSUME_WORD                  _CONSUME_CLASS(CC_ALNUM | CC_UNDERSCORE, ALNUM || UNDERSCORE)
   
   /*
   ** Consume CJK characters
@@ -98,7 +138,8 @@ CL_NS_DEF2(analysis,standard)
     ** position when readChar() is first called. */
     rdPos(-1),
     tokenStart(-1),
-    rd(_CLNEW FastCharStream(reader))
+    rd(_CLNEW FastCharStream(reader)),
+    filter(NULL)
   {
 	  this->reader = reader;
 	  this->deleteReader = deleteReader;
@@ -108,32 +149,78 @@ CL_NS_DEF2(analysis,standard)
     _CLDELETE(rd);
     if ( this->deleteReader )
     	_CLDELETE(reader)
+    _CLDELETE(filter);
   }
 
-  int StandardTokenizer::readChar() {
+  inline int StandardTokenizer::readChar() {
     /* Increment by 1 because we're speaking in terms of characters, not
     ** necessarily bytes: */
     rdPos++;
     return rd->GetNext();
   }
 
-  void StandardTokenizer::unReadChar() {
+  inline void StandardTokenizer::unReadChar() {
     rd->UnGet();
     rdPos--;
   }
 
+  inline void StandardTokenizer::skipSeparators() {
+    int32_t count;
+    const TCHAR* chars = rd->Available(count);
+    int32_t i = 0;
+    while ( i < count && IS_ASCII(chars[i]) && (asciiClasses.classes[chars[i]] & CC_SEPARATOR) != 0 )
+      i++;
+    rd->Skip(i);
+    rdPos += i;
+  }
+
+  inline void StandardTokenizer::consumeAscii(StringBuffer& str, int32_t cls) {
+    int32_t count;
+    const TCHAR* chars = rd->Available(count);
+    const int32_t space = LUCENE_MAX_WORD_LEN - (int32_t)str.len;
+    if ( count > space )
+      count = space;
+
+    /* the buffer of str was grown to hold a whole word by the caller */
+    TCHAR* buf = str.getBuffer() + str.len;
+    int32_t i = 0;
+    for ( ;i<count;i++ ){
+      const TCHAR ch = chars[i];
+      if ( !IS_ASCII(ch) || (asciiClasses.classes[ch] & cls) == 0 )
+        break;
+      buf[i] = ch;
+    }
+    str.len += i;
+    rd->Skip(i);
+    rdPos += i;
+  }
+
   inline Token* StandardTokenizer::setToken(Token* t, StringBuffer* sb, TokenTypes tokenCode) {
     t->setStartOffset(tokenStart);
 	  t->setEndOffset(tokenStart+sb->length());
 	  t->setType(tokenImage[tokenCode]);
 	  sb->getBuffer(); //null terminates the buffer
-	  t->resetTermTextLen();
+	  t->setTermLength(sb->len);
 	  return t;
   }
 
   void StandardTokenizer::reset(Reader* _input) {
 	this->input = _input;
-    if (rd->input==NULL) rd->input = _input->__asBufferedReader();
+    BufferedReader* bufferedReader = _input->__asBufferedReader();
+    if ( bufferedReader == NULL ){
+      if ( filter == NULL )
+        filter = _CLNEW FilteredBufferedReader(_input, false);
+      else
+        filter->setInput(_input);
+      bufferedReader = filter;
+    }
+    if ( bufferedReader != reader ){
+      if ( deleteReader )
+        _CLDELETE(reader);
+      reader = bufferedReader;
+      deleteReader = false;
+    }
+    rd->input = reader;
     rdPos = -1;
     tokenStart = -1;
     rd->reset();
@@ -143,6 +230,7 @@ CL_NS_DEF2(analysis,standard)
     int ch=0;
 
     while (!EOS) {
+      skipSeparators();
       ch = readChar();
 
       if ( ch == 0 || ch == -1 ){
@@ -258,6 +346,34 @@ CL_NS_DEF2(analysis,standard)
 
   Token* StandardTokenizer::ReadAlphaNum(const TCHAR prev, Token* t) {
     t->growBuffer(LUCENE_MAX_WORD_LEN+1);//make sure token can hold the next word
+
+    /* Fast path for the common case: the rest of the word is ASCII and is
+    ** followed, within the buffer of the reader, by a character that ends it.
+    ** The word is copied straight into the token. */
+    {
+      int32_t count;
+      const TCHAR* chars = rd->Available(count);
+      const int32_t maxRun = cl_min(count, LUCENE_MAX_WORD_LEN-3);
+      TCHAR* buf = t->termBuffer();
+      buf[0] = prev;
+      int32_t i = 0;
+      while ( i < maxRun && IS_ASCII(chars[i]) && (asciiClasses.classes[chars[i]] & (CC_ALNUM | CC_UNDERSCORE)) != 0 ){
+        buf[i+1] = chars[i];
+        i++;
+      }
+      if ( i < maxRun && IS_ASCII(chars[i]) && (asciiClasses.classes[chars[i]] & CC_WORD_END) != 0 ){
+        const int32_t len = i + 1;
+        buf[len] = 0;
+        rd->Skip(len); //the word and the character that ends it
+        rdPos += len;
+        t->setStartOffset(tokenStart);
+        t->setEndOffset(tokenStart+len);
+        t->setType(tokenImage[CL_NS2(analysis,standard)::ALPHANUM]);
+        t->setTermLength(len);
+        return t;
+      }
+    }
+
     StringBuffer str(t->termBuffer(),t->bufferLength(),true); //use stringbuffer to read data onto the termText
 	  if (  str.len < LUCENE_MAX_WORD_LEN ){
 		  str.appendChar(prev);
@@ -462,3 +578,14 @@ CL_NS_DEF2(analysis,standard)
   }
 
 CL_NS_END2
+
+// the monolithic build compiles the files that follow in the same unit
+#undef EOS
+#undef SPACE
+#undef ALPHA
+#undef ALNUM
+#undef DIGIT
+#undef UNDERSCORE
+#undef DASH
+#undef DOT
+#undef DECIMAL
@@ -12,6 +12,7 @@
 #include "StandardTokenizerConstants.h"
 CL_CLASS_DEF(analysis,Token)
 CL_CLASS_DEF(util,BufferedReader)
+CL_CLASS_DEF(util,FilteredBufferedReader)
 CL_CLASS_DEF(util,StringBuffer)
 CL_CLASS_DEF(util,FastCharStream)
 
@@ -42,6 +43,11 @@ CL_NS_DEF2(analysis,standard)
     int readChar();
     // Retreat by one character, decrementing rdPos.
     void unReadChar();
+    // Skips the ASCII characters between tokens that are in the buffer of the reader.
+    void skipSeparators();
+    // Appends the ASCII characters of the given classes that follow to str,
+    // as long as they are in the buffer of the reader.
+    void consumeAscii(CL_NS(util)::StringBuffer& str, int32_t cls);
 
     // createToken centralizes token creation for auditing purposes.
 	//Token* createToken(CL_NS(util)::StringBuffer* sb, TokenTypes tokenCode);
@@ -52,6 +58,8 @@ CL_NS_DEF2(analysis,standard)
 	CL_NS(util)::BufferedReader* reader;
 	bool deleteReader;
 	CL_NS(util)::FastCharStream* rd;
+	// buffers readers that are not buffered, kept across reset()
+	CL_NS(util)::FilteredBufferedReader* filter;
   public:
 
     // Constructs a tokenizer for this Reader.
@@ -81,6 +89,8 @@ CL_NS_DEF2(analysis,standard)
     // Reads CJK characters
     Token* ReadCJK(const TCHAR prev, Token* t);
 
+    /** Reads from _input from now on. A reader that is not buffered is
+    * buffered by a reader of this tokenizer that is kept for the next reset */
     virtual void reset(CL_NS(util)::Reader* _input);
   };
 
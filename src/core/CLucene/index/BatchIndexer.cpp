@@ -0,0 +1,241 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "BatchIndexer.h"
+#include "IndexWriter.h"
+#include "Term.h"
+#include "_DocumentsWriter.h"
+#include "CLucene/document/Document.h"
+#include "CLucene/util/Misc.h"
+
+CL_NS_USE(util)
+CL_NS_USE(document)
+CL_NS_USE(analysis)
+CL_NS_DEF(index)
+
+/** Lets the worker that took the next document go on once it has its docID */
+class BatchIndexer::Assigned: public DocIDCallback{
+public:
+  BatchIndexer* indexer;
+  bool called;
+  Assigned(BatchIndexer* _indexer): indexer(_indexer), called(false){}
+  void docIDAssigned(){
+    called = true;
+    indexer->docIDAssigned();
+  }
+};
+
+BatchIndexer::Stats::Stats():
+  queued(0), indexed(0), failed(0), dropped(0),
+  producerWaits(0), workerWaits(0), elapsedMillis(0)
+{
+}
+double BatchIndexer::Stats::docsPerSecond() const{
+  if ( elapsedMillis <= 0 )
+    return 0;
+  return indexed * 1000.0 / elapsedMillis;
+}
+
+BatchIndexer::BatchIndexer(IndexWriter* _writer, int32_t _numThreads, int32_t _maxQueued, Analyzer* _analyzer):
+  writer(_writer),
+  analyzer(_analyzer),
+  numThreads(_numThreads),
+  threads(NULL),
+  queue(NULL),
+  maxQueued(_maxQueued),
+  queueStart(0),
+  queueCount(0),
+  assigning(false),
+  finishing(false),
+  finished(false),
+  error(NULL),
+  startTime(Misc::currentTimeMillis())
+{
+#ifdef _CL_DISABLE_MULTITHREADING
+  // the documents are added by the calling thread
+  numThreads = 0;
+#endif
+  if ( numThreads < 0 )
+    numThreads = 0;
+  if ( maxQueued < 1 )
+    maxQueued = cl_max(numThreads, (int32_t)1) * 4;
+  queue = _CL_NEWARRAY(Entry, maxQueued);
+
+  threads = _CL_NEWARRAY(_LUCENE_THREADID_TYPE, numThreads + 1);
+  for ( int32_t i=0;i<numThreads;i++ )
+    threads[i] = _LUCENE_THREAD_CREATE(&workerThread, this);
+}
+
+BatchIndexer::~BatchIndexer(){
+  try{
+    finish();
+  }catch(CLuceneError&){
+    // already reported by finish(), if it was called
+  }
+  _CLDELETE_ARRAY(threads);
+  _CLDELETE_ARRAY(queue);
+  _CLDELETE(error);
+}
+
+int32_t BatchIndexer::getNumThreads() const{
+  return numThreads;
+}
+
+BatchIndexer::Stats BatchIndexer::getStats() const{
+  SCOPED_LOCK_MUTEX(THIS_LOCK)
+  Stats ret = stats;
+  ret.elapsedMillis = Misc::currentTimeMillis() - startTime;
+  return ret;
+}
+
+void BatchIndexer::addDocument(Document* doc){
+  queueDocument(NULL, doc);
+}
+
+void BatchIndexer::updateDocument(Term* term, Document* doc){
+  queueDocument(term, doc);
+}
+
+void BatchIndexer::queueDocument(Term* term, Document* doc){
+  Entry entry;
+  entry.doc = doc;
+  entry.term = term == NULL ? NULL : _CL_POINTER(term);
+
+  if ( numThreads == 0 ){
+    {
+      SCOPED_LOCK_MUTEX(THIS_LOCK)
+      if ( error == NULL && !finishing )
+        stats.queued++;
+    }
+    if ( error == NULL && !finishing ){
+      Assigned assigned(this);
+      index(entry, &assigned);
+    }else{
+      _CLDELETE(entry.doc);
+      _CLDECDELETE(entry.term);
+    }
+  }else{
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+    if ( queueCount == maxQueued && error == NULL && !finishing ){
+      stats.producerWaits++;
+      while ( queueCount == maxQueued && error == NULL && !finishing )
+        CONDITION_WAIT(THIS_LOCK, THIS_WAIT_CONDITION)
+    }
+    if ( error == NULL && !finishing ){
+      queue[(queueStart + queueCount) % maxQueued] = entry;
+      queueCount++;
+      stats.queued++;
+      CONDITION_NOTIFYALL(THIS_WAIT_CONDITION)
+      return;
+    }
+    _CLDELETE(entry.doc);
+    _CLDECDELETE(entry.term);
+  }
+
+  if ( finishing && error == NULL )
+    _CLTHROWA(CL_ERR_IllegalState, "BatchIndexer is finished");
+  throwError();
+}
+
+void BatchIndexer::throwError(){
+  SCOPED_LOCK_MUTEX(THIS_LOCK)
+  if ( error != NULL )
+    throw CLuceneError(*error);
+}
+
+void BatchIndexer::finish(){
+  {
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+    finishing = true;
+    CONDITION_NOTIFYALL(THIS_WAIT_CONDITION)
+  }
+  if ( !finished ){
+    for ( int32_t i=0;i<numThreads;i++ )
+      _LUCENE_THREAD_JOIN(threads[i]);
+    finished = true;
+  }
+  throwError();
+}
+
+void BatchIndexer::docIDAssigned(){
+  SCOPED_LOCK_MUTEX(THIS_LOCK)
+  assigning = false;
+  CONDITION_NOTIFYALL(THIS_WAIT_CONDITION)
+}
+
+void BatchIndexer::index(Entry& entry, Assigned* assigned){
+  assigned->called = false;
+  bool success = false;
+  try{
+    writer->updateDocument(entry.term, entry.doc, analyzer, assigned);
+    success = true;
+  }catch(CLuceneError& err){
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+    if ( error == NULL )
+      error = _CLNEW CLuceneError(err);
+  }catch(...){
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+    if ( error == NULL )
+      error = _CLNEW CLuceneError(CL_ERR_Runtime, "unknown error while adding a document", false);
+  }
+  _CLDELETE(entry.doc);
+  _CLDECDELETE(entry.term);
+
+  SCOPED_LOCK_MUTEX(THIS_LOCK)
+  // the writer may have failed before the document got a docID
+  if ( !assigned->called )
+    assigning = false;
+  if ( success )
+    stats.indexed++;
+  else
+    stats.failed++;
+  CONDITION_NOTIFYALL(THIS_WAIT_CONDITION)
+}
+
+void BatchIndexer::run(){
+  Assigned assigned(this);
+  for (;;){
+    Entry entry;
+    {
+      SCOPED_LOCK_MUTEX(THIS_LOCK)
+      // the documents are taken one at a time, each after the previous one
+      // has its docID, so that the docIDs follow the order of the queue
+      bool waited = false;
+      while ( assigning || queueCount == 0 ){
+        if ( queueCount == 0 && finishing )
+          return;
+        if ( queueCount == 0 && !waited ){
+          stats.workerWaits++;
+          waited = true;
+        }
+        CONDITION_WAIT(THIS_LOCK, THIS_WAIT_CONDITION)
+      }
+      entry = queue[queueStart];
+      queueStart = (queueStart + 1) % maxQueued;
+      queueCount--;
+      CONDITION_NOTIFYALL(THIS_WAIT_CONDITION)
+
+      if ( error != NULL ){
+        // drop the documents still queued after an error
+        stats.dropped++;
+        _CLDELETE(entry.doc);
+        _CLDECDELETE(entry.term);
+        continue;
+      }
+      assigning = true;
+    }
+    index(entry, &assigned);
+  }
+}
+
+_LUCENE_THREAD_FUNC(BatchIndexer::workerThread, arg){
+  BatchIndexer* indexer = static_cast<BatchIndexer*>(arg);
+  indexer->run();
+  _LUCENE_THREAD_FUNC_RETURN(0);
+}
+
+CL_NS_END
@@ -0,0 +1,143 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_index_BatchIndexer_
+#define _lucene_index_BatchIndexer_
+
+#include "CLucene/LuceneThreads.h"
+CL_CLASS_DEF(analysis,Analyzer)
+CL_CLASS_DEF(document,Document)
+
+CL_NS_DEF(index)
+
+class IndexWriter;
+class Term;
+
+/**
+ * Adds a stream of documents to an {@link IndexWriter} on several threads.
+ *
+ * <p>The caller queues documents with {@link #addDocument} and
+ * {@link #updateDocument}; worker threads take them from the queue and add
+ * them to the writer. Each worker analyzes and inverts its documents in its
+ * own thread state of the writer, while the stored fields and term vectors
+ * of the finished documents are appended to the segment in docID order.
+ * The queue holds a fixed number of documents: when it is full the caller
+ * waits for the workers, so a fast producer cannot use up memory.</p>
+ *
+ * <p>The documents get their docIDs in the order they were queued, so
+ * the index looks as if they had been added one by one by the calling
+ * thread.</p>
+ *
+ * <pre>
+ * BatchIndexer indexer(writer, 4);
+ * while ( ... ){
+ *   Document* doc = _CLNEW Document();
+ *   ...
+ *   indexer.addDocument(doc);
+ * }
+ * indexer.finish();
+ * </pre>
+ *
+ * <p>The first error of a worker stops the indexer: the documents still
+ * queued are dropped, and the error is thrown by the next call of
+ * addDocument, updateDocument or finish. The writer must not be closed
+ * before {@link #finish} returns.</p>
+ */
+class CLUCENE_EXPORT BatchIndexer: LUCENE_BASE {
+public:
+  /** Throughput counters of a BatchIndexer */
+  class CLUCENE_EXPORT Stats{
+  public:
+    int64_t queued;        ///< documents given to the indexer
+    int64_t indexed;       ///< documents added to the writer
+    int64_t failed;        ///< documents whose addition threw an error
+    int64_t dropped;       ///< documents dropped after an error
+    int64_t producerWaits; ///< times the caller waited for room in the full queue
+    int64_t workerWaits;   ///< times a worker waited for the empty queue
+    int64_t elapsedMillis; ///< time since the indexer was created
+    Stats();
+    /** The indexed documents per second */
+    double docsPerSecond() const;
+  };
+
+  /**
+   * @param writer the writer the documents are added to
+   * @param numThreads the number of worker threads
+   * @param maxQueued the number of documents that can wait in the queue,
+   *                  or -1 for four per worker thread
+   * @param analyzer the analyzer of the documents, or NULL for the one of
+   *                 the writer
+   */
+  BatchIndexer(IndexWriter* writer, int32_t numThreads, int32_t maxQueued = -1,
+               CL_NS(analysis)::Analyzer* analyzer = NULL);
+
+  /** Calls {@link #finish}, but does not throw its errors */
+  ~BatchIndexer();
+
+  /**
+   * Queues doc to be added to the writer, waiting while the queue is full
+   * @memory doc is deleted by the indexer, also if an error is thrown
+   */
+  void addDocument(CL_NS(document)::Document* doc);
+
+  /**
+   * Queues doc to be added to the writer after the documents containing
+   * term are deleted, as {@link IndexWriter#updateDocument} does
+   * @memory doc is deleted by the indexer, also if an error is thrown; a
+   * reference to term is held until the document is added
+   */
+  void updateDocument(Term* term, CL_NS(document)::Document* doc);
+
+  /**
+   * Waits until the queued documents are added and stops the worker
+   * threads. Documents cannot be queued afterwards. Throws the first error
+   * of the workers, if any.
+   */
+  void finish();
+
+  /** The counters so far */
+  Stats getStats() const;
+
+  /** The number of worker threads */
+  int32_t getNumThreads() const;
+
+private:
+  struct Entry{
+    CL_NS(document)::Document* doc;
+    Term* term;
+  };
+  class Assigned;
+
+  IndexWriter* writer;
+  CL_NS(analysis)::Analyzer* analyzer;
+  int32_t numThreads;
+  _LUCENE_THREADID_TYPE* threads;
+
+  Entry* queue;        // a ring of maxQueued entries
+  int32_t maxQueued;
+  int32_t queueStart;  // the oldest entry
+  int32_t queueCount;
+  bool assigning;      // a worker took a document that has no docID yet
+  bool finishing;
+  bool finished;
+  CLuceneError* error; // the first error of a worker
+  Stats stats;
+  int64_t startTime;
+
+  DEFINE_MUTABLE_MUTEX(THIS_LOCK)
+  DEFINE_CONDITION(THIS_WAIT_CONDITION)
+
+  void queueDocument(Term* term, CL_NS(document)::Document* doc);
+  // adds the document of entry to the writer, called without the lock
+  void index(Entry& entry, Assigned* assigned);
+  void docIDAssigned();
+  void throwError();
+  void run();
+  static _LUCENE_THREAD_FUNC(workerThread, arg);
+};
+
+CL_NS_END
+#endif
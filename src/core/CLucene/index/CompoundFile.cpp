@@ -12,6 +12,7 @@
 #include "CLucene/util/Misc.h"
 #include "CLucene/store/IndexInput.h"
 #include "CLucene/store/IndexOutput.h"
+#include "CLucene/store/StatsDirectory.h"
 
 CL_NS_USE(store)
 CL_NS_USE(util)
@@ -129,7 +130,11 @@ CompoundFileReader::CompoundFileReader(Directory* dir, const char* name, int32_t
    bool success = false;
 
    try {
-      stream = dir->openInput(name, readBufferSize);
+      // the files inside are counted by their own type, see openInput
+      if ( dir->instanceOf(StatsDirectory::getClassName()) )
+         stream = ((StatsDirectory*)dir)->getDelegate()->openInput(name, readBufferSize);
+      else
+         stream = dir->openInput(name, readBufferSize);
 
       // read the directory and init files
       int32_t count = stream->readVInt();
@@ -221,6 +226,8 @@ bool CompoundFileReader::openInput(const char * id, CL_NS(store)::IndexInput *&
 		bufferSize = readBufferSize;
 
 	ret = _CLNEW CSIndexInput(stream, entry->offset, entry->length, bufferSize);
+	if ( directory->instanceOf(StatsDirectory::getClassName()) )
+		ret = ((StatsDirectory*)directory)->wrapInput(id, ret, bufferSize);
 	return true;
 }
 
@@ -379,12 +386,10 @@ void CompoundFileWriter::close(){
       // Open the files and copy their data into the stream.
       // Remember the locations of each file's data section.
       { //msvc6 for scope fix
-      const int32_t bufferLength = 16384;
-		  uint8_t buffer[bufferLength];
 		  for ( CL_NS(util)::CLLinkedList<WriterFileEntry*>::iterator i=_internal->entries->begin();i!=_internal->entries->end();i++ ){
 			  WriterFileEntry* fe = *i;
 			  fe->dataOffset = os->getFilePointer();
-			  copyFile(fe, os, buffer, bufferLength);
+			  copyFile(fe, os);
 		  }
 	  }
 
@@ -405,7 +410,7 @@ void CompoundFileWriter::close(){
 }
 
 
-void CompoundFileWriter::copyFile(WriterFileEntry* source, IndexOutput* os, uint8_t* buffer, int32_t bufferLength){
+void CompoundFileWriter::copyFile(WriterFileEntry* source, IndexOutput* os){
   IndexInput* is = NULL;
   try {
       int64_t startPtr = os->getFilePointer();
@@ -413,18 +418,19 @@ void CompoundFileWriter::copyFile(WriterFileEntry* source, IndexOutput* os, uint
       is = _internal->directory->openInput(source->file);
       int64_t length = is->length();
       int64_t remainder = length;
-      int32_t chunk = bufferLength;
+      int32_t chunk = LUCENE_COMPOUND_FILE_COPY_CHUNK_SIZE;
 
       while(remainder > 0) {
           int32_t len = (int32_t)cl_min((int64_t)chunk, remainder);
-          is->readBytes(buffer, len);
-          os->writeBytes(buffer, len);
+          // copyBytes lets the output copy between files of the same
+          // Directory without a user space buffer
+          os->copyBytes(is, len);
           remainder -= len;
 
           if (_internal->checkAbort != NULL)
-            // Roughly every 2 MB we will check if
-            // it's time to abort
-            _internal->checkAbort->work(80);
+            // 80 units per 16 KB, so we still check roughly
+            // every 2 MB if it's time to abort
+            _internal->checkAbort->work(80.0f * len / 16384);
       }
 
       // Verify that remainder is 0
@@ -940,10 +940,13 @@ bool DocumentsWriter::updateDocument(Term* t, Document* doc, Analyzer* analyzer)
   return updateDocument(doc, analyzer, t);
 }
 
-bool DocumentsWriter::updateDocument(Document* doc, Analyzer* analyzer, Term* delTerm) {
+bool DocumentsWriter::updateDocument(Document* doc, Analyzer* analyzer, Term* delTerm,
+                                     DocIDCallback* callback) {
 
   // This call is synchronized but fast
   ThreadState* state = getThreadState(doc, delTerm);
+  if (callback != NULL)
+    callback->docIDAssigned();
   try {
     bool success = false;
     try {
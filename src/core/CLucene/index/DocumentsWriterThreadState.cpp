@@ -881,10 +881,11 @@ void DocumentsWriter::ThreadState::FieldData::invertField(Field* field, Analyzer
         reader = readerValue;
       else {
         const TCHAR* stringValue = field->stringValue();
-        size_t stringValueLength = _tcslen(stringValue);
         if (stringValue == NULL)
           _CLTHROWA(CL_ERR_IllegalArgument, "field must have either TokenStream, String or Reader value");
-        threadState->stringReader->init(stringValue, stringValueLength);
+        size_t stringValueLength = _tcslen(stringValue);
+        // the value outlives the inversion of the field, so it is not copied
+        threadState->stringReader->init(stringValue, stringValueLength, false);
         reader = threadState->stringReader;
       }
 
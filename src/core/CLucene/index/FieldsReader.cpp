@@ -27,7 +27,8 @@ CL_NS_DEF(index)
 
 FieldsReader::FieldsReader(Directory* d, const char* segment, FieldInfos* fn, int32_t _readBufferSize, int32_t _docStoreOffset, int32_t size):
 	fieldInfos(fn), cloneableFieldsStream(NULL), fieldsStream(NULL), indexStream(NULL),
-        numTotalDocs(0),_size(0), closed(false),docStoreOffset(0)
+        numTotalDocs(0),_size(0), closed(false),docStoreOffset(0),origin(this),
+        fieldsStreamTL(_CLNEW ThreadLocal<IndexInput*, Deletor::Object<IndexInput> >)
 {
 //Func - Constructor
 //Pre  - d contains a valid reference to a Directory
@@ -75,12 +76,28 @@ FieldsReader::FieldsReader(Directory* d, const char* segment, FieldInfos* fn, in
 	});
 }
 
+FieldsReader::FieldsReader(const FieldsReader& copy):
+	fieldInfos(copy.fieldInfos), cloneableFieldsStream(NULL), fieldsStream(NULL), indexStream(NULL),
+	numTotalDocs(copy.numTotalDocs), _size(copy._size), closed(false), docStoreOffset(copy.docStoreOffset),
+	origin(copy.origin), fieldsStreamTL(NULL)
+{
+	fieldsStream = copy.cloneableFieldsStream->clone();
+	indexStream = copy.indexStream->clone();
+}
+
+FieldsReader* FieldsReader::clone() const{
+	if (closed || origin->closed)
+		_CLTHROWA(CL_ERR_IllegalState, "this FieldsReader is closed");
+	return _CLNEW FieldsReader(*origin);
+}
+
 FieldsReader::~FieldsReader(){
 //Func - Destructor
 //Pre  - true
 //Post - The instance has been destroyed
 
 	close();
+	_CLDELETE(fieldsStreamTL);
 }
 
 void FieldsReader::ensureOpen() {
@@ -104,7 +121,7 @@ void FieldsReader::close() {
 			_CLDELETE(indexStream);
 		}
 		/*
-		CL_NS(store)::IndexInput* localFieldsStream = fieldsStreamTL.get();
+		CL_NS(store)::IndexInput* localFieldsStream = fieldsStreamTL->get();
 		if (localFieldsStream != NULL) {
 			localFieldsStream->close();
 			fieldsStreamTL->set(NULL);
@@ -212,9 +229,9 @@ void FieldsReader::addFieldLazy(CL_NS(document)::Document& doc, const FieldInfo*
 		int32_t toRead = fieldsStream->readVInt();
 		int64_t pointer = fieldsStream->getFilePointer();
 		if (compressed) {
-			doc.add(*_CLNEW LazyField(this, fi->name, Field::STORE_COMPRESS, toRead, pointer));
+			doc.add(*_CLNEW LazyField(origin, fi->name, Field::STORE_COMPRESS, toRead, pointer));
 		} else {
-			doc.add(*_CLNEW LazyField(this, fi->name, Field::STORE_YES, toRead, pointer));
+			doc.add(*_CLNEW LazyField(origin, fi->name, Field::STORE_YES, toRead, pointer));
 		}
 		//Need to move the pointer ahead by toRead positions
 		fieldsStream->seek(pointer + toRead);
@@ -223,7 +240,7 @@ void FieldsReader::addFieldLazy(CL_NS(document)::Document& doc, const FieldInfo*
 		if (compressed) {
 			int32_t toRead = fieldsStream->readVInt();
 			int64_t pointer = fieldsStream->getFilePointer();
-			f = _CLNEW LazyField(this, fi->name, Field::STORE_COMPRESS, toRead, pointer);
+			f = _CLNEW LazyField(origin, fi->name, Field::STORE_COMPRESS, toRead, pointer);
 			//skip over the part that we aren't loading
 			fieldsStream->seek(pointer + toRead);
 			f->setOmitNorms(fi->omitNorms);
@@ -232,7 +249,7 @@ void FieldsReader::addFieldLazy(CL_NS(document)::Document& doc, const FieldInfo*
 			int64_t pointer = fieldsStream->getFilePointer();
 			//Skip ahead of where we are by the length of what is stored
 			fieldsStream->skipChars(length);
-			f = _CLNEW LazyField(this, fi->name, Field::STORE_YES | getIndexType(fi, tokenize) | getTermVectorType(fi), length, pointer);
+			f = _CLNEW LazyField(origin, fi->name, Field::STORE_YES | getIndexType(fi, tokenize) | getTermVectorType(fi), length, pointer);
 			f->setOmitNorms(fi->omitNorms);
 		}
 		doc.add(*f);
@@ -383,10 +400,10 @@ FieldsReader::LazyField::~LazyField(){
 }
 
 CL_NS(store)::IndexInput* FieldsReader::LazyField::getFieldStream(){
-	CL_NS(store)::IndexInput* localFieldsStream = parent->fieldsStreamTL.get();
+	CL_NS(store)::IndexInput* localFieldsStream = parent->fieldsStreamTL->get();
 	if (localFieldsStream == NULL) {
 		localFieldsStream = parent->cloneableFieldsStream->clone();
-		parent->fieldsStreamTL.set(localFieldsStream);
+		parent->fieldsStreamTL->set(localFieldsStream);
 	}
 	return localFieldsStream;
 }
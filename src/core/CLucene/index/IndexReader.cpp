@@ -61,7 +61,11 @@ CL_NS_DEF(index)
       CloseCallbackCompare> CloseCallbackMap;
     CloseCallbackMap closeCallbacks;
 
-    Internal(Directory* directory, IndexReader* _this)
+    // changed under the lock of the reader, see getModificationCount()
+    int32_t modificationCount;
+
+    Internal(Directory* directory, IndexReader* _this):
+      modificationCount(0)
     {
       if ( directory != NULL )
         this->directory = _CL_POINTER(directory);
@@ -181,6 +185,10 @@ CL_NS_DEF(index)
           _CLTHROWA(CL_ERR_UnsupportedOperation, "This reader does not support this method.");
     }
 
+  int32_t IndexReader::getModificationCount() const{
+    return _internal->modificationCount;
+  }
+
   void IndexReader::setTermInfosIndexDivisor(int32_t /*indexDivisor*/) {
     _CLTHROWA(CL_ERR_UnsupportedOperation, "This reader does not support this method.");
   }
@@ -210,6 +218,7 @@ CL_NS_DEF(index)
     this->ensureOpen();
     this->acquireWriteLock();
     this->hasChanges = true;
+    _internal->modificationCount++;
     this->doSetNorm(doc, field, value);
   }
 
@@ -325,6 +334,7 @@ CL_NS_DEF(index)
 
 	  //Have the document identified by docNum deleted
     hasChanges = true;
+    _internal->modificationCount++;
     doDelete(docNum);
   }
 
@@ -348,6 +358,7 @@ CL_NS_DEF(index)
     ensureOpen();
     acquireWriteLock();
     hasChanges = true;
+    _internal->modificationCount++;
     doUndeleteAll();
   }
 
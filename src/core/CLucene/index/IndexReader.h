@@ -353,6 +353,15 @@ public:
    */
 	virtual int64_t getVersion();
 
+  /**
+   * Expert: A counter that changes whenever documents are deleted or
+   * undeleted, or norms are set, through this reader. Unlike
+   * {@link #getVersion}, it changes as soon as the change is made, before
+   * it is committed. Caches of search results use it to detect results that
+   * became stale.
+   */
+	int32_t getModificationCount() const;
+
   /**<p>For IndexReader implementations that use
    * TermInfosReader to read terms, this sets the
    * indexDivisor to subsample the number of indexed terms
@@ -189,6 +189,8 @@ void IndexWriter::init(Directory* d, Analyzer* a, const bool create, const bool
   this->mergeExceptions = _CLNEW MergeExceptionsType;
   this->segmentsToOptimize = _CLNEW SegmentsToOptimizeType;
   this->mergePolicy = _CLNEW LogByteSizeMergePolicy();
+  this->mergeRateLimiter = NULL;
+  this->maxMergeFanIn = 0;
   this->localRollbackSegmentInfos = NULL;
   this->stopMerges = false;
   messageID = -1;
@@ -317,6 +319,26 @@ MergeScheduler* IndexWriter::getMergeScheduler() {
   return mergeScheduler;
 }
 
+void IndexWriter::setMergeRateLimiter(RateLimiter* limiter) {
+  ensureOpen();
+  this->mergeRateLimiter = limiter;
+}
+
+RateLimiter* IndexWriter::getMergeRateLimiter() {
+  return mergeRateLimiter;
+}
+
+void IndexWriter::setMaxMergeFanIn(int32_t maxFanIn) {
+  ensureOpen();
+  if (maxFanIn < 0 || maxFanIn == 1)
+    _CLTHROWA(CL_ERR_IllegalArgument, "maxFanIn must be 0 or at least 2");
+  this->maxMergeFanIn = maxFanIn;
+}
+
+int32_t IndexWriter::getMaxMergeFanIn() const {
+  return maxMergeFanIn;
+}
+
 void IndexWriter::setMaxMergeDocs(int32_t maxMergeDocs) {
   getLogMergePolicy()->setMaxMergeDocs(maxMergeDocs);
 }
@@ -580,7 +602,8 @@ void IndexWriter::closeInternal(bool waitForMerges) {
 bool IndexWriter::flushDocStores() {
 	SCOPED_LOCK_MUTEX(THIS_LOCK)
 
-  const std::vector<std::string>& files = docWriter->files();
+  // a copy: closeDocStore() frees the list of the docWriter
+  const std::vector<std::string> files = docWriter->files();
 
   bool useCompoundDocStore = false;
 
@@ -674,37 +697,7 @@ int32_t IndexWriter::docCount() {
 
 
 void IndexWriter::addDocument(Document* doc, Analyzer* analyzer) {
-  if ( analyzer == NULL ) analyzer = this->analyzer;
-  ensureOpen();
-  bool doFlush = false;
-  bool success = false;
-  try {
-    try {
-      doFlush = docWriter->addDocument(doc, analyzer);
-      success = true;
-    } _CLFINALLY (
-      if (!success) {
-
-        if (infoStream != NULL)
-          message(string("hit exception adding document"));
-
-        { SCOPED_LOCK_MUTEX(this->THIS_LOCK)
-          // If docWriter has some aborted files that were
-          // never incref'd, then we clean them up here
-          if (docWriter != NULL) {
-            const std::vector<std::string>* files = docWriter->abortedFiles();
-            if (files != NULL )
-              deleter->deleteNewFiles(*files);
-          }
-        }
-      }
-    )
-    if (doFlush)
-      flush(true, false);
-  } catch (std::bad_alloc&) {
-    hitOOM = true;
-    _CLTHROWA(CL_ERR_OutOfMemory,"Out of memory");
-  }
+  updateDocument(NULL, doc, analyzer, NULL);
 }
 
 void IndexWriter::deleteDocuments(Term* term) {
@@ -738,25 +731,33 @@ void IndexWriter::updateDocument(Term* term, Document* doc) {
 
 void IndexWriter::updateDocument(Term* term, Document* doc, Analyzer* analyzer)
 {
+  updateDocument(term, doc, analyzer, NULL);
+}
+
+void IndexWriter::updateDocument(Term* term, Document* doc, Analyzer* analyzer, DocIDCallback* callback)
+{
+  if ( analyzer == NULL ) analyzer = this->analyzer;
   ensureOpen();
   try {
     bool doFlush = false;
     bool success = false;
     try {
-      doFlush = docWriter->updateDocument(term, doc, analyzer);
+      doFlush = docWriter->updateDocument(doc, analyzer, term, callback);
       success = true;
     } _CLFINALLY (
       if (!success) {
 
         if (infoStream != NULL)
-          message(string("hit exception updating document"));
+          message(term == NULL ? string("hit exception adding document") : string("hit exception updating document"));
 
         { SCOPED_LOCK_MUTEX(this->THIS_LOCK)
           // If docWriter has some aborted files that were
           // never incref'd, then we clean them up here
-          const std::vector<std::string>* files = docWriter->abortedFiles();
-          if (files != NULL)
-            deleter->deleteNewFiles(*files);
+          if (docWriter != NULL) {
+            const std::vector<std::string>* files = docWriter->abortedFiles();
+            if (files != NULL)
+              deleter->deleteNewFiles(*files);
+          }
         }
       }
     )
@@ -961,6 +962,37 @@ MergePolicy::OneMerge* IndexWriter::getNextMerge() {
   }
 }
 
+bool IndexWriter::isMerging(SegmentInfo* info) {
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+  return mergingSegments->find(info) != mergingSegments->end();
+}
+
+MergePolicy::OneMerge* IndexWriter::getNextSmallestMerge() {
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+  if (pendingMerges->size() == 0)
+    return NULL;
+
+  PendingMergesType::iterator smallest = pendingMerges->end();
+  int64_t smallestSize = 0;
+  for(PendingMergesType::iterator it = pendingMerges->begin();
+      it != pendingMerges->end(); it++){
+    int64_t size = 0;
+    const SegmentInfos* segments = (*it)->segments;
+    for(int32_t i=0;i<segments->size();i++)
+      size += segments->info(i)->sizeInBytes();
+    if (smallest == pendingMerges->end() || size < smallestSize) {
+      smallest = it;
+      smallestSize = size;
+    }
+  }
+
+  // Advance the merge from pending to running
+  MergePolicy::OneMerge* _merge = *smallest;
+  pendingMerges->remove(smallest, true);
+  runningMerges->insert(_merge);
+  return _merge;
+}
+
 
 void IndexWriter::startTransaction() {
 	SCOPED_LOCK_MUTEX(THIS_LOCK)
@@ -1550,24 +1582,17 @@ int32_t IndexWriter::numRamDocs() {
   return docWriter->getNumDocsInRAM();
 }
 
-int32_t IndexWriter::ensureContiguousMerge(MergePolicy::OneMerge* _merge) {
-
-  int32_t first = segmentInfos->indexOf(_merge->segments->info(0));
-  if (first == -1)
-    _CLTHROWA(CL_ERR_Merge, (string("could not find segment ") + _merge->segments->info(0)->name + " in current segments").c_str());
-
-  const int32_t numSegments = segmentInfos->size();
+int32_t IndexWriter::ensureValidMerge(MergePolicy::OneMerge* _merge) {
 
+  int32_t first = -1;
   const int32_t numSegmentsToMerge = _merge->segments->size();
   for(int32_t i=0;i<numSegmentsToMerge;i++) {
     const SegmentInfo* info = _merge->segments->info(i);
-
-    if (first + i >= numSegments || !segmentInfos->info(first+i)->equals(info) ) {
-      if (segmentInfos->indexOf(info) == -1)
-        _CLTHROWA(CL_ERR_Merge, (string("MergePolicy selected a segment (") + info->name + ") that is not in the index").c_str());
-      else
-        _CLTHROWA(CL_ERR_Merge, (string("MergePolicy selected non-contiguous segments to merge (") + _merge->getObjectName() + " vs " + segString() + "), which IndexWriter (currently) cannot handle").c_str() );
-    }
+    const int32_t pos = segmentInfos->indexOf(info);
+    if (pos == -1)
+      _CLTHROWA(CL_ERR_Merge, (string("MergePolicy selected a segment (") + info->name + ") that is not in the index").c_str());
+    if (first == -1 || pos < first)
+      first = pos;
   }
 
   return first;
@@ -1608,7 +1633,7 @@ bool IndexWriter::commitMerge(MergePolicy::OneMerge* _merge) {
     SegmentInfos* sourceSegmentsClone = _merge->segmentsClone;
     const SegmentInfos* sourceSegments = _merge->segments;
 
-    start = ensureContiguousMerge(_merge);
+    start = ensureValidMerge(_merge);
     if (infoStream != NULL)
       message("commitMerge " + _merge->segString(directory));
 
@@ -1718,9 +1743,11 @@ bool IndexWriter::commitMerge(MergePolicy::OneMerge* _merge) {
   SegmentInfos* rollback = NULL;
   try {
     rollback = segmentInfos->clone();
+    // start is the first of the merged segments, so removing
+    // them (in any order) doesn't move it
     int32_t segmentssize = _merge->segments->size();
     for ( int32_t i=0;i<segmentssize;i++ ){
-      segmentInfos->remove(start);
+      segmentInfos->remove(segmentInfos->indexOf(_merge->segments->info(i)));
     }
     segmentInfos->add(_merge->info,start);
     checkpoint();
@@ -1901,7 +1928,7 @@ void IndexWriter::_mergeInit(MergePolicy::OneMerge* _merge) {
   const SegmentInfos* sourceSegments = _merge->segments;
   const int32_t end = sourceSegments->size();
 
-  ensureContiguousMerge(_merge);
+  ensureValidMerge(_merge);
 
   // Check whether this merge will allow us to skip
   // merging the doc stores (stored field & vectors).
@@ -2058,6 +2085,9 @@ int32_t IndexWriter::mergeMiddle(MergePolicy::OneMerge* _merge) {
   if (infoStream != NULL)
     message("merging " + _merge->segString(directory));
 
+  // the temporary segments of a merge wider than maxMergeFanIn. They are
+  // deleted after the merger, which reads the last of them
+  CLVector<SegmentInfo*,Deletor::Object<SegmentInfo> > runs;
   SegmentMerger merger (this, mergedName.c_str(), _merge) ;
 
   // This is try/finally to make sure merger's readers are
@@ -2068,11 +2098,23 @@ int32_t IndexWriter::mergeMiddle(MergePolicy::OneMerge* _merge) {
   try {
     int32_t totDocCount = 0;
 
-    for (int32_t i = 0; i < numSegments; i++) {
-      SegmentInfo* si = sourceSegmentsClone->info(i);
-      IndexReader* reader = SegmentReader::get(si, MERGE_READ_BUFFER_SIZE, _merge->mergeDocStores); // no need to set deleter (yet)
-      merger.add(reader);
-      totDocCount += reader->numDocs();
+    // read once: setMaxMergeFanIn() may be called while this merge runs
+    const int32_t maxFanIn = maxMergeFanIn;
+    if (maxFanIn > 0 && numSegments > maxFanIn) {
+      std::vector<SegmentInfo*> last;
+      mergeRuns(_merge, maxFanIn, runs, last);
+      for (size_t i = 0; i < last.size(); i++) {
+        IndexReader* reader = SegmentReader::get(last[i], MERGE_READ_BUFFER_SIZE, _merge->mergeDocStores);
+        merger.add(reader);
+        totDocCount += reader->numDocs();
+      }
+    } else {
+      for (int32_t i = 0; i < numSegments; i++) {
+        SegmentInfo* si = sourceSegmentsClone->info(i);
+        IndexReader* reader = SegmentReader::get(si, MERGE_READ_BUFFER_SIZE, _merge->mergeDocStores); // no need to set deleter (yet)
+        merger.add(reader);
+        totDocCount += reader->numDocs();
+      }
     }
     if (infoStream != NULL) {
       message(string("merge: total ")+ Misc::toString(totDocCount)+" docs");
@@ -2090,6 +2132,11 @@ int32_t IndexWriter::mergeMiddle(MergePolicy::OneMerge* _merge) {
     // close readers before we attempt to delete
     // now-obsolete segments
     merger.closeReaders();
+    if (!runs.empty()) {
+      SCOPED_LOCK_MUTEX(this->THIS_LOCK)
+      for (size_t i = 0; i < runs.size(); i++)
+        deleter->refresh(runs[i]->name.c_str());
+    }
     if (!success) {
       if (infoStream != NULL)
         message("hit exception during merge; now refresh deleter on segment " + mergedName);
@@ -2186,6 +2233,76 @@ int32_t IndexWriter::mergeMiddle(MergePolicy::OneMerge* _merge) {
   return mergedDocCount;
 }
 
+void IndexWriter::mergeRuns(MergePolicy::OneMerge* _merge, int32_t maxFanIn,
+                            CLVector<SegmentInfo*,Deletor::Object<SegmentInfo> >& runs,
+                            std::vector<SegmentInfo*>& last) {
+  const SegmentInfos* sourceSegmentsClone = _merge->segmentsClone;
+  for (int32_t i = 0; i < sourceSegmentsClone->size(); i++)
+    last.push_back(sourceSegmentsClone->info(i));
+
+  // Each pass merges groups of maxFanIn consecutive segments, which
+  // keeps the documents in order. A segment left on its own is passed on
+  while ((int32_t)last.size() > maxFanIn) {
+    std::vector<SegmentInfo*> next;
+    for (size_t start = 0; start < last.size(); start += maxFanIn) {
+      const size_t end = cl_min(start + maxFanIn, last.size());
+      if (end - start == 1) {
+        next.push_back(last[start]);
+        continue;
+      }
+      SegmentInfo* run = mergeRun(_merge, last, start, end);
+      runs.push_back(run);
+      next.push_back(run);
+
+      // the temporary segments that were merged are not needed anymore
+      for (size_t i = start; i < end; i++) {
+        if (std::find(runs.begin(), runs.end(), last[i]) != runs.end()) {
+          SCOPED_LOCK_MUTEX(this->THIS_LOCK)
+          deleter->refresh(last[i]->name.c_str());
+        }
+      }
+    }
+    if (infoStream != NULL)
+      message("merge: pass of " + Misc::toString((int32_t)last.size()) + " segments left " +
+              Misc::toString((int32_t)next.size()));
+    last = next;
+  }
+}
+
+SegmentInfo* IndexWriter::mergeRun(MergePolicy::OneMerge* _merge, const std::vector<SegmentInfo*>& infos,
+                                   size_t start, size_t end) {
+  const string runName = newSegmentName();
+  SegmentInfo* run = NULL;
+
+  SegmentMerger merger(this, runName.c_str(), _merge);
+  bool success = false;
+  try {
+    for (size_t i = start; i < end; i++)
+      merger.add(SegmentReader::get(infos[i], MERGE_READ_BUFFER_SIZE, _merge->mergeDocStores));
+
+    _merge->checkAborted(directory);
+
+    const int32_t docCount = merger.merge(_merge->mergeDocStores);
+    if (_merge->mergeDocStores) {
+      run = _CLNEW SegmentInfo(runName.c_str(), docCount, directory, false, true);
+    } else {
+      // the run keeps the shared doc store of its contiguous segments
+      SegmentInfo* si = infos[start];
+      run = _CLNEW SegmentInfo(runName.c_str(), docCount, directory, false, true,
+                               si->getDocStoreOffset(), si->getDocStoreSegment().c_str(),
+                               si->getDocStoreIsCompoundFile());
+    }
+    success = true;
+  } _CLFINALLY (
+    merger.closeReaders();
+    if (!success) {
+      SCOPED_LOCK_MUTEX(this->THIS_LOCK)
+      deleter->refresh(runName.c_str());
+    }
+  )
+  return run;
+}
+
 void IndexWriter::addMergeException(MergePolicy::OneMerge* _merge) {
 	SCOPED_LOCK_MUTEX(THIS_LOCK)
   if ( mergeGen == _merge->mergeGen ){
@@ -14,6 +14,7 @@ CL_CLASS_DEF(store,Lock)
 CL_CLASS_DEF(analysis,Analyzer)
 CL_CLASS_DEF(store,Directory)
 CL_CLASS_DEF(store,LuceneLock)
+CL_CLASS_DEF(store,RateLimiter)
 CL_CLASS_DEF(document,Document)
 
 #include "MergePolicy.h"
@@ -27,6 +28,7 @@ class IndexReader;
 class SegmentReader;
 class MergeScheduler;
 class DocumentsWriter;
+class DocIDCallback;
 class IndexFileDeleter;
 class LogMergePolicy;
 class IndexDeletionPolicy;
@@ -192,6 +194,8 @@ class CLUCENE_EXPORT IndexWriter:LUCENE_BASE {
   MergingSegmentsType* mergingSegments;
   MergePolicy* mergePolicy;
   MergeScheduler* mergeScheduler;
+  CL_NS(store)::RateLimiter* mergeRateLimiter;
+  int32_t maxMergeFanIn;
 
   typedef  CL_NS(util)::CLLinkedList<MergePolicy::OneMerge*,
   CL_NS(util)::Deletor::Object<MergePolicy::OneMerge> > PendingMergesType;
@@ -686,11 +690,60 @@ public:
   void setRAMBufferSizeMB(float_t mb);
 
 
+  /**
+   * Expert: paces all files written by merges with <code>limiter</code>,
+   * to keep big merges from saturating the disk that searches read from.
+   * The limiter is not owned by the writer: it may be shared by several
+   * writers, changed with {@link RateLimiter#setMbPerSec} while merges
+   * are running and queried for the bytes written and time stalled.
+   * Pass NULL (the default) to merge at full speed.
+   */
+  void setMergeRateLimiter(CL_NS(store)::RateLimiter* limiter);
+
+  /**
+   * Expert: returns the RateLimiter applied to merges, or NULL.
+   * @see #setMergeRateLimiter
+   */
+  CL_NS(store)::RateLimiter* getMergeRateLimiter();
+
+  /**
+   * Expert: merges at most <code>maxFanIn</code> segments at once. A
+   * merge of more segments, as chosen by a merge policy with a large merge
+   * factor after a bulk load, is done in passes: groups of maxFanIn
+   * segments are merged into temporary segments, which are merged in turn
+   * until at most maxFanIn are left for the last pass. This bounds the
+   * number of files open for a merge and the memory of their buffers, at
+   * the cost of copying the documents once more per extra pass. The
+   * temporary segments are deleted as soon as they are merged.
+   * Pass 0 (the default) to merge all segments of a merge at once.
+   * @throws IllegalArgumentException if maxFanIn is 1 or negative
+   */
+  void setMaxMergeFanIn(int32_t maxFanIn);
+
+  /**
+   * Expert: returns the largest number of segments merged at once, or 0
+   * for no limit.
+   * @see #setMaxMergeFanIn
+   */
+  int32_t getMaxMergeFanIn() const;
+
   /** Expert: the {@link MergeScheduler} calls this method
    *  to retrieve the next merge requested by the
    *  MergePolicy */
   MergePolicy::OneMerge* getNextMerge();
 
+  /** Expert: returns true if <code>info</code> is part of a
+   *  pending or running merge, so a {@link MergePolicy} must
+   *  not select it again.  Only call this from the MergePolicy
+   *  methods, which run synchronized on the writer. */
+  bool isMerging(SegmentInfo* info);
+
+  /** Expert: like {@link #getNextMerge} but returns the pending
+   *  merge with the smallest total size of segments, so that
+   *  small merges are not queued behind big ones.
+   *  @see SmallestFirstMergeScheduler */
+  MergePolicy::OneMerge* getNextSmallestMerge();
+
   /**
    * Merges the indicated segments, replacing them in the stack with a
    * single segment.
@@ -1105,6 +1158,12 @@ private:
   friend class LockWith2;
   friend class LockWithCFS;
   friend class DocumentsWriter;
+  friend class BatchIndexer;
+
+  /** Adds doc, after deleting the documents containing term if it is not
+   *  NULL. callback, if not NULL, is told when doc has its docID. */
+  void updateDocument(Term* term, CL_NS(document)::Document* doc, CL_NS(analysis)::Analyzer* analyzer,
+                      DocIDCallback* callback);
 
   /** Merges all RAM-resident segments. */
   void flushRamSegments();
@@ -1236,10 +1295,14 @@ private:
 
   bool doFlush(bool flushDocStores);
 
-  /* FIXME if we want to support non-contiguous segment merges */
+  /** Replaces the merged segments by the merged segment, at the
+   *  position of the first of them.  The merged segments need not
+   *  be contiguous. */
   bool commitMerge(MergePolicy::OneMerge* merge);
 
-  int32_t ensureContiguousMerge(MergePolicy::OneMerge* merge);
+  /** Checks that all segments of the merge are in the index and
+   *  returns the position of the first of them */
+  int32_t ensureValidMerge(MergePolicy::OneMerge* merge);
 
   void decrefMergeSegments(MergePolicy::OneMerge* _merge);
 
@@ -1252,6 +1315,17 @@ private:
    *  instance */
   int32_t mergeMiddle(MergePolicy::OneMerge* _merge);
 
+  /** Merges the segments of a merge wider than maxFanIn in passes
+   *  into temporary segments, which are added to runs, until at most
+   *  maxFanIn segments are left for the last pass. Those are
+   *  returned in last. */
+  void mergeRuns(MergePolicy::OneMerge* _merge, int32_t maxFanIn,
+                 CL_NS(util)::CLVector<SegmentInfo*,CL_NS(util)::Deletor::Object<SegmentInfo> >& runs,
+                 std::vector<SegmentInfo*>& last);
+
+  /** Merges the segments start to end of infos into a new temporary segment */
+  SegmentInfo* mergeRun(MergePolicy::OneMerge* _merge, const std::vector<SegmentInfo*>& infos, size_t start, size_t end);
+
   void addMergeException(MergePolicy::OneMerge* _merge);
 
   /** Checks whether this merge involves any segments
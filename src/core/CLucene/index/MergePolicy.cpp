@@ -10,6 +10,8 @@
 #include "IndexWriter.h"
 #include "CLucene/store/Directory.h"
 #include <assert.h>
+#include <algorithm>
+#include <math.h>
 
 CL_NS_USE(util)
 CL_NS_USE(store)
@@ -511,4 +513,482 @@ const char* LogByteSizeMergePolicy::getObjectName() const{
 }
 
 
+
+
+struct TieredMergePolicy::SegmentSize{
+  SegmentInfo* info;
+  int64_t size;       // bytes pro-rated by the percent of deleted docs
+  int64_t bytes;      // bytes of the segment's files
+  double delRatio;    // share of deleted docs
+  int32_t pos;        // position in the index
+};
+
+class TieredMergePolicy::SizeDescending{
+public:
+  bool operator()(const SegmentSize& a, const SegmentSize& b) const{
+    if (a.size != b.size)
+      return a.size > b.size;
+    return a.pos < b.pos;
+  }
+};
+
+class TieredMergePolicy::DeletesDescending{
+public:
+  bool operator()(const SegmentSize& a, const SegmentSize& b) const{
+    if (a.delRatio != b.delRatio)
+      return a.delRatio > b.delRatio;
+    return a.pos < b.pos;
+  }
+};
+
+/** Orders the segments of a merge as in the index, so that merged
+ *  documents keep their relative order where possible */
+class SegmentSizePosition{
+public:
+  template<typename T> bool operator()(const T& a, const T& b) const{
+    return a.pos < b.pos;
+  }
+};
+
+template<typename T>
+static SegmentInfos* newMergeRange(typename std::vector<T>::const_iterator begin,
+                                   typename std::vector<T>::const_iterator end){
+  std::vector<T> segments(begin, end);
+  std::sort(segments.begin(), segments.end(), SegmentSizePosition());
+  SegmentInfos* range = _CLNEW SegmentInfos;
+  for (size_t i=0;i<segments.size();i++)
+    range->add(segments[i].info);
+  return range;
+}
+
+TieredMergePolicy::TieredMergePolicy():
+  maxMergeAtOnce(10),
+  maxMergedSegmentBytes((int64_t)5*1024*1024*1024),
+  maxMergeAtOnceExplicit(30),
+  floorSegmentBytes(2*1024*1024),
+  segsPerTier(10.0),
+  expungeDeletesPctAllowed(10.0),
+  maxExpungeDeletesMergeBytes(0),
+  reclaimDeletesWeight(2.0),
+  _useCompoundFile(true),
+  _useCompoundDocStore(true),
+  writer(NULL)
+{
+}
+TieredMergePolicy::~TieredMergePolicy(){
+}
+
+void TieredMergePolicy::message(const string& message) {
+  if (writer != NULL){
+    string msg = "TMP: " + message;
+    writer->message( msg );
+  }
+}
+
+void TieredMergePolicy::setMaxMergeAtOnce(int32_t v) {
+  if (v < 2)
+    _CLTHROWA(CL_ERR_IllegalArgument, "maxMergeAtOnce must be > 1");
+  maxMergeAtOnce = v;
+}
+int32_t TieredMergePolicy::getMaxMergeAtOnce() {
+  return maxMergeAtOnce;
+}
+
+void TieredMergePolicy::setMaxMergeAtOnceExplicit(int32_t v) {
+  if (v < 2)
+    _CLTHROWA(CL_ERR_IllegalArgument, "maxMergeAtOnceExplicit must be > 1");
+  maxMergeAtOnceExplicit = v;
+}
+int32_t TieredMergePolicy::getMaxMergeAtOnceExplicit() {
+  return maxMergeAtOnceExplicit;
+}
+
+void TieredMergePolicy::setMaxMergedSegmentMB(double v) {
+  if (v <= 0)
+    _CLTHROWA(CL_ERR_IllegalArgument, "maxMergedSegmentMB must be > 0");
+  maxMergedSegmentBytes = (int64_t)(v*1024*1024);
+}
+double TieredMergePolicy::getMaxMergedSegmentMB() {
+  return maxMergedSegmentBytes/1024.0/1024.0;
+}
+
+void TieredMergePolicy::setReclaimDeletesWeight(double v) {
+  if (v < 0.0)
+    _CLTHROWA(CL_ERR_IllegalArgument, "reclaimDeletesWeight must be >= 0.0");
+  reclaimDeletesWeight = v;
+}
+double TieredMergePolicy::getReclaimDeletesWeight() {
+  return reclaimDeletesWeight;
+}
+
+void TieredMergePolicy::setFloorSegmentMB(double v) {
+  if (v <= 0.0)
+    _CLTHROWA(CL_ERR_IllegalArgument, "floorSegmentMB must be > 0.0");
+  floorSegmentBytes = (int64_t)(v*1024*1024);
+}
+double TieredMergePolicy::getFloorSegmentMB() {
+  return floorSegmentBytes/1024.0/1024.0;
+}
+
+void TieredMergePolicy::setSegmentsPerTier(double v) {
+  if (v < 2.0)
+    _CLTHROWA(CL_ERR_IllegalArgument, "segmentsPerTier must be >= 2.0");
+  segsPerTier = v;
+}
+double TieredMergePolicy::getSegmentsPerTier() {
+  return segsPerTier;
+}
+
+void TieredMergePolicy::setExpungeDeletesPctAllowed(double v) {
+  if (v < 0.0 || v > 100.0)
+    _CLTHROWA(CL_ERR_IllegalArgument, "expungeDeletesPctAllowed must be between 0.0 and 100.0");
+  expungeDeletesPctAllowed = v;
+}
+double TieredMergePolicy::getExpungeDeletesPctAllowed() {
+  return expungeDeletesPctAllowed;
+}
+
+void TieredMergePolicy::setMaxExpungeDeletesMergeMB(double v) {
+  if (v < 0.0)
+    _CLTHROWA(CL_ERR_IllegalArgument, "maxExpungeDeletesMergeMB must be >= 0.0");
+  maxExpungeDeletesMergeBytes = (int64_t)(v*1024*1024);
+}
+double TieredMergePolicy::getMaxExpungeDeletesMergeMB() {
+  return maxExpungeDeletesMergeBytes/1024.0/1024.0;
+}
+
+void TieredMergePolicy::setUseCompoundFile(bool useCompoundFile) {
+  this->_useCompoundFile = useCompoundFile;
+}
+bool TieredMergePolicy::getUseCompoundFile() {
+  return _useCompoundFile;
+}
+bool TieredMergePolicy::useCompoundFile(SegmentInfos* /*infos*/, SegmentInfo* /*info*/) {
+  return _useCompoundFile;
+}
+
+void TieredMergePolicy::setUseCompoundDocStore(bool useCompoundDocStore) {
+  this->_useCompoundDocStore = useCompoundDocStore;
+}
+bool TieredMergePolicy::getUseCompoundDocStore() {
+  return _useCompoundDocStore;
+}
+bool TieredMergePolicy::useCompoundDocStore(SegmentInfos* /*infos*/) {
+  return _useCompoundDocStore;
+}
+
+void TieredMergePolicy::close() {}
+
+int64_t TieredMergePolicy::size(SegmentInfo* info) {
+  const int64_t byteSize = info->sizeInBytes();
+  const double delRatio = info->docCount <= 0 ? 0.0 : (double)info->getDelCount() / info->docCount;
+  return (int64_t)(byteSize * (1.0 - delRatio));
+}
+
+TieredMergePolicy::SegmentSize TieredMergePolicy::segmentSize(SegmentInfo* info, int32_t pos) {
+  SegmentSize s;
+  s.info = info;
+  s.bytes = info->sizeInBytes();
+  s.delRatio = info->docCount <= 0 ? 0.0 : (double)info->getDelCount() / info->docCount;
+  s.size = size(info);
+  s.pos = pos;
+  return s;
+}
+
+int64_t TieredMergePolicy::floorSize(int64_t bytes) const{
+  return bytes > floorSegmentBytes ? bytes : floorSegmentBytes;
+}
+
+bool TieredMergePolicy::isOptimized(SegmentInfo* info, IndexWriter* writer){
+  return !info->hasDeletions() &&
+    !info->hasSeparateNorms() &&
+    info->dir == writer->getDirectory() &&
+    info->getUseCompoundFile() == _useCompoundFile;
+}
+
+double TieredMergePolicy::score(const std::vector<SegmentSize>& candidate, bool hitTooLarge) const{
+  int64_t totBeforeMergeBytes = 0;
+  int64_t totAfterMergeBytes = 0;
+  int64_t totAfterMergeBytesFloored = 0;
+  for (size_t i=0;i<candidate.size();i++) {
+    totAfterMergeBytes += candidate[i].size;
+    totAfterMergeBytesFloored += floorSize(candidate[i].size);
+    totBeforeMergeBytes += candidate[i].bytes;
+  }
+
+  // Roughly measure "skew" of the merge, i.e. how
+  // "balanced" the merge is (whether it's going to
+  // produce a segment much larger than its inputs).
+  // The candidate is sorted by decreasing size.
+  double skew;
+  if (hitTooLarge) {
+    // Pretend the merge has perfect skew; skew doesn't
+    // matter in this case because this merge will not
+    // "cascade" and so it cannot lead to N^2 merge cost
+    // over time:
+    skew = 1.0/maxMergeAtOnce;
+  } else {
+    skew = (double)floorSize(candidate[0].size) / totAfterMergeBytesFloored;
+  }
+
+  // Strongly favor merges with less skew (smaller
+  // mergeScore is better):
+  double mergeScore = skew;
+
+  // Gently favor smaller merges over bigger ones.  We
+  // don't want to make this exponent too large else we
+  // can end up doing poor merges of small segments in
+  // order to avoid the large merges:
+  mergeScore *= pow((double)totAfterMergeBytes, 0.05);
+
+  // Strongly favor merges that reclaim deletes:
+  const double nonDelRatio = totBeforeMergeBytes == 0 ? 1.0 : ((double)totAfterMergeBytes)/totBeforeMergeBytes;
+  mergeScore *= pow(nonDelRatio, reclaimDeletesWeight);
+
+  return mergeScore;
+}
+
+MergePolicy::MergeSpecification* TieredMergePolicy::findMerges(SegmentInfos* infos, IndexWriter* writer){
+  this->writer = writer;
+  const int32_t numSegments = infos->size();
+  MESSAGE( string("findMerges: ") + Misc::toString(numSegments) + " segments");
+  if (numSegments == 0)
+    return NULL;
+
+  std::vector<SegmentSize> sorted;
+  sorted.reserve(numSegments);
+  for (int32_t i=0;i<numSegments;i++) {
+    sorted.push_back(segmentSize(infos->info(i), i));
+  }
+  std::sort(sorted.begin(), sorted.end(), SizeDescending());
+
+  // Compute total index bytes & print details about the index
+  int64_t totIndexBytes = 0;
+  int64_t minSegmentBytes = LUCENE_INT64_MAX_SHOULDBE;
+  for (int32_t i=0;i<numSegments;i++) {
+    totIndexBytes += sorted[i].size;
+    if (sorted[i].size < minSegmentBytes)
+      minSegmentBytes = sorted[i].size;
+  }
+
+  // If we have too-large segments, grace them out
+  // of the maxSegmentCount:
+  int32_t tooBigCount = 0;
+  while (tooBigCount < numSegments && sorted[tooBigCount].size >= maxMergedSegmentBytes/2.0) {
+    totIndexBytes -= sorted[tooBigCount].size;
+    tooBigCount++;
+  }
+
+  minSegmentBytes = floorSize(minSegmentBytes);
+
+  // Compute max allowed segs in the index
+  double levelSize = (double)minSegmentBytes;
+  double bytesLeft = (double)totIndexBytes;
+  double allowedSegCount = 0;
+  while (true) {
+    const double segCountLevel = bytesLeft / levelSize;
+    if (segCountLevel < segsPerTier) {
+      allowedSegCount += ceil(segCountLevel);
+      break;
+    }
+    allowedSegCount += segsPerTier;
+    bytesLeft -= segsPerTier * levelSize;
+    levelSize *= maxMergeAtOnce;
+  }
+  const int32_t allowedSegCountInt = (int32_t)allowedSegCount;
+
+  MergeSpecification* spec = NULL;
+  std::vector<bool> toBeMerged(numSegments, false);
+
+  // Cycle to possibly select more than one merge:
+  while (true) {
+    int64_t mergingBytes = 0;
+
+    // Gather eligible segments for merging, ie segments
+    // not already being merged and not already picked (by
+    // prior iteration of this loop) for merging:
+    std::vector<SegmentSize> eligible;
+    std::vector<int32_t> eligibleIdx;
+    for (int32_t i=0;i<numSegments;i++) {
+      if (writer->isMerging(sorted[i].info)) {
+        mergingBytes += sorted[i].size;
+      } else if (i >= tooBigCount && !toBeMerged[i]) {
+        eligible.push_back(sorted[i]);
+        eligibleIdx.push_back(i);
+      }
+    }
+
+    const bool maxMergeIsRunning = mergingBytes >= maxMergedSegmentBytes;
+
+    MESSAGE( string("  allowedSegmentCount=") + Misc::toString(allowedSegCountInt) +
+      " vs count=" + Misc::toString(numSegments) +
+      " (eligible count=" + Misc::toString((int32_t)eligible.size()) +
+      ") tooBigCount=" + Misc::toString(tooBigCount));
+
+    if (eligible.size() == 0)
+      break;
+
+    if ((int32_t)eligible.size() < allowedSegCountInt)
+      break;
+
+    // OK we are over budget -- find best merge!
+    std::vector<SegmentSize> best;
+    std::vector<int32_t> bestIdx;
+    double bestScore = 0;
+    bool bestTooLarge = false;
+
+    for (int32_t startIdx=0;startIdx <= (int32_t)eligible.size()-maxMergeAtOnce;startIdx++) {
+      int64_t totAfterMergeBytes = 0;
+      std::vector<SegmentSize> candidate;
+      std::vector<int32_t> candidateIdx;
+      bool hitTooLarge = false;
+      for (int32_t idx=startIdx;idx<(int32_t)eligible.size() && (int32_t)candidate.size() < maxMergeAtOnce;idx++) {
+        const int64_t segBytes = eligible[idx].size;
+
+        if (totAfterMergeBytes + segBytes > maxMergedSegmentBytes) {
+          hitTooLarge = true;
+          // NOTE: we continue, so that we can try
+          // "packing" smaller segments into this merge
+          // to see if we can get closer to the max
+          // size; this in general is not perfect since
+          // this is really "bin packing" and we'd have
+          // to try different permutations.
+          continue;
+        }
+        candidate.push_back(eligible[idx]);
+        candidateIdx.push_back(eligibleIdx[idx]);
+        totAfterMergeBytes += segBytes;
+      }
+      if (candidate.size() == 0)
+        continue;
+
+      const double mergeScore = score(candidate, hitTooLarge);
+      MESSAGE( string("  maybe=") + Misc::toString((int32_t)candidate.size()) + " segments score=" +
+        Misc::toString((float_t)mergeScore) + " tooLarge=" + (hitTooLarge ? "true" : "false") +
+        " size=" + Misc::toString((float_t)(totAfterMergeBytes/1024.0/1024.0)) + " MB");
+
+      // If we are already running a max sized merge
+      // (maxMergeIsRunning), don't allow another max
+      // sized merge to kick off:
+      if ((best.size() == 0 || mergeScore < bestScore) && (!hitTooLarge || !maxMergeIsRunning)) {
+        best = candidate;
+        bestIdx = candidateIdx;
+        bestScore = mergeScore;
+        bestTooLarge = hitTooLarge;
+      }
+    }
+
+    if (best.size() == 0)
+      break;
+
+    if (spec == NULL)
+      spec = _CLNEW MergeSpecification();
+    OneMerge* merge = _CLNEW OneMerge(newMergeRange<SegmentSize>(best.begin(), best.end()), _useCompoundFile);
+    spec->add(merge);
+    for (size_t i=0;i<bestIdx.size();i++)
+      toBeMerged[bestIdx[i]] = true;
+
+    MESSAGE( string("  add merge=") + merge->segString(writer->getDirectory()) +
+      " score=" + Misc::toString((float_t)bestScore) + (bestTooLarge ? " [max merge]" : ""));
+  }
+
+  if (spec == NULL && maxExpungeDeletesMergeBytes > 0)
+    spec = findExpungeDeletesMerge(sorted, writer);
+
+  return spec;
+}
+
+MergePolicy::MergeSpecification* TieredMergePolicy::findExpungeDeletesMerge(std::vector<SegmentSize>& sizes, IndexWriter* writer){
+  std::vector<SegmentSize> eligible;
+  for (size_t i=0;i<sizes.size();i++) {
+    if (sizes[i].delRatio*100 > expungeDeletesPctAllowed && !writer->isMerging(sizes[i].info))
+      eligible.push_back(sizes[i]);
+  }
+  if (eligible.size() == 0)
+    return NULL;
+
+  // Reclaim the segments with the most deletes first, as
+  // far as the budget allows
+  std::sort(eligible.begin(), eligible.end(), DeletesDescending());
+  std::vector<SegmentSize> selected;
+  int64_t bytes = 0;
+  for (size_t i=0;i<eligible.size() && (int32_t)selected.size() < maxMergeAtOnceExplicit;i++) {
+    if (bytes + eligible[i].bytes > maxExpungeDeletesMergeBytes)
+      continue;
+    selected.push_back(eligible[i]);
+    bytes += eligible[i].bytes;
+  }
+  if (selected.size() == 0)
+    return NULL;
+
+  MergeSpecification* spec = _CLNEW MergeSpecification();
+  OneMerge* merge = _CLNEW OneMerge(newMergeRange<SegmentSize>(selected.begin(), selected.end()), _useCompoundFile);
+  spec->add(merge);
+  MESSAGE( string("  add expunge deletes merge=") + merge->segString(writer->getDirectory()) );
+  return spec;
+}
+
+MergePolicy::MergeSpecification* TieredMergePolicy::findMergesForOptimize(SegmentInfos* infos, IndexWriter* writer,
+    int32_t maxSegmentCount, std::vector<SegmentInfo*>& segmentsToOptimize){
+  this->writer = writer;
+  MESSAGE( string("findMergesForOptimize maxSegmentCount=") + Misc::toString(maxSegmentCount) +
+    " segmentsToOptimize=" + Misc::toString((int32_t)segmentsToOptimize.size()) );
+
+  std::vector<SegmentSize> eligible;
+  bool optimizeMergeRunning = false;
+  const int32_t numSegments = infos->size();
+  for (int32_t i=0;i<numSegments;i++) {
+    SegmentInfo* info = infos->info(i);
+    if (std::find(segmentsToOptimize.begin(), segmentsToOptimize.end(), info) == segmentsToOptimize.end())
+      continue;
+    if (writer->isMerging(info)) {
+      optimizeMergeRunning = true;
+      continue;
+    }
+    eligible.push_back(segmentSize(info, i));
+  }
+
+  if (eligible.size() == 0)
+    return NULL;
+
+  if ((maxSegmentCount > 1 && (int32_t)eligible.size() <= maxSegmentCount) ||
+      (maxSegmentCount == 1 && eligible.size() == 1 && isOptimized(eligible[0].info, writer))) {
+    MESSAGE( "already optimized" );
+    return NULL;
+  }
+
+  std::sort(eligible.begin(), eligible.end(), SizeDescending());
+
+  int32_t end = (int32_t)eligible.size();
+  MergeSpecification* spec = NULL;
+
+  // Do full merges, first, backwards:
+  while (end >= maxMergeAtOnceExplicit + maxSegmentCount - 1) {
+    if (spec == NULL)
+      spec = _CLNEW MergeSpecification();
+    OneMerge* merge = _CLNEW OneMerge(newMergeRange<SegmentSize>(eligible.begin()+(end-maxMergeAtOnceExplicit), eligible.begin()+end), _useCompoundFile);
+    MESSAGE( string("add merge=") + merge->segString(writer->getDirectory()) );
+    spec->add(merge);
+    end -= maxMergeAtOnceExplicit;
+  }
+
+  if (spec == NULL && !optimizeMergeRunning) {
+    // Do final merge
+    const int32_t numToMerge = end - maxSegmentCount + 1;
+    OneMerge* merge = _CLNEW OneMerge(newMergeRange<SegmentSize>(eligible.begin()+(end-numToMerge), eligible.begin()+end), _useCompoundFile);
+    MESSAGE( string("add final merge=") + merge->segString(writer->getDirectory()) );
+    spec = _CLNEW MergeSpecification();
+    spec->add(merge);
+  }
+
+  return spec;
+}
+
+const char* TieredMergePolicy::getClassName(){
+  return "TieredMergePolicy";
+}
+const char* TieredMergePolicy::getObjectName() const{
+  return getClassName();
+}
+
 CL_NS_END
@@ -432,6 +432,171 @@ public:
 };
 
 
+/**
+ *  Merges segments of approximately equal size, subject to
+ *  an allowed number of segments per tier.  This is similar
+ *  to {@link LogByteSizeMergePolicy}, except this merge
+ *  policy is able to merge non-adjacent segments, and
+ *  separates how many segments are merged at once ({@link
+ *  #setMaxMergeAtOnce}) from how many segments are allowed
+ *  per tier ({@link #setSegmentsPerTier}).  It also does
+ *  not over-merge (ie, cascade merges).
+ *
+ *  <p>For normal merging, this policy first computes a
+ *  "budget" of how many segments are allowed to be in the
+ *  index.  If the index is over-budget, then the policy
+ *  sorts segments by decreasing size (pro-rating by percent
+ *  deletes), and then finds the least-cost merge.  Merge
+ *  cost is measured by a combination of the "skew" of the
+ *  merge (size of largest segment divided by smallest segment),
+ *  total merge size and percent deletes reclaimed,
+ *  so that merges with lower skew, smaller size
+ *  and those reclaiming more deletes, are
+ *  favored.</p>
+ *
+ *  <p>If a merge will produce a segment that's larger than
+ *  {@link #setMaxMergedSegmentMB}, then the policy will
+ *  merge fewer segments (down to 1 at once, if that one has
+ *  deletions) to keep the segment size under budget.</p>
+ *
+ *  <p>Segments whose share of deleted documents is above
+ *  {@link #setExpungeDeletesPctAllowed} are also rewritten in
+ *  the background, when there is no normal merge to do, up to
+ *  {@link #setMaxExpungeDeletesMergeMB} per merge.  This
+ *  reclaims deleted documents of update heavy indexes without
+ *  having to optimize them.</p>
+ *
+ *  <p><b>NOTE</b>: since this policy merges non-adjacent
+ *  segments, the documents of a merged segment don't keep
+ *  their relative order in the index (document numbers of
+ *  later segments may become smaller).</p>
+ */
+class CLUCENE_EXPORT TieredMergePolicy: public MergePolicy {
+  int32_t maxMergeAtOnce;
+  int64_t maxMergedSegmentBytes;
+  int32_t maxMergeAtOnceExplicit;
+  int64_t floorSegmentBytes;
+  double segsPerTier;
+  double expungeDeletesPctAllowed;
+  int64_t maxExpungeDeletesMergeBytes;
+  double reclaimDeletesWeight;
+  bool _useCompoundFile;
+  bool _useCompoundDocStore;
+  IndexWriter* writer;
+
+  struct SegmentSize;
+  class SizeDescending;
+  class DeletesDescending;
+
+  void message(const std::string& message);
+  bool isOptimized(SegmentInfo* info, IndexWriter* writer);
+  int64_t floorSize(int64_t bytes) const;
+  SegmentSize segmentSize(SegmentInfo* info, int32_t pos);
+  double score(const std::vector<SegmentSize>& candidate, bool hitTooLarge) const;
+  MergeSpecification* findExpungeDeletesMerge(std::vector<SegmentSize>& sizes, IndexWriter* writer);
+
+protected:
+  /** The size of a segment, pro-rated by its percent of deleted documents */
+  int64_t size(SegmentInfo* info);
+
+public:
+  TieredMergePolicy();
+  virtual ~TieredMergePolicy();
+
+  /** Maximum number of segments to be merged at a time
+   *  during "normal" merging.  For explicit merging (eg,
+   *  optimize() was called), see {@link
+   *  #setMaxMergeAtOnceExplicit}.  Default is 10. */
+  void setMaxMergeAtOnce(int32_t v);
+  /** @see #setMaxMergeAtOnce */
+  int32_t getMaxMergeAtOnce();
+
+  /** Maximum number of segments to be merged at a time,
+   *  during optimize.  Default is 30. */
+  void setMaxMergeAtOnceExplicit(int32_t v);
+  /** @see #setMaxMergeAtOnceExplicit */
+  int32_t getMaxMergeAtOnceExplicit();
+
+  /** Maximum sized segment to produce during
+   *  normal merging.  This setting is approximate: the
+   *  estimate of the merged segment size is made by summing
+   *  sizes of to-be-merged segments (compensating for
+   *  percent deleted docs).  Default is 5 GB. */
+  void setMaxMergedSegmentMB(double v);
+  /** @see #setMaxMergedSegmentMB */
+  double getMaxMergedSegmentMB();
+
+  /** Controls how aggressively merges that reclaim more
+   *  deletions are favored.  Higher values favor selecting
+   *  merges that reclaim deletions.  A value of 0.0 means
+   *  deletions don't impact merge selection.  Default is 2.0. */
+  void setReclaimDeletesWeight(double v);
+  /** @see #setReclaimDeletesWeight */
+  double getReclaimDeletesWeight();
+
+  /** Segments smaller than this are "rounded up" to this
+   *  size, ie treated as equal (floor) size for merge
+   *  selection.  This is to prevent frequent flushing of
+   *  tiny segments from allowing a long tail in the index.
+   *  Default is 2 MB. */
+  void setFloorSegmentMB(double v);
+  /** @see #setFloorSegmentMB */
+  double getFloorSegmentMB();
+
+  /** Sets the allowed number of segments per tier.  Smaller
+   *  values mean more merging but fewer segments.
+   *  This should be &gt;= {@link #setMaxMergeAtOnce},
+   *  otherwise you'll force too much merging to occur.
+   *  Default is 10.0. */
+  void setSegmentsPerTier(double v);
+  /** @see #setSegmentsPerTier */
+  double getSegmentsPerTier();
+
+  /** Segments with a higher percentage of deleted documents
+   *  than this are rewritten in the background (see {@link
+   *  #setMaxExpungeDeletesMergeMB}).  Default is 10.0. */
+  void setExpungeDeletesPctAllowed(double v);
+  /** @see #setExpungeDeletesPctAllowed */
+  double getExpungeDeletesPctAllowed();
+
+  /** Budget of the background merges that reclaim deletes:
+   *  when there is no normal merge to do, the segments with
+   *  the highest percentage of deletes (above {@link
+   *  #setExpungeDeletesPctAllowed}) are merged together, as
+   *  long as their total size stays within this budget.
+   *  0 disables these merges.  Default is 0. */
+  void setMaxExpungeDeletesMergeMB(double v);
+  /** @see #setMaxExpungeDeletesMergeMB */
+  double getMaxExpungeDeletesMergeMB();
+
+  /** Sets whether compound file format should be used for
+   *  newly flushed and newly merged segments.  Default is true. */
+  void setUseCompoundFile(bool useCompoundFile);
+  /** @see #setUseCompoundFile */
+  bool getUseCompoundFile();
+
+  /** Sets whether compound file format should be used for
+   *  newly flushed and newly merged doc store segment files
+   *  (term vectors and stored fields).  Default is true. */
+  void setUseCompoundDocStore(bool useCompoundDocStore);
+  /** @see #setUseCompoundDocStore */
+  bool getUseCompoundDocStore();
+
+  MergeSpecification* findMerges(SegmentInfos* infos, IndexWriter* writer);
+
+  MergeSpecification* findMergesForOptimize(SegmentInfos* infos,
+                                            IndexWriter* writer,
+                                            int32_t maxSegmentCount,
+                                            std::vector<SegmentInfo*>& segmentsToOptimize);
+
+  bool useCompoundFile(SegmentInfos* infos, SegmentInfo* newSegment);
+  bool useCompoundDocStore(SegmentInfos* infos);
+  void close();
+
+  static const char* getClassName();
+  virtual const char* getObjectName() const;
+};
+
 
 CL_NS_END
 #endif
@@ -31,4 +31,26 @@ void SerialMergeScheduler::merge(IndexWriter* writer){
 
 void SerialMergeScheduler::close() {}
 
+
+const char* SmallestFirstMergeScheduler::getObjectName() const{
+	return getClassName();
+}
+const char* SmallestFirstMergeScheduler::getClassName(){
+	return "SmallestFirstMergeScheduler";
+}
+
+void SmallestFirstMergeScheduler::merge(IndexWriter* writer){
+  SCOPED_LOCK_MUTEX(THIS_LOCK)
+  while(true) {
+    // pick again after each merge: finishing one may have
+    // registered new, smaller ones
+    MergePolicy::OneMerge* merge = writer->getNextSmallestMerge();
+    if (merge == NULL)
+      break;
+    writer->merge(merge);
+  }
+}
+
+void SmallestFirstMergeScheduler::close() {}
+
 CL_NS_END
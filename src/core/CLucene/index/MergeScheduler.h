@@ -45,6 +45,22 @@ public:
   static const char* getClassName();
 };
 
+/** A {@link MergeScheduler} that does each merge sequentially,
+ *  using the current thread, but always runs the smallest pending
+ *  merge first.  Merges that become possible while a big merge
+ *  is pending (for example because small segments were flushed
+ *  in the meantime) are not queued behind it, which keeps the
+ *  number of small segments that searches have to visit low. */
+class CLUCENE_EXPORT SmallestFirstMergeScheduler: public MergeScheduler {
+public:
+  DEFINE_MUTEX(THIS_LOCK)
+
+  void merge(IndexWriter* writer);
+  void close();
+
+  const char* getObjectName() const;
+  static const char* getClassName();
+};
 
 CL_NS_END
 #endif
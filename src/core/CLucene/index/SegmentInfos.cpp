@@ -31,6 +31,7 @@ SegmentInfo::SegmentInfo(const char* _name, const int32_t _docCount, CL_NS(store
 			isCompoundFile(_isCompoundFile ? SegmentInfo::YES : SegmentInfo::NO),
 			hasSingleNormFile(_hasSingleNormFile),
 			_sizeInBytes(-1),
+			_delCount(-1),
 			docStoreOffset(_docStoreOffset),
       docStoreSegment( _docStoreSegment == NULL ? "" : _docStoreSegment ),
 			docStoreIsCompoundFile(_docStoreIsCompoundFile)
@@ -66,7 +67,8 @@ string SegmentInfo::segString(Directory* dir) {
     Misc::toString(docCount) + docStore;
 }
    SegmentInfo::SegmentInfo(CL_NS(store)::Directory* _dir, int32_t format, CL_NS(store)::IndexInput* input):
-     _sizeInBytes(-1)
+     _sizeInBytes(-1),
+     _delCount(-1)
    {
 	   this->dir = _dir;
 
@@ -322,6 +324,27 @@ string SegmentInfo::segString(Directory* dir) {
 	   }
    }
 
+   int32_t SegmentInfo::getDelCount() {
+	   if (_delCount == -1) {
+		   _delCount = 0;
+		   if (hasDeletions()) {
+			   // The deletions file starts with the number of bits (or a
+			   // format marker followed by it) and the number of set bits,
+			   // so there is no need to load the bits themselves.
+			   IndexInput* input = dir->openInput(getDelFileName().c_str());
+			   try {
+				   if (input->readInt() < 0)
+					   input->readInt();
+				   _delCount = input->readInt();
+			   } _CLFINALLY (
+				   input->close();
+				   _CLDELETE(input);
+			   )
+		   }
+	   }
+	   return _delCount;
+   }
+
    void SegmentInfo::advanceDelGen() {
 	   // delGen 0 is reserved for pre-LOCKLESS format
 	   if (delGen == NO) {
@@ -522,6 +545,7 @@ string SegmentInfo::segString(Directory* dir) {
    void SegmentInfo::clearFiles() {
 	   _files.clear();
 	   _sizeInBytes = -1;
+	   _delCount = -1;
    }
 
    /** We consider another SegmentInfo instance equal if it
@@ -18,6 +18,7 @@
 #include "_CompoundFile.h"
 #include "_SkipListWriter.h"
 #include "CLucene/document/FieldSelector.h"
+#include "CLucene/store/_RateLimitedIndexOutput.h"
 
 CL_NS_USE(util)
 CL_NS_USE(document)
@@ -36,6 +37,7 @@ void SegmentMerger::init(){
   queue            = NULL;
   fieldInfos       = NULL;
   checkAbort       = NULL;
+  rateLimitedDirectory = NULL;
   skipInterval     = 0;
 }
 
@@ -49,6 +51,11 @@ SegmentMerger::SegmentMerger(IndexWriter* writer, const char* name, MergePolicy:
 
   this->init();
   this->directory		   = writer->getDirectory();
+  if ( writer->getMergeRateLimiter() != NULL ){
+    // pace everything written for the merged segment
+    this->rateLimitedDirectory = _CLNEW RateLimitedDirectory(directory, writer->getMergeRateLimiter());
+    this->directory = rateLimitedDirectory;
+  }
   this->segment        = name;
   if (merge != NULL)
     this->checkAbort = _CLNEW CheckAbort(merge, directory);
@@ -90,6 +97,7 @@ SegmentMerger::~SegmentMerger(){
 
   _CLDELETE(checkAbort);
   _CLDELETE(skipListWriter);
+  _CLDECDELETE(rateLimitedDirectory);
 
 }
 
@@ -215,6 +223,27 @@ public:
 };
 
 
+void SegmentMerger::setMatchingSegmentReaders(ValueArray<SegmentReader*>& matchingSegmentReaders){
+  // If this reader is a SegmentReader, and all of its
+  // field name -> number mappings match the "merged"
+  // FieldInfos, then we can do a bulk copy of the
+  // stored fields and term vectors:
+  for (size_t i = 0; i < readers.size(); i++) {
+    IndexReader* reader = readers[i];
+    matchingSegmentReaders.values[i] = NULL;
+    if (reader->instanceOf(SegmentReader::getClassName())) {
+      SegmentReader* segmentReader = (SegmentReader*) reader;
+      bool same = true;
+      FieldInfos* segmentFieldInfos = segmentReader->getFieldInfos();
+      for (size_t j = 0; same && j < segmentFieldInfos->size(); j++)
+        same = _tcscmp(fieldInfos->fieldName(j), segmentFieldInfos->fieldName(j)) == 0;
+      if (same) {
+        matchingSegmentReaders.values[i] = segmentReader;
+      }
+    }
+  }
+}
+
 int32_t SegmentMerger::mergeFields() {
 //Func - Merge the fields of all segments
 //Pre  - true
@@ -293,28 +322,8 @@ int32_t SegmentMerger::mergeFields() {
 
   if (mergeDocStores) {
 
-    // If the i'th reader is a SegmentReader and has
-    // identical fieldName -> number mapping, then this
-    // array will be non-NULL at position i:
     ValueArray<SegmentReader*> matchingSegmentReaders(readers.size());
-
-    // If this reader is a SegmentReader, and all of its
-    // field name -> number mappings match the "merged"
-    // FieldInfos, then we can do a bulk copy of the
-    // stored fields:
-    for (size_t i = 0; i < readers.size(); i++) {
-      IndexReader* reader = readers[i];
-      if (reader->instanceOf(SegmentReader::getClassName())) {
-        SegmentReader* segmentReader = (SegmentReader*) reader;
-        bool same = true;
-        FieldInfos* segmentFieldInfos = segmentReader->getFieldInfos();
-        for (size_t j = 0; same && j < segmentFieldInfos->size(); j++)
-          same = _tcscmp(fieldInfos->fieldName(j), segmentFieldInfos->fieldName(j)) == 0;
-        if (same) {
-          matchingSegmentReaders.values[i] = segmentReader;
-        }
-      }
-    }
+    setMatchingSegmentReaders(matchingSegmentReaders);
 
     // Used for bulk-reading raw bytes for stored fields
     ValueArray<int32_t> rawDocLengths(MAX_RAW_MERGE_DOCS);
@@ -387,14 +396,43 @@ void SegmentMerger::mergeVectors(){
 	TermVectorsWriter* termVectorsWriter =
 		_CLNEW TermVectorsWriter(directory, segment.c_str(), fieldInfos);
 
+	ValueArray<SegmentReader*> matchingSegmentReaders(readers.size());
+	setMatchingSegmentReaders(matchingSegmentReaders);
+
 	try {
 		for (uint32_t r = 0; r < readers.size(); r++) {
 			IndexReader* reader = readers[r];
+			SegmentReader* matchingSegmentReader = matchingSegmentReaders[r];
+			TermVectorsReader* matchingVectorsReader = NULL;
+			if (matchingSegmentReader != NULL && matchingSegmentReader->termVectorsReaderOrig != NULL)
+				matchingVectorsReader = matchingSegmentReader->getTermVectorsReader();
+
 			int32_t maxDoc = reader->maxDoc();
-			for (int32_t docNum = 0; docNum < maxDoc; docNum++) {
+			for (int32_t docNum = 0; docNum < maxDoc; ) {
 				// skip deleted docs
-				if (reader->isDeleted(docNum))
+				if (reader->isDeleted(docNum)) {
+					docNum++;
 					continue;
+				}
+
+				if (matchingVectorsReader != NULL) {
+					// We can bulk-copy the vectors, since the field numbers are identical
+					int32_t start = docNum;
+					int32_t numDocs = 0;
+					do {
+						docNum++;
+						numDocs++;
+					} while (docNum < maxDoc && !reader->isDeleted(docNum) && numDocs < MAX_RAW_MERGE_DOCS);
+
+					if (termVectorsWriter->addRawDocuments(matchingVectorsReader, start, numDocs)) {
+						if (checkAbort != NULL)
+							checkAbort->work(300*numDocs);
+						continue;
+					}
+					// written in an older format, copy them one by one
+					matchingVectorsReader = NULL;
+					docNum = start;
+				}
 
 				ArrayBase<TermFreqVector*>* tmp = reader->getTermFreqVectors(docNum);
 //        if ( tmp != NULL ){
@@ -403,6 +441,7 @@ void SegmentMerger::mergeVectors(){
 //        }
           if (checkAbort != NULL)
             checkAbort->work(300);
+				docNum++;
 			}
 		}
 	}_CLFINALLY(
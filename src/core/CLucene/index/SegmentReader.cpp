@@ -26,6 +26,17 @@ CL_NS_USE(document)
 CL_NS_USE(search)
 CL_NS_DEF(index)
 
+// The norms and the deleted docs of a reader are read without locking once
+// they exist. publish() makes the writes that filled an object visible to
+// other threads before the pointer to it: the atomic operations of the
+// threading layer are full barriers.
+static _LUCENE_ATOMIC_INT publications;
+template<typename T>
+static inline void publish(T*& ptr, T* value){
+  _LUCENE_ATOMIC_INC(&publications);
+  ptr = value;
+}
+
  SegmentReader::Norm::Norm(IndexInput* instrm, bool _useSingleNormStream, int32_t n, int64_t ns, SegmentReader* r, const char* seg):
 	number(n),
 	normSeek(ns),
@@ -107,6 +118,7 @@ CL_NS_DEF(index)
     //Post - All files of the segment have been read
 
     this->deletedDocs      = NULL;
+    this->spareDeletedDocs = NULL;
     this->ones			   = NULL;
     //There are no documents yet marked as deleted
     this->deletedDocsDirty = false;
@@ -125,6 +137,7 @@ CL_NS_DEF(index)
     // so that if an index update removes them we'll still have them
     this->freqStream       = NULL;
     this->proxStream       = NULL;
+    this->termDocsPool     = _CLNEW SegmentTermDocsPool();
     this->singleNormStream = NULL;
     this->termVectorsReaderOrig = NULL;
     this->_fieldInfos = NULL;
@@ -309,6 +322,7 @@ CL_NS_DEF(index)
   //Post - All streams to files have been closed
 
       _CLDELETE(deletedDocs);
+      _CLDELETE(spareDeletedDocs);
 
       // close the single norms stream
       if (singleNormStream != NULL) {
@@ -330,6 +344,12 @@ CL_NS_DEF(index)
         _CLDELETE(tis);
       }
 
+      // the pooled clones go before the streams they were cloned from
+      if (termDocsPool != NULL){
+        termDocsPool->close();
+        _CLDECDELETE(termDocsPool);
+      }
+
       //Close the frequency stream
       if (freqStream != NULL){
         freqStream->close();
@@ -403,7 +423,13 @@ CL_NS_DEF(index)
 
 	  //Check if deletedDocs exists
 	  if (deletedDocs == NULL){
-          deletedDocs = _CLNEW BitSet(maxDoc());
+          // the set dropped by the last undeleteAll is reused, so that
+          // delete and undeleteAll cycles do not keep more than one set
+          if (spareDeletedDocs != NULL){
+            publish(deletedDocs, spareDeletedDocs);
+            spareDeletedDocs = NULL;
+          }else
+            publish(deletedDocs, _CLNEW BitSet(maxDoc()));
 
           //Condition check to see if deletedDocs points to a valid instance
           CND_CONDITION(deletedDocs != NULL,"No memory could be allocated for deletedDocs");
@@ -417,7 +443,15 @@ CL_NS_DEF(index)
   }
 
   void SegmentReader::doUndeleteAll(){
-      _CLDELETE(deletedDocs);
+      // isDeleted() may still be reading it, so it is cleared and kept
+      // for the next deletion instead of being freed
+      if (deletedDocs != NULL){
+        BitSet* docs = deletedDocs;
+        deletedDocs = NULL;
+        for (int32_t i = docs->nextSetBit(0); i >= 0; i = docs->nextSetBit(i+1))
+          docs->set(i, false);
+        spareDeletedDocs = docs;
+      }
       deletedDocsDirty = false;
       undeleteAll = true;
   }
@@ -460,8 +494,6 @@ CL_NS_DEF(index)
   //Post - if the document has been deleted then an exception has been thrown
   //       otherwise a reference to the found document has been returned
 
-      SCOPED_LOCK_MUTEX(THIS_LOCK)
-
       ensureOpen();
 
       CND_PRECONDITION(n >= 0, "n is a negative number");
@@ -471,8 +503,10 @@ CL_NS_DEF(index)
           _CLTHROWA( CL_ERR_InvalidState,"attempt to access a deleted document" );
        }
 
-	   //Retrieve the n-th document
-       return fieldsReader->doc(n, doc, fieldSelector);
+	   //Retrieve the n-th document with the FieldsReader of this thread, so
+	   //that threads don't share the stream position of one reader. Finding
+	   //the clone of this thread locks the ThreadLocal, but only for the lookup
+       return getLocalFieldsReader()->doc(n, doc, fieldSelector);
   }
 
 
@@ -481,12 +515,12 @@ CL_NS_DEF(index)
   //Pre  - n >=0 and identifies the document n
   //Post - true has been returned if document n has been deleted otherwise fralse
 
-      SCOPED_LOCK_MUTEX(THIS_LOCK)
-
       CND_PRECONDITION(n >= 0, "n is a negative number");
 
-	  //Is document n deleted
-      bool ret = (deletedDocs != NULL && deletedDocs->get(n));
+	  //Is document n deleted. Not locked: deletedDocs is published
+	  //after it was created and is not freed before close
+      BitSet* docs = deletedDocs;
+      bool ret = (docs != NULL && docs->get(n));
 
       return ret;
   }
@@ -509,6 +543,10 @@ CL_NS_DEF(index)
       return _CLNEW SegmentTermPositions(this);
   }
 
+  SegmentTermDocsPool* SegmentReader::getTermDocsPool(){
+      return termDocsPool;
+  }
+
   int32_t SegmentReader::docFreq(const Term* t) {
   //Func - Returns the number of documents which contain the term t
   //Pre  - t holds a valid reference to a Term
@@ -668,7 +706,7 @@ bool SegmentReader::hasNorms(const TCHAR* field){
 
   uint8_t* SegmentReader::fakeNorms() {
     if (ones==NULL)
-		ones=createFakeNorms(maxDoc());
+		publish(ones, createFakeNorms(maxDoc()));
     return ones;
   }
   // can return NULL if norms aren't stored
@@ -681,7 +719,7 @@ bool SegmentReader::hasNorms(const TCHAR* field){
       if (norm->bytes == NULL) {                     // value not yet read
         uint8_t* bytes = _CL_NEWARRAY(uint8_t, maxDoc());
         norms(field, bytes);
-        norm->bytes = bytes;                         // cache it
+        publish(norm->bytes, bytes);                 // cache it
         // it's OK to close the underlying IndexInput as we have cached the
         // norms and will never read them again.
         norm->close();
@@ -731,8 +769,20 @@ bool SegmentReader::hasNorms(const TCHAR* field){
   //       and returned containing the norms for that field. If the named field is unknown NULL is returned.
 
     CND_PRECONDITION(field != NULL, "field is NULL");
-    SCOPED_LOCK_MUTEX(THIS_LOCK)
     ensureOpen();
+
+    // _norms is not changed once the reader is open, and the cached bytes
+    // are published: the norms read before are returned without locking
+    Norm* norm = _norms.get(field);
+    if (norm != NULL){
+      uint8_t* bytes = norm->bytes;
+      if (bytes != NULL)
+        return bytes;
+    }else if (ones != NULL){
+      return ones;
+    }
+
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
     uint8_t* bytes = getNorms(field);
     if (bytes==NULL)
 		bytes=fakeNorms();
@@ -827,6 +877,15 @@ bool SegmentReader::hasNorms(const TCHAR* field){
     return fieldsReader;
   }
 
+  FieldsReader* SegmentReader::getLocalFieldsReader() {
+    FieldsReader* local = fieldsReaderLocal.get();
+    if (local == NULL) {
+      local = fieldsReader->clone();
+      fieldsReaderLocal.set(local);
+    }
+    return local;
+  }
+
   FieldInfos* SegmentReader::getFieldInfos() {
     return _fieldInfos;
   }
@@ -13,16 +13,114 @@
 
 CL_NS_DEF(index)
 
-  SegmentTermDocs::SegmentTermDocs(const SegmentReader* _parent) : parent(_parent),freqStream(_parent->freqStream->clone()),
+  SegmentTermDocsPool::SegmentTermDocsPool():
+    closed(false)
+  {
+  }
+  SegmentTermDocsPool::~SegmentTermDocsPool(){
+    close();
+  }
+
+  CL_NS(store)::IndexInput* SegmentTermDocsPool::getFreqStream(CL_NS(store)::IndexInput* base){
+    {
+      SCOPED_LOCK_MUTEX(THIS_LOCK)
+      if ( !freqStreams.empty() ){
+        CL_NS(store)::IndexInput* ret = freqStreams.back();
+        freqStreams.pop_back();
+        return ret;
+      }
+    }
+    return base->clone();
+  }
+  CL_NS(store)::IndexInput* SegmentTermDocsPool::getProxStream(CL_NS(store)::IndexInput* base){
+    {
+      SCOPED_LOCK_MUTEX(THIS_LOCK)
+      if ( !proxStreams.empty() ){
+        CL_NS(store)::IndexInput* ret = proxStreams.back();
+        proxStreams.pop_back();
+        return ret;
+      }
+    }
+    return base->clone();
+  }
+  DefaultSkipListReader* SegmentTermDocsPool::getSkipListReader(){
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+    if ( skipListReaders.empty() )
+      return NULL;
+    DefaultSkipListReader* ret = skipListReaders.back();
+    skipListReaders.pop_back();
+    return ret;
+  }
+
+  void SegmentTermDocsPool::releaseFreqStream(CL_NS(store)::IndexInput*& stream){
+    {
+      SCOPED_LOCK_MUTEX(THIS_LOCK)
+      if ( !closed && freqStreams.size() < MAX_POOLED ){
+        freqStreams.push_back(stream);
+        stream = NULL;
+        return;
+      }
+    }
+    _CLDELETE(stream);
+  }
+  void SegmentTermDocsPool::releaseProxStream(CL_NS(store)::IndexInput*& stream){
+    {
+      SCOPED_LOCK_MUTEX(THIS_LOCK)
+      if ( !closed && proxStreams.size() < MAX_POOLED ){
+        proxStreams.push_back(stream);
+        stream = NULL;
+        return;
+      }
+    }
+    stream->close();
+    _CLDELETE(stream);
+  }
+  void SegmentTermDocsPool::releaseSkipListReader(DefaultSkipListReader*& reader){
+    {
+      SCOPED_LOCK_MUTEX(THIS_LOCK)
+      if ( !closed && skipListReaders.size() < MAX_POOLED ){
+        skipListReaders.push_back(reader);
+        reader = NULL;
+        return;
+      }
+    }
+    _CLDELETE(reader);
+  }
+
+  size_t SegmentTermDocsPool::size(){
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+    return freqStreams.size() + proxStreams.size() + skipListReaders.size();
+  }
+
+  void SegmentTermDocsPool::close(){
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+    closed = true;
+    for ( StreamsType::iterator itr = freqStreams.begin(); itr != freqStreams.end(); ++itr )
+      _CLDELETE(*itr);
+    for ( StreamsType::iterator itr = proxStreams.begin(); itr != proxStreams.end(); ++itr ){
+      (*itr)->close();
+      _CLDELETE(*itr);
+    }
+    for ( SkipListReadersType::iterator itr = skipListReaders.begin(); itr != skipListReaders.end(); ++itr )
+      _CLDELETE(*itr);
+    freqStreams.clear();
+    proxStreams.clear();
+    skipListReaders.clear();
+  }
+
+
+  SegmentTermDocs::SegmentTermDocs(const SegmentReader* _parent) : parent(_parent),pool(_CL_POINTER(_parent->termDocsPool)),freqStream(NULL),
 		count(0),df(0),deletedDocs(_parent->deletedDocs),_doc(0),_freq(0),skipInterval(_parent->tis->getSkipInterval()),
 		maxSkipLevels(_parent->tis->getMaxSkipLevels()),skipListReader(NULL),freqBasePointer(0),proxBasePointer(0),
 		skipPointer(0),haveSkipped(false)
 	{
       CND_CONDITION(_parent != NULL,"Parent is NULL");
+      freqStream = pool->getFreqStream(_parent->freqStream);
    }
 
   SegmentTermDocs::~SegmentTermDocs() {
       close();
+      _CLDECDELETE(pool);
   }
 
   TermPositions* SegmentTermDocs::__asTermPositions(){
@@ -71,8 +169,10 @@ CL_NS_DEF(index)
   }
 
   void SegmentTermDocs::close() {
-	  _CLDELETE( freqStream );
-	  _CLDELETE( skipListReader );
+	  if ( freqStream != NULL )
+		  pool->releaseFreqStream(freqStream);
+	  if ( skipListReader != NULL )
+		  pool->releaseSkipListReader(skipListReader);
   }
 
   int32_t SegmentTermDocs::doc()const { 
@@ -129,8 +229,11 @@ CL_NS_DEF(index)
     assert(count <= df );
     
     if (df >= skipInterval) {                      // optimized case
-      if (skipListReader == NULL)
-		  skipListReader = _CLNEW DefaultSkipListReader(freqStream->clone(), maxSkipLevels, skipInterval); // lazily clone
+      if (skipListReader == NULL){
+		  skipListReader = pool->getSkipListReader();
+		  if (skipListReader == NULL)
+			  skipListReader = _CLNEW DefaultSkipListReader(freqStream->clone(), maxSkipLevels, skipInterval); // lazily clone
+      }
 
 	  if (!haveSkipped) {                          // lazily initialize skip stream
 		  skipListReader->init(skipPointer, freqBasePointer, proxBasePointer, df, currentFieldStoresPayloads);
@@ -13,6 +13,7 @@
 #include "Term.h"
 #include "_TermInfo.h"
 #include "_TermInfosWriter.h"
+#include "CLucene/store/_ModifiedUTF8.h"
 
 CL_NS_USE(store)
 CL_NS_DEF(index)
@@ -242,11 +243,12 @@ CL_NS_DEF(index)
 		return termInfo->docFreq;
 	}
 
-	void SegmentTermEnum::seek(const int64_t pointer, const int64_t p, Term* t, TermInfo* ti) {
+	void SegmentTermEnum::seek(const int64_t pointer, const int64_t p, const TCHAR* field, const uint8_t* text,
+		const int32_t textLength, TermInfo* ti) {
 	//Func - Repositions term and termInfo within the enumeration
 	//Pre  - pointer >= 0
 	//       p >= 0 and contains the new position within the enumeration
-	//       t is a valid reference to a Term and is the new current term in the enumeration
+	//       field and text are the new current term in the enumeration
 	//       ti is a valid reference to a TermInfo and is corresponding TermInfo form the new
 	//       current Term
 	//Post - term and terminfo have been repositioned within the enumeration
@@ -262,19 +264,20 @@ CL_NS_DEF(index)
 			//Get a pointer from t and increase the reference counter of t
 			_term = _CLNEW Term; //cannot use reference, because TermInfosReader uses non ref-counted array
 		}
-		_term->set(t,t->text());
+
+		//decode the text straight into the buffer, the text has at most one
+		//character per byte
+		growBuffer(textLength, false);
+		TCHAR* out = buffer;
+		ModifiedUTF8::decode(text, text + textLength, out, buffer + textLength);
+		*out = 0;
+		_term->set(field, buffer, false);
 
 		//finalize prev
 		_CLDECDELETE(prev);
 
 		//Change the current termInfo so it matches the new current term
 		termInfo->set(ti);
-
-		//Have the buffer grown if needed
-		if ( bufferLength <= _term->textLength() )
-			growBuffer(_term->textLength(), true );		  // copy term text into buffer
-		else
-			_tcsncpy(buffer,_term->text(),bufferLength); //just copy the buffer
 	}
 
 	TermInfo* SegmentTermEnum::getTermInfo()const {
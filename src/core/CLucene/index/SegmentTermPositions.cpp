@@ -44,10 +44,8 @@ void SegmentTermPositions::seek(const TermInfo* ti, Term* term) {
 void SegmentTermPositions::close() {
     SegmentTermDocs::close();
     //Check if proxStream still exists
-    if(proxStream){
-        proxStream->close();
-        _CLDELETE( proxStream );
-    }
+    if(proxStream)
+        pool->releaseProxStream(proxStream);
 }
 
 int32_t SegmentTermPositions::nextPosition() {
@@ -120,7 +118,7 @@ void SegmentTermPositions::skipPayload() {
 void SegmentTermPositions::lazySkip() {
     if (proxStream == NULL) {
       // clone lazily
-      proxStream = parent->proxStream->clone();
+      proxStream = pool->getProxStream(parent->proxStream);
     }
     
     // we might have to skip the current payload
@@ -18,7 +18,9 @@
 #include "_FieldInfos.h"
 #include "_TermInfo.h"
 #include "_TermInfosWriter.h"
+#include "CLucene/store/_ModifiedUTF8.h"
 #include "_TermInfosReader.h"
+#include "CLucene/util/_ProfileHook.h"
 
 CL_NS_USE(store)
 CL_NS_USE(util)
@@ -26,7 +28,7 @@ CL_NS_DEF(index)
 
 
   TermInfosReader::TermInfosReader(Directory* dir, const char* seg, FieldInfos* fis, const int32_t readBufferSize):
-      directory (dir),fieldInfos (fis), indexTerms(NULL), indexInfos(NULL), indexPointers(NULL), indexDivisor(1)
+      directory (dir),fieldInfos (fis), indexFields(NULL), indexText(NULL), indexTextStarts(NULL), indexInfos(NULL), indexPointers(NULL), indexDivisor(1)
   {
   //Func - Constructor.
   //       Reads the TermInfos file (.tis) and eventually the Term Info Index file (.tii)
@@ -79,7 +81,7 @@ CL_NS_DEF(index)
   //Post - The instance has been destroyed
 
       //Close the TermInfosReader to be absolutly sure that enumerator has been closed
-	  //and the arrays indexTerms, indexPointers and indexInfos and  their elements
+	  //and the arrays of the index terms, indexPointers and indexInfos and  their elements
 	  //have been destroyed
       close();
   }
@@ -95,7 +97,7 @@ CL_NS_DEF(index)
 	  if (indexDivisor < 1)
 		  _CLTHROWA(CL_ERR_IllegalArgument, "indexDivisor must be > 0");
 
-	  if (indexTerms != NULL)
+	  if (indexFields != NULL)
 		  _CLTHROWA(CL_ERR_IllegalArgument, "index terms are already loaded");
 
 	  this->indexDivisor = _indexDivisor;
@@ -105,19 +107,14 @@ CL_NS_DEF(index)
   int32_t TermInfosReader::getIndexDivisor() const { return indexDivisor; }
   void TermInfosReader::close() {
 
-	  //Check if indexTerms and indexInfos exist
-     if (indexTerms && indexInfos){
-          //Iterate through arrays indexTerms and indexPointer to
-	      //destroy their elements
-#ifdef _DEBUG
-         for ( int32_t i=0; i<indexTermsLength;++i ){
-            indexTerms[i].__cl_refcount--;
-         }
-#endif
-         //Delete the arrays
-         delete [] indexTerms;
-         _CLDELETE_ARRAY(indexInfos);
-     }
+	  //Delete the arrays of the index terms
+      _CLDELETE_ARRAY(indexFields);
+      if (indexText != NULL){
+        free(indexText);
+        indexText = NULL;
+      }
+      _CLDELETE_ARRAY(indexTextStarts);
+      _CLDELETE_ARRAY(indexInfos);
 
       //Delete the arrays
       _CLDELETE_ARRAY(indexPointers);
@@ -209,6 +206,11 @@ CL_NS_DEF(index)
 
     ensureIndexIsRead();
 
+    ProfileHook* profile = ProfileHook::current();
+    int64_t start = profile == NULL ? 0 : Misc::currentTimeMicros();
+    TermInfo* ret = NULL;
+    bool scanned = false;
+
     // optimize sequential access: first try scanning cached enum w/o seeking
     SegmentTermEnum* enumerator = getEnum();
 
@@ -229,21 +231,27 @@ CL_NS_DEF(index)
 
 		// but before end of block
 		if (
-			//the length of indexTerms (the number of terms in enumerator) equals
+			//the number of index terms equals
 			//_enum_offset OR
 			indexTermsLength == _enumOffset	 ||
-			//term is positioned in front of term found at _enumOffset in indexTerms
-			term->compareTo(&indexTerms[_enumOffset]) < 0){
+			//term is positioned in front of index term at _enumOffset
+			compareToIndexTerm(term, _enumOffset) < 0){
 
 			//no need to seek, retrieve the TermInfo for term
-			return scanEnum(term);
+			ret = scanEnum(term);
+			scanned = true;
         }
     }
 
-    //Reposition current term in the enumeration
-    seekEnum(getIndexOffset(term));
-	//Return the TermInfo for term
-    return scanEnum(term);
+    if ( !scanned ){
+      //Reposition current term in the enumeration
+      seekEnum(getIndexOffset(term));
+      //Return the TermInfo for term
+      ret = scanEnum(term);
+    }
+    if ( profile != NULL )
+      profile->termLookup(Misc::currentTimeMicros() - start);
+    return ret;
   }
 
 
@@ -304,22 +312,21 @@ CL_NS_DEF(index)
   //       This file contains every IndexInterval-th entry from the .tis file,
   //       along with its location in the "tis" file. This is designed to be read entirely
   //       into memory and used to provide random access to the "tis" file.
-  //Pre  - indexTerms    = NULL
+  //Pre  - indexFields   = NULL
   //       indexInfos    = NULL
   //       indexPointers = NULL
   //Post - The term info index file has been read into memory
 
     SCOPED_LOCK_MUTEX(THIS_LOCK)
 
-	  if ( indexTerms != NULL )
+	  if ( indexFields != NULL )
 		  return;
 
       try {
           indexTermsLength = (size_t)indexEnum->size;
 
-		      //Instantiate an block of Term's,so that each one doesn't have to be new'd
-          indexTerms    = new Term[indexTermsLength];
-          CND_CONDITION(indexTerms != NULL,"No memory could be allocated for indexTerms");//Check if is indexTerms is a valid array
+          indexFields     = _CL_NEWARRAY(const TCHAR*,indexTermsLength);
+          indexTextStarts = _CL_NEWARRAY(int32_t,indexTermsLength+1);
 
 		  //Instantiate an big block of TermInfo's, so that each one doesn't have to be new'd
           indexInfos    = _CL_NEWARRAY(TermInfo,indexTermsLength);
@@ -329,9 +336,26 @@ CL_NS_DEF(index)
           indexPointers = _CL_NEWARRAY(int64_t,indexTermsLength);
           CND_CONDITION(indexPointers != NULL,"No memory could be allocated for indexPointers");//Check if is indexPointers is a valid array
 
+          size_t textSize = 0;
+          size_t textCapacity = 0;
+
 		  //Iterate through the terms of indexEnum
-          for (int32_t i = 0; indexEnum->next(); ++i){
-              indexTerms[i].set(indexEnum->term(false),indexEnum->term(false)->text());
+          int32_t i = 0;
+          for (; indexEnum->next(); ++i){
+              const Term* term = indexEnum->term(false);
+              indexFields[i] = term->field();
+
+              //Encode the text at the end of indexText, growing it as needed
+              const size_t textLen = term->textLength();
+              if ( textSize + textLen*3 > textCapacity ){
+                  textCapacity = cl_max(textCapacity*2, textSize + textLen*3);
+                  indexText = (uint8_t*)realloc(indexText, textCapacity);
+              }
+              uint8_t* out = indexText + textSize;
+              ModifiedUTF8::encode(term->text(), term->text() + textLen, out, indexText + textCapacity);
+              indexTextStarts[i] = (int32_t)textSize;
+              textSize = out - indexText;
+
               indexEnum->getTermInfo(&indexInfos[i]);
               indexPointers[i] = indexEnum->indexPointer;
 
@@ -339,6 +363,10 @@ CL_NS_DEF(index)
 				        if (!indexEnum->next())
 					        break;
           }
+          indexTextStarts[i] = (int32_t)textSize;
+          //Give back the unused capacity
+          if ( textSize > 0 )
+              indexText = (uint8_t*)realloc(indexText, textSize);
     }_CLFINALLY(
           indexEnum->close();
 		  //Close and delete the IndexInput is. The close is done by the destructor.
@@ -348,14 +376,25 @@ CL_NS_DEF(index)
   }
 
 
+  int32_t TermInfosReader::compareToIndexTerm(const Term* term, const int32_t indexOffset) const{
+      const TCHAR* field = indexFields[indexOffset];
+      if ( term->field() != field ){
+          int32_t ret = _tcscmp(term->field(), field);
+          if ( ret != 0 )
+              return ret;
+      }
+      return ModifiedUTF8::compare(term->text(), term->textLength(),
+          indexText + indexTextStarts[indexOffset], indexText + indexTextStarts[indexOffset+1]);
+  }
+
   int32_t TermInfosReader::getIndexOffset(const Term* term){
   //Func - Returns the offset of the greatest index entry which is less than or equal to term.
   //Pre  - term holds a reference to a valid term
-  //       indexTerms != NULL
+  //       indexFields != NULL
   //Post - The new offset has been returned
 
-      //Check if is indexTerms is a valid array
-      CND_PRECONDITION(indexTerms != NULL,"indexTerms is NULL");
+      //Check if is indexFields is a valid array
+      CND_PRECONDITION(indexFields != NULL,"indexFields is NULL");
 
       int32_t lo = 0;
       int32_t hi = indexTermsLength - 1;
@@ -366,12 +405,10 @@ CL_NS_DEF(index)
           //Start in the middle betwee hi and lo
           mid = (lo + hi) >> 1;
 
-          //Check if is indexTerms[mid] is a valid instance of Term
-          CND_PRECONDITION(&indexTerms[mid] != NULL,"indexTerms[mid] is NULL");
           CND_PRECONDITION(mid < indexTermsLength,"mid >= indexTermsLength");
 
 		  //Determine if term is before mid or after mid
-          delta = term->compareTo(&indexTerms[mid]);
+          delta = compareToIndexTerm(term, mid);
           if (delta < 0){
               //Calculate the new hi
               hi = mid - 1;
@@ -390,13 +427,13 @@ CL_NS_DEF(index)
   void TermInfosReader::seekEnum(const int32_t indexOffset) {
   //Func - Reposition the current Term and TermInfo to indexOffset
   //Pre  - indexOffset >= 0
-  //       indexTerms    != NULL
+  //       indexFields   != NULL
   //       indexInfos    != NULL
   //       indexPointers != NULL
   //Post - The current Term and Terminfo have been repositioned to indexOffset
 
       CND_PRECONDITION(indexOffset >= 0, "indexOffset contains a negative number");
-      CND_PRECONDITION(indexTerms != NULL,    "indexTerms is NULL");
+      CND_PRECONDITION(indexFields != NULL,   "indexFields is NULL");
       CND_PRECONDITION(indexInfos != NULL,    "indexInfos is NULL");
       CND_PRECONDITION(indexPointers != NULL, "indexPointers is NULL");
 
@@ -404,7 +441,9 @@ CL_NS_DEF(index)
 	  enumerator->seek(
           indexPointers[indexOffset],
 		  ((int64_t) indexOffset * (int64_t)totalIndexInterval) - 1,
-          &indexTerms[indexOffset],
+          indexFields[indexOffset],
+          indexText + indexTextStarts[indexOffset],
+          indexTextStarts[indexOffset+1] - indexTextStarts[indexOffset],
 		  &indexInfos[indexOffset]
 	      );
   }
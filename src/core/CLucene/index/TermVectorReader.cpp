@@ -312,6 +312,54 @@ void TermVectorsReader::get(const int32_t docNumber, TermVectorMapper* mapper) {
     }
   }
 
+bool TermVectorsReader::rawDocs(const int32_t startDocID, const int32_t numDocs,
+		CL_NS(store)::IndexInput*& tvdStream, CL_NS(store)::IndexInput*& tvfStream, int64_t& tvfLength){
+	if (tvx == NULL || tvdFormat != FORMAT_VERSION || tvfFormat != FORMAT_VERSION)
+		return false;
+
+	const int64_t docID = (int64_t)docStoreOffset + startDocID;
+	// the doc store may hold documents of other segments after ours
+	const int64_t storeDocs = (tvx->length() - FORMAT_SIZE) / 8;
+	tvx->seek((docID * 8L) + FORMAT_SIZE);
+	const int64_t tvdStart = tvx->readLong();
+
+	// The tvd entries are contiguous, so walk them to find the first tvf
+	// pointer of our documents and the first one following them
+	tvd->seek(tvdStart);
+	int64_t tvfStart = -1;
+	int64_t tvfEnd = -1;
+	for (int64_t doc = docID; doc < storeDocs; ++doc) {
+		if (doc >= docID + numDocs && tvfStart == -1)
+			break; // none of our documents has vectors
+		const int32_t fieldCount = tvd->readVInt();
+		if (fieldCount == 0)
+			continue;
+		for (int32_t i = 0; i < fieldCount; ++i)
+			tvd->readVInt();
+		const int64_t first = tvd->readVLong();
+		for (int32_t i = 1; i < fieldCount; ++i)
+			tvd->readVLong();
+
+		if (doc >= docID + numDocs) {
+			tvfEnd = first;
+			break;
+		}
+		if (tvfStart == -1)
+			tvfStart = first;
+	}
+	if (tvfStart == -1)
+		tvfStart = tvfEnd = FORMAT_SIZE;
+	else if (tvfEnd == -1)
+		tvfEnd = tvf->length();
+
+	tvd->seek(tvdStart);
+	tvf->seek(tvfStart);
+	tvdStream = tvd;
+	tvfStream = tvf;
+	tvfLength = tvfEnd - tvfStart;
+	return true;
+}
+
 ObjectArray<SegmentTermVector>* TermVectorsReader::readTermVectors(const int32_t docNum,
 										const TCHAR** fields, const int64_t* tvfPointers, const int32_t len){
 	ObjectArray<SegmentTermVector>* res = _CLNEW CL_NS(util)::ObjectArray<SegmentTermVector>(len);
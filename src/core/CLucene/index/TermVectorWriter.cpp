@@ -227,4 +227,37 @@ CL_NS_DEF(index)
       tvd->writeVInt(0);
   }
 
+  bool TermVectorsWriter::addRawDocuments(TermVectorsReader* reader, const int32_t startDocID, const int32_t numDocs){
+    CL_NS(store)::IndexInput* tvdIn;
+    CL_NS(store)::IndexInput* tvfIn;
+    int64_t tvfLength;
+    if ( !reader->rawDocs(startDocID, numDocs, tvdIn, tvfIn, tvfLength) )
+      return false;
+
+    // The tvd entries are rewritten, since the first tvf pointer of each
+    // document is absolute. The field numbers and pointer deltas stay as they are.
+    int64_t tvfShift = 0;
+    bool shiftKnown = false;
+    for (int32_t i=0; i<numDocs; i++) {
+      tvx->writeLong(tvd->getFilePointer());
+      const int32_t numFields = tvdIn->readVInt();
+      tvd->writeVInt(numFields);
+      if (numFields == 0)
+        continue;
+      for (int32_t j=0; j<numFields; j++)
+        tvd->writeVInt(tvdIn->readVInt());
+      const int64_t first = tvdIn->readVLong();
+      if (!shiftKnown) {
+        tvfShift = tvf->getFilePointer() - first;
+        shiftKnown = true;
+      }
+      tvd->writeVLong(first + tvfShift);
+      for (int32_t j=1; j<numFields; j++)
+        tvd->writeVLong(tvdIn->readVLong());
+    }
+    if (tvfLength > 0)
+      tvf->copyBytes(tvfIn, tvfLength);
+    return true;
+  }
+
 CL_NS_END
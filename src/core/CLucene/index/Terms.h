@@ -8,6 +8,7 @@
 #define _lucene_index_Terms_
 
 #include "CLucene/util/Equators.h"
+#include "CLucene/util/Arena.h"
 CL_NS_DEF(index)
 
 //predefine
@@ -26,6 +27,7 @@ class TermPositions;
 class CLUCENE_EXPORT TermDocs {
 public:
 	virtual ~TermDocs();
+	LUCENE_ARENA_ALLOCATED
 
 	// Sets this to the data for a term.
 	// The enumeration is reset to the start of the data for this term.
@@ -108,10 +108,10 @@ class CompoundFileWriter:LUCENE_BASE {
   Internal* _internal;
 
 	/** Copy the contents of the file with specified extension into the
-	*  provided output stream. Use the provided buffer for moving data
-	*  to reduce memory allocation.
+	*  provided output stream, in chunks of LUCENE_COMPOUND_FILE_COPY_CHUNK_SIZE
+	*  bytes through IndexOutput::copyBytes.
 	*/
-	void copyFile(WriterFileEntry* source, CL_NS(store)::IndexOutput* os, uint8_t* buffer, int32_t bufferLength);
+	void copyFile(WriterFileEntry* source, CL_NS(store)::IndexOutput* os);
 public:
 	/** Create the compound stream in the specified file. The file name is the
 	*  entire name (no extensions are added).
@@ -43,6 +43,14 @@ public:
   AbortException(CLuceneError& _err, DocumentsWriter* docWriter);
 };
 
+/** Told by DW that a document got its docID, before the document is
+ *  inverted. Lets the caller order the docIDs of several threads. */
+class DocIDCallback{
+public:
+  virtual ~DocIDCallback(){}
+  virtual void docIDAssigned() = 0;
+};
+
 /**
  * This class accepts multiple added documents and directly
  * writes a single segment file.  It does this more
@@ -872,7 +880,8 @@ public:
 
   bool updateDocument(Term* t, CL_NS(document)::Document* doc, CL_NS(analysis)::Analyzer* analyzer);
 
-  bool updateDocument(CL_NS(document)::Document* doc, CL_NS(analysis)::Analyzer* analyzer, Term* delTerm);
+  bool updateDocument(CL_NS(document)::Document* doc, CL_NS(analysis)::Analyzer* analyzer, Term* delTerm,
+                      DocIDCallback* callback = NULL);
 
   int32_t getNumBufferedDeleteTerms();
 
@@ -43,14 +43,29 @@ CL_NS_DEF(index)
 		// file.  This will be 0 if we have our own private file.
 		int32_t docStoreOffset;
 
+		// The reader that was opened from the directory. Clones create
+		// their lazy fields on it, so that they may outlive the clone.
+		FieldsReader* origin;
+
+		FieldsReader(const FieldsReader& copy);
+
 		DEFINE_MUTEX(THIS_LOCK)
-		CL_NS(util)::ThreadLocal<CL_NS(store)::IndexInput*, CL_NS(util)::Deletor::Object<CL_NS(store)::IndexInput> > fieldsStreamTL;
+		// The streams of the lazy fields. Only the origin has one: clones
+		// may be thread local values themselves, which must not own a
+		// ThreadLocal.
+		CL_NS(util)::ThreadLocal<CL_NS(store)::IndexInput*, CL_NS(util)::Deletor::Object<CL_NS(store)::IndexInput> >* fieldsStreamTL;
     static void uncompress(const CL_NS(util)::ValueArray<uint8_t>& input, CL_NS(util)::ValueArray<uint8_t>& output);
 	public:
 		FieldsReader(CL_NS(store)::Directory* d, const char* segment, FieldInfos* fn,
 			int32_t readBufferSize = CL_NS(store)::BufferedIndexInput::BUFFER_SIZE, int32_t docStoreOffset = -1, int32_t size = 0);
 		virtual ~FieldsReader();
 
+		/**
+		* Returns a reader of the same documents with its own streams, for
+		* use by another thread. Closing the clone does not close this reader.
+		*/
+		FieldsReader* clone() const;
+
 	//protected:
 		/**
 		* @throws an exception (CL_ERR_IllegalState) if this FieldsReader is closed
@@ -29,9 +29,53 @@
 CL_NS_DEF(index)
 class SegmentReader;
 
+/**
+* Keeps the streams and skip list readers of the closed SegmentTermDocs and
+* SegmentTermPositions of a segment, so that the next ones reuse them instead
+* of cloning the .frq and .prx streams (and allocating their buffers) again.
+* Every enumerator holds a reference to the pool, which may thus outlive its
+* SegmentReader; once the reader has closed the pool, released objects are
+* deleted.
+*/
+class SegmentTermDocsPool: LUCENE_REFBASE {
+  typedef std::vector<CL_NS(store)::IndexInput*> StreamsType;
+  typedef std::vector<DefaultSkipListReader*> SkipListReadersType;
+
+  DEFINE_MUTEX(THIS_LOCK)
+  StreamsType freqStreams;
+  StreamsType proxStreams;
+  SkipListReadersType skipListReaders;
+  bool closed;
+public:
+  /** Maximum number of objects of each kind kept by the pool */
+  LUCENE_STATIC_CONSTANT(size_t, MAX_POOLED=16);
+
+  SegmentTermDocsPool();
+  ~SegmentTermDocsPool();
+
+  /** Returns a pooled clone of the .frq stream, or a new clone of base */
+  CL_NS(store)::IndexInput* getFreqStream(CL_NS(store)::IndexInput* base);
+  /** Returns a pooled clone of the .prx stream, or a new clone of base */
+  CL_NS(store)::IndexInput* getProxStream(CL_NS(store)::IndexInput* base);
+  /** Returns a pooled skip list reader, or NULL. It must be init()ed */
+  DefaultSkipListReader* getSkipListReader();
+
+  /** Gives the stream back to the pool and sets it to NULL */
+  void releaseFreqStream(CL_NS(store)::IndexInput*& stream);
+  void releaseProxStream(CL_NS(store)::IndexInput*& stream);
+  void releaseSkipListReader(DefaultSkipListReader*& reader);
+
+  /** Number of objects currently kept by the pool */
+  size_t size();
+
+  /** Deletes the pooled objects; objects released later are deleted */
+  void close();
+};
+
 class SegmentTermDocs:public virtual TermDocs {
 protected:
   const SegmentReader* parent;
+  SegmentTermDocsPool* pool;
   CL_NS(store)::IndexInput* freqStream;
   int32_t count;
   int32_t df;
@@ -241,10 +285,18 @@ class SegmentReader: public DirectoryIndexReader {
 
   ///Reads the Field Info file
   FieldsReader* fieldsReader;
+  ///Clones of fieldsReader, one per thread that loaded a document. A clone is
+  ///not freed by close(): it lives until its thread exits or this reader is
+  ///destroyed
+  CL_NS(util)::ThreadLocal<FieldsReader*,
+  CL_NS(util)::Deletor::Object<FieldsReader> >fieldsReaderLocal;
   TermVectorsReader* termVectorsReaderOrig;
   CL_NS(util)::ThreadLocal<TermVectorsReader*,
   CL_NS(util)::Deletor::Object<TermVectorsReader> >termVectorsLocal;
 
+  // the streams of the closed term docs and positions, for the next ones
+  SegmentTermDocsPool* termDocsPool;
+
   void initialize(SegmentInfo* si, int32_t readBufferSize, bool doOpenStores, bool doingReopen);
 
   /**
@@ -254,6 +306,12 @@ class SegmentReader: public DirectoryIndexReader {
   TermVectorsReader* getTermVectorsReader();
 
   FieldsReader* getFieldsReader();
+  /**
+   * Create a clone from the initial FieldsReader and store it in the ThreadLocal.
+   * The clone is kept until the calling thread exits or this reader is destroyed.
+   * @return FieldsReader
+   */
+  FieldsReader* getLocalFieldsReader();
   FieldInfos* getFieldInfos();
 
 protected:
@@ -335,6 +393,8 @@ public:
   TermDocs* termDocs();
   ///Returns an unpositioned TermPositions enumerator.
   TermPositions* termPositions();
+  ///The pool of the streams of the closed term docs and positions
+  SegmentTermDocsPool* getTermDocsPool();
 
   ///Returns the number of documents which contain the term t
   int32_t docFreq(const Term* t);
@@ -399,8 +459,12 @@ private:
   //Open all norms files for all fields
   void openNorms(CL_NS(store)::Directory* cfsDir, int32_t readBufferSize);
 
-  ///a bitVector that manages which documents have been deleted
+  ///a bitVector that manages which documents have been deleted.
+  ///isDeleted() reads it without locking, so it is only freed on close
   CL_NS(util)::BitSet* deletedDocs;
+  ///the cleared deletedDocs dropped by undeleteAll, reused by the next
+  ///deletion and freed on close
+  CL_NS(util)::BitSet* spareDeletedDocs;
   ///an IndexInput to the frequency file
   CL_NS(store)::IndexInput* freqStream;
   ///For reading the fieldInfos file
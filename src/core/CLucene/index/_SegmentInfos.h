@@ -63,6 +63,7 @@ CL_NS_DEF(index)
                                                   // in the Directory
 
 		int64_t _sizeInBytes;					  // total byte size of all of our files (computed on demand)
+		int32_t _delCount;						  // number of deleted docs (computed on demand)
 
 		int32_t docStoreOffset;					  // if this segment shares stored fields & vectors, this
                                                   // offset is where in that file this segment's docs begin
@@ -103,6 +104,10 @@ CL_NS_DEF(index)
     int64_t sizeInBytes();
 		bool hasDeletions() const;
 
+		/** Returns the number of deleted documents, read from the header
+		*  of the deletions file (computed on demand) */
+		int32_t getDelCount();
+
 		void advanceDelGen();
 		void clearDelGen();
 
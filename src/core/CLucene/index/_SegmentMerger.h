@@ -19,6 +19,7 @@ CL_CLASS_DEF(store,Directory)
 
 CL_NS_DEF(index)
 class DefaultSkipListWriter;
+class SegmentReader;
 /**
 * The SegmentMerger class combines two or more Segments, represented by an IndexReader ({@link #add},
 * into a single Segment.  After adding the appropriate readers, call the merge method to combine the 
@@ -35,6 +36,8 @@ class SegmentMerger:LUCENE_BASE {
 	
 	//Directory of the segment
 	CL_NS(store)::Directory* directory;     
+	//Wraps the writer's directory if merges are rate limited, owned by the merger
+	CL_NS(store)::Directory* rateLimitedDirectory;
 	//name of the new segment
   std::string segment;
 	//Set of IndexReaders
@@ -51,7 +54,7 @@ class SegmentMerger:LUCENE_BASE {
   bool mergeDocStores;
 
   /** Maximum number of contiguous documents to bulk-copy
-  when merging stored fields */
+  when merging stored fields and term vectors */
   static int32_t MAX_RAW_MERGE_DOCS;
 
 	//The queue that holds SegmentMergeInfo instances
@@ -145,6 +148,13 @@ private:
 		bool storeTermVectors, bool storePositionWithTermVector,
 		bool storeOffsetWithTermVector, bool storePayloads);
 
+	/**
+	* Sets the i'th entry to the i'th reader if it is a SegmentReader with the same
+	* field name -> number mapping as the merged segment, i.e. if its stored fields
+	* and term vectors can be copied as raw bytes. Sets it to NULL otherwise.
+	*/
+	void setMatchingSegmentReaders(CL_NS(util)::ValueArray<SegmentReader*>& matchingSegmentReaders);
+
 	/**
 	* Merge the fields of all segments 
 	* @return The number of documents in all of the readers
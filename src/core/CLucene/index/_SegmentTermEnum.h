@@ -86,8 +86,11 @@ public:
 
 	/**
 	 * Repositions term and termInfo within the enumeration
+	 * @param text the text of the new term, as encoded in the index files
+	 * @param textLength the number of bytes of text
 	 */
-	void seek(const int64_t pointer, const int64_t p, Term* t, TermInfo* ti);
+	void seek(const int64_t pointer, const int64_t p, const TCHAR* field, const uint8_t* text,
+		const int32_t textLength, TermInfo* ti);
 	
 	/**
 	 * Returns a clone of the current termInfo
@@ -38,7 +38,12 @@ CL_NS_DEF(index)
 		SegmentTermEnum* indexEnum;
 		int64_t _size;
 
-		Term* indexTerms; //note: this is a list of objects, not arrays!
+		// The index terms are kept as their field and their text encoded as in
+		// the index files, all texts back to back in indexText, instead of as
+		// Term objects holding TCHAR strings
+		const TCHAR** indexFields; //owned by fieldInfos
+		uint8_t* indexText;
+		int32_t* indexTextStarts; //start of each text in indexText, followed by the end
     int32_t indexTermsLength;
 		TermInfo* indexInfos;
 		int64_t* indexPointers;
@@ -105,6 +110,9 @@ CL_NS_DEF(index)
 		/** Reads the term info index file or .tti file. */
 		void ensureIndexIsRead();
 
+		/** Compares term with the index term at indexOffset, like Term::compareTo */
+		int32_t compareToIndexTerm(const Term* term, const int32_t indexOffset) const;
+
 		/** Returns the offset of the greatest index entry which is less than or equal to term.*/
 		int32_t getIndexOffset(const Term* term);
 
@@ -14,6 +14,8 @@
 
 CL_NS_DEF(index)
 
+class TermVectorsReader;
+
 class TermVectorsWriter:LUCENE_BASE {
 private:
 	CL_NS(store)::IndexOutput* tvx, *tvd, *tvf;
@@ -33,6 +35,15 @@ public:
   */
 	void addAllDocVectors(CL_NS(util)::ArrayBase<TermFreqVector*>* vectors);
 
+  /**
+  * Bulk write the vectors of <code>numDocs</code> contiguous documents of
+  * <code>reader</code>, starting at <code>startDocID</code>. The tvf bytes are
+  * copied as they are, only the tvx and tvd pointers into them are adjusted.
+  * The field numbers of the reader's segment must match ours.
+  * @return false if the reader can't supply raw documents, nothing was written then
+  */
+  bool addRawDocuments(TermVectorsReader* reader, const int32_t startDocID, const int32_t numDocs);
+
   /** Close all streams.
   * to suppress exceptions from being thrown, pass an error object to be filled in
   */
@@ -141,6 +152,17 @@ public:
 
 	void get(const int32_t docNumber, TermVectorMapper* mapper);
 
+	/**
+	* Expert: used by SegmentMerger to copy the vectors of <code>numDocs</code>
+	* documents starting at <code>startDocID</code> without decoding them.
+	* Positions <code>tvdStream</code> at the tvd entry of startDocID and
+	* <code>tvfStream</code> at the first vector of these documents.
+	* @param tvfLength receives the number of tvf bytes holding their vectors
+	* @return false if the files use an older format and can't be copied raw
+	*/
+	bool rawDocs(const int32_t startDocID, const int32_t numDocs,
+		CL_NS(store)::IndexInput*& tvdStream, CL_NS(store)::IndexInput*& tvfStream, int64_t& tvfLength);
+
 private:
 	CL_NS(util)::ObjectArray<SegmentTermVector>* readTermVectors(const int32_t docNum,
 		const TCHAR** fields, const int64_t* tvfPointers, const int32_t len);
@@ -18,6 +18,7 @@
 #include "Explanation.h"
 #include "_BooleanScorer2.h"
 #include "Scorer.h"
+#include "QueryProfile.h"
 
 #include <assert.h>
 
@@ -365,7 +366,7 @@ CL_NS_DEF(search)
       for (size_t i = 0 ; i < weights.size(); i++) {
         BooleanClause* c = (*clauses)[i];
         Weight* w = weights[i];
-        Scorer* subScorer = w->scorer(reader);
+        Scorer* subScorer = QueryProfile::scorer(w, reader);
         if (subScorer != NULL)
           result->add(subScorer, c->isRequired(), c->isProhibited());
         else if (c->isRequired()){
@@ -7,7 +7,6 @@
 #include "CLucene/_ApiHeader.h"
 #include "CLucene/index/Terms.h"
 #include "SearchHeader.h"
-#include "SearchHeader.h"
 #include "Scorer.h"
 #include "_ExactPhraseScorer.h"
 
@@ -33,54 +32,47 @@ CL_NS_DEF(search)
 
 	float_t ExactPhraseScorer::phraseFreq(){
 	//Func - Returns the freqency of the phrase
-	//Pre  - first != NULL
-	//       last  != NULL
-	//       pq    != NULL
-	//       size of the PhraseQueue pq is 0
+	//Pre  - all PhrasePositions in pps are positioned on the same doc
 	//Post - The frequency of the phrase has been returned
 
-		CND_PRECONDITION(first != NULL,"first is NULL");
-		CND_PRECONDITION(last  != NULL,"last is NULL");
-		CND_PRECONDITION(pq    != NULL,"pq is NULL");
-		CND_PRECONDITION(pq->size()==0,"pq is not empty");
-
-		// sort list with pq
-		pq->clear();
+		CND_PRECONDITION(pps != NULL,"pps is NULL");
+		CND_PRECONDITION(ppsLength > 0,"pps is empty");
 
-		//Add the nodes of the list of PhrasePositions and store them
-		//into the PhraseQueue pq so it can used to build
-		//a list of sorted nodes
-		for (PhrasePositions* pp = first; pp != NULL; pp = pp->_next) {
-			//Read the first TermPosition of the current PhrasePositions pp
-			pp->firstPosition();
-			//Store the current PhrasePositions pp into the PhraseQueue pq
-			pq->put(pp);
+		// decode the positions of every term in one go and let the term
+		// with the fewest positions in this doc lead the merge
+		PhrasePositions* lead = NULL;
+		for (int32_t i = 0; i < ppsLength; i++) {
+			PhrasePositions* pp = pps[i];
+			pp->loadPositions();
+			if (lead == NULL || pp->positionsLength < lead->positionsLength)
+				lead = pp;
 		}
-		//pqToList requires that first and last be NULL when it's called.  
-		//This is done at the beginning of pqToList()
-		//In this case, the nodes of the linked list are referenced by pq (see
-		//above loop), so we can clear our pointers to the head and tail of the
-		//linked list without fear of leaking the nodes.
-		
-		//rebuild list from pq
-		pqToList();
 
 		// for counting how many times the exact phrase is found in current document,
-		// just count how many times all PhrasePosition's have exactly the same position.   
+		// just count how many times all PhrasePosition's have exactly the same position.
+		// The position arrays are sorted, so a single linear merge suffices.
 		int32_t freq = 0;
-		do {		//find position with all terms
-			while (first->position < last->position){	//scan forward in first
-				do{
-					if (!first->nextPosition()){
-						return (float_t)freq;
-					}
-				} while (first->position < last->position);
-				//Make the current first node the last node in the list
-				firstToLast();
+		for (int32_t l = 0; l < lead->positionsLength; l++) {
+			const int32_t target = lead->positions[l];
+			bool match = true;
+			for (int32_t i = 0; i < ppsLength; i++) {
+				PhrasePositions* pp = pps[i];
+				if (pp == lead)
+					continue;
+				int32_t j = pp->positionIndex;
+				while (j < pp->positionsLength && pp->positions[j] < target)
+					j++;
+				pp->positionIndex = j;
+				if (j == pp->positionsLength)
+					return (float_t)freq;    // a term ran out of positions
+				if (pp->positions[j] != target) {
+					match = false;
+					break;
+				}
 			}
-			//all equal: a match has been found
-			freq++;
-		} while (last->nextPosition());
+			if (match)
+				freq++;
+		}
 
 		return (float_t)freq;
 	}
@@ -12,6 +12,7 @@
 #include "BooleanQuery.h"
 #include "BooleanClause.h"
 #include "TermQuery.h"
+#include "QueryProfile.h"
 
 #include "CLucene/util/StringBuffer.h"
 #include "CLucene/util/PriorityQueue.h"
@@ -418,6 +419,7 @@ CL_NS_DEF(search)
 	  }
 	  _CLLDELETE(stQueue);
 
+	  QueryProfile::termsExpanded(query, (int32_t)size);
 	  return query;
   }
 
@@ -27,6 +27,10 @@ CL_NS_DEF(search)
 	* performance issues. If you need to iterate over many or all hits, consider
 	* using the search method that takes a {@link HitCollector}.
 	* </p>
+	* <p>Hits re-executes the query with a doubled window whenever a hit past
+	* the current window is requested. To page through results with a
+	* predictable cost per page use {@link Searcher#searchAfter} instead.
+	* </p>
 	* <p><b>Note:</b> Deleting matching documents concurrently with traversing 
 	* the hits, might, when deleting hits that were not yet retrieved, decrease
 	* {@link #length()}. In such case, 
@@ -20,6 +20,11 @@
 #include "CLucene/util/BitSet.h"
 #include "FieldSortedHitQueue.h"
 #include "Explanation.h"
+#include "QueryResultCache.h"
+#include "_TopFieldDocsCollector.h"
+#include "CLucene/util/Arena.h"
+#include "CLucene/util/Misc.h"
+#include "QueryProfile.h"
 
 CL_NS_USE(index)
 CL_NS_USE(util)
@@ -27,6 +32,20 @@ CL_NS_USE(document)
 
 CL_NS_DEF(search)
 
+  /** Makes an arena current for the duration of a search, if requested */
+  class ArenaScope{
+    Arena* arena;
+  public:
+    ArenaScope(bool useArena):
+      arena(useArena ? Arena::begin() : NULL)
+    {
+    }
+    ~ArenaScope(){
+      if ( arena != NULL )
+        arena->end();
+    }
+  };
+
 	class SimpleTopDocsCollector:public HitCollector{ 
 	private:
 		float_t minScore;
@@ -119,6 +138,8 @@ CL_NS_DEF(search)
 
       reader = IndexReader::open(path);
       readerOwner = true;
+      resultCache = NULL;
+      useArena = false;
   }
   
   IndexSearcher::IndexSearcher(CL_NS(store)::Directory* directory){
@@ -131,6 +152,8 @@ CL_NS_DEF(search)
 
       reader = IndexReader::open(directory);
       readerOwner = true;
+      resultCache = NULL;
+      useArena = false;
   }
 
   IndexSearcher::IndexSearcher(IndexReader* r){
@@ -141,6 +164,8 @@ CL_NS_DEF(search)
 
       reader      = r;
       readerOwner = false;
+      resultCache = NULL;
+      useArena = false;
   }
 
   IndexSearcher::~IndexSearcher(){
@@ -222,8 +247,18 @@ CL_NS_DEF(search)
       CND_PRECONDITION(reader != NULL, "reader is NULL");
       CND_PRECONDITION(query != NULL, "query is NULL");
 
+      //a profiled search does the work, it is not answered from the cache
+      QueryProfile* profile = QueryProfile::current();
+      if ( resultCache != NULL && profile == NULL ){
+          TopDocs* cached = resultCache->get(reader, query, sim == NULL ? getSimilarity() : sim, filter, nDocs);
+          if ( cached != NULL )
+              return cached;
+      }
+      ArenaScope arenaScope(useArena);
+
       Weight* weight = query->weight(this, sim == NULL ? getSimilarity() : sim);
-      Scorer* scorer = weight->scorer(reader);
+      int64_t start = profile == NULL ? 0 : Misc::currentTimeMicros();
+      Scorer* scorer = QueryProfile::scorer(weight, reader);
       if (scorer == NULL) {
         Query* wq = weight->getQuery();
         if (wq != query)
@@ -233,6 +268,8 @@ CL_NS_DEF(search)
       }
 
       BitSet* bits = filter != NULL ? filter->bits(reader, sim == NULL ? getSimilarity() : sim) : NULL;
+      if ( profile != NULL )
+          profile->phaseDone(QueryProfile::SCORER, start);
       HitQueue* hq = _CLNEW HitQueue(nDocs);
 
 		  //Check hq has been allocated properly
@@ -263,7 +300,10 @@ CL_NS_DEF(search)
 			  _CLLDELETE(wq);
 		  _CLDELETE(weight);
 
-      return _CLNEW TopDocs(totalHitsInt, scoreDocs, scoreDocsLength);
+      TopDocs* ret = _CLNEW TopDocs(totalHitsInt, scoreDocs, scoreDocsLength);
+      if ( resultCache != NULL && profile == NULL )
+          resultCache->put(reader, query, sim == NULL ? getSimilarity() : sim, filter, nDocs, ret);
+      return ret;
   }
 
   // inherit javadoc
@@ -273,13 +313,47 @@ CL_NS_DEF(search)
       CND_PRECONDITION(reader != NULL, "reader is NULL");
       CND_PRECONDITION(query != NULL, "query is NULL");
 
+    QueryProfile* profile = QueryProfile::current();
+    if ( resultCache != NULL && profile == NULL ){
+        TopFieldDocs* cached = resultCache->get(reader, query, sim == NULL ? getSimilarity() : sim, filter, nDocs, sort);
+        if ( cached != NULL )
+            return cached;
+    }
+    ArenaScope arenaScope(useArena);
+
     Weight* weight = query->weight(this, sim == NULL ? getSimilarity() : sim);
-    Scorer* scorer = weight->scorer(reader);
+    int64_t start = profile == NULL ? 0 : Misc::currentTimeMicros();
+    Scorer* scorer = QueryProfile::scorer(weight, reader);
     if (scorer == NULL){
+        Query* wq = weight->getQuery();
+        if ( query != wq ) //query was re-written
+            _CLLDELETE(wq);
+        _CLLDELETE(weight);
 		return _CLNEW TopFieldDocs(0, NULL, 0, NULL );
 	}
 
     BitSet* bits = filter != NULL ? filter->bits(reader, sim == NULL ? getSimilarity() : sim) : NULL;
+    if ( profile != NULL )
+        profile->phaseDone(QueryProfile::SCORER, start);
+
+    TopFieldDocsCollector* fastCol = TopFieldDocsCollector::newInstance(reader, sort, bits, nDocs);
+    if ( fastCol != NULL ){
+        scorer->score(fastCol);
+        _CLLDELETE(scorer);
+        TopFieldDocs* ret = fastCol->topDocs();
+        _CLLDELETE(fastCol);
+
+        Query* wq = weight->getQuery();
+        if ( query != wq ) //query was re-written
+            _CLLDELETE(wq);
+        _CLLDELETE(weight);
+        if ( bits != NULL && filter->shouldDeleteBitSet(bits) )
+            _CLLDELETE(bits);
+        if ( resultCache != NULL && profile == NULL )
+            resultCache->put(reader, query, sim == NULL ? getSimilarity() : sim, filter, nDocs, sort, ret);
+        return ret;
+    }
+
     FieldSortedHitQueue hq(reader, sort->getSort(), nDocs);
     int32_t* totalHits = _CL_NEWARRAY(int32_t,1);
 	totalHits[0]=0;
@@ -305,7 +379,10 @@ CL_NS_DEF(search)
 	if ( bits != NULL && filter->shouldDeleteBitSet(bits) )
 		_CLLDELETE(bits);
     _CLDELETE_LARRAY(totalHits);
-    return _CLNEW TopFieldDocs(totalHits0, fieldDocs, hqLen, hqFields );
+    TopFieldDocs* ret = _CLNEW TopFieldDocs(totalHits0, fieldDocs, hqLen, hqFields );
+    if ( resultCache != NULL && profile == NULL )
+        resultCache->put(reader, query, sim == NULL ? getSimilarity() : sim, filter, nDocs, sort, ret);
+    return ret;
   }
 
   void IndexSearcher::_search(Query* query, Similarity* sim, Filter* filter, HitCollector* results){
@@ -321,6 +398,9 @@ CL_NS_DEF(search)
       CND_PRECONDITION(reader != NULL, "reader is NULL");
       CND_PRECONDITION(query != NULL, "query is NULL");
 
+      ArenaScope arenaScope(useArena);
+      QueryProfile* profile = QueryProfile::current();
+      int64_t start = profile == NULL ? 0 : Misc::currentTimeMicros();
       BitSet* bits = NULL;
       SimpleFilteredCollector* fc = NULL; 
 
@@ -328,9 +408,15 @@ CL_NS_DEF(search)
           bits = filter->bits(reader, sim == NULL ? getSimilarity() : sim);
           fc = _CLNEW SimpleFilteredCollector(bits, results);
        }
+      if ( profile != NULL )
+          profile->phaseDone(QueryProfile::SCORER, start);
 
       Weight* weight = query->weight(this, sim == NULL ? getSimilarity() : sim);
-      Scorer* scorer = weight->scorer(reader);
+      if ( profile != NULL )
+          start = Misc::currentTimeMicros();
+      Scorer* scorer = QueryProfile::scorer(weight, reader);
+      if ( profile != NULL )
+          profile->phaseDone(QueryProfile::SCORER, start);
       if (scorer != NULL) {
 		  if (fc == NULL){
               scorer->score(results);
@@ -374,6 +460,29 @@ CL_NS_DEF(search)
         _CLDELETE(weight);
     }
 
+	void IndexSearcher::setQueryResultCache(QueryResultCache* cache){
+		resultCache = cache;
+	}
+	QueryResultCache* IndexSearcher::getQueryResultCache() const{
+		return resultCache;
+	}
+
+	void IndexSearcher::setUseArena(bool useArena){
+		this->useArena = useArena;
+	}
+	bool IndexSearcher::getUseArena() const{
+		return useArena;
+	}
+
+	TopDocs* IndexSearcher::_search(Query* query, Similarity* similarity, Filter* filter, const int32_t nDocs, QueryProfile& profile){
+		profile.begin();
+		TopDocs* ret = NULL;
+		try{
+			ret = _search(query, similarity, filter, nDocs);
+		}_CLFINALLY(profile.end());
+		return ret;
+	}
+
 	CL_NS(index)::IndexReader* IndexSearcher::getReader(){
 		return reader;
 	}
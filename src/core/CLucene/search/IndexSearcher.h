@@ -20,6 +20,8 @@ CL_CLASS_DEF(search,Filter)
 CL_CLASS_DEF(search,Sort)
 CL_CLASS_DEF(search,HitCollector)
 CL_CLASS_DEF(search,Explanation)
+CL_CLASS_DEF(search,QueryResultCache)
+CL_CLASS_DEF(search,QueryProfile)
 CL_CLASS_DEF(index,IndexReader)
 //#include "CLucene/index/IndexReader.h"
 //#include "CLucene/util/BitSet.h"
@@ -35,6 +37,8 @@ CL_NS_DEF(search)
 class CLUCENE_EXPORT IndexSearcher:public Searcher{
 	CL_NS(index)::IndexReader* reader;
 	bool readerOwner;
+	QueryResultCache* resultCache;
+	bool useArena;
 
 public:
 	/** Creates a searcher searching the index in the named directory.
@@ -75,6 +79,35 @@ public:
 
 	void _search(Query* query, Similarity* similarity, Filter* filter, HitCollector* results);
 
+	/** Expert: Answers the top-N searches of this searcher from <code>cache</code>
+	* and stores their results in it. Searches with a HitCollector or a Filter,
+	* and searches with a Similarity other than the default, are never cached.
+	* The cache is not owned by the searcher and may be shared between searchers.
+	* Pass NULL (the default) to disable caching.
+	* @see QueryResultCache
+	*/
+	void setQueryResultCache(QueryResultCache* cache);
+	/** Expert: Returns the cache set by {@link #setQueryResultCache}, or NULL */
+	QueryResultCache* getQueryResultCache() const;
+
+	/** Expert: Allocates the weights, scorers, term docs and phrase positions
+	* of each search from a CL_NS(util)::Arena that is released when the search
+	* ends, instead of allocating them one by one from the heap. This pays off
+	* for queries that expand to many terms. Off by default, and has no effect
+	* unless CLucene was compiled with LUCENE_ENABLE_ARENA.
+	*/
+	void setUseArena(bool useArena);
+	/** Expert: Returns true if searches allocate from an arena */
+	bool getUseArena() const;
+
+	/** Expert: Like {@link #_search(Query*,Similarity*,Filter*,int32_t)}, and
+	* records in <code>profile</code> where the time of the search went: the
+	* time of each phase and a tree of counters per node of the rewritten
+	* query. The search bypasses the QueryResultCache.
+	* @see QueryProfile
+	*/
+	TopDocs* _search(Query* query, Similarity* similarity, Filter* filter, const int32_t nDocs, QueryProfile& profile);
+
 	CL_NS(index)::IndexReader* getReader();
 
 	Query* rewrite(Query* original);
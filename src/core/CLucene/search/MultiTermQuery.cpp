@@ -9,6 +9,7 @@
 #include "BooleanQuery.h"
 #include "FilteredTermEnum.h"
 #include "TermQuery.h"
+#include "QueryProfile.h"
 #include "CLucene/index/Term.h"
 #include "CLucene/util/StringBuffer.h"
 
@@ -74,9 +75,11 @@ CL_NS_DEF(search)
 				Query* ret = c->getQuery();
 
 				_CLDELETE(query);
+				QueryProfile::termsExpanded(ret, 1);
 				return ret;
             }
         }
+		QueryProfile::termsExpanded(query, (int32_t)query->getClauseCount());
 		return query;
 	}
 	
@@ -24,6 +24,12 @@ PhrasePositions::PhrasePositions(TermPositions* t, const int32_t OffSet) {
       position = 0;
       count    = 0;
 	  doc      = 0;
+      repeats  = false;
+
+      positions       = NULL;
+      positionsLength = 0;
+      positionsSize   = 0;
+      positionIndex   = 0;
 
       _next     = NULL;
   }
@@ -36,6 +42,7 @@ PhrasePositions::PhrasePositions(TermPositions* t, const int32_t OffSet) {
     //delete next Phrase position and by doing that
     //all PhrasePositions in the list
     _CLDELETE(_next);
+    _CLDELETE_LARRAY(positions);
 
     //Check if tp is valid
     if ( tp != NULL ){
@@ -85,22 +92,43 @@ PhrasePositions::PhrasePositions(TermPositions* t, const int32_t OffSet) {
 
       CND_PRECONDITION(tp != NULL,"tp is NULL");
 
-      //read first pos
-      count = tp->freq();				  
+      //decode all positions of this doc
+      loadPositions();
       //Move to the next TermPosition
 	  nextPosition();
   }
 
-  bool PhrasePositions::nextPosition(){
-  //Func - Move to the next position
+  void PhrasePositions::loadPositions(){
+  //Func - Decode all positions of the current document
   //Pre  - tp != NULL
-  //Post -
+  //Post - positions[0..positionsLength) holds the positions minus offset,
+  //       count == positionsLength and positionIndex == 0
 
       CND_PRECONDITION(tp != NULL,"tp is NULL");
 
+      const int32_t freq = tp->freq();
+      if ( freq > positionsSize ){
+          _CLDELETE_LARRAY(positions);
+          //grow geometrically, so that a few frequent docs settle the size
+          positionsSize = cl_max(freq, positionsSize * 2);
+          positions = _CL_NEWARRAY(int32_t, positionsSize);
+      }
+      for ( int32_t i = 0; i < freq; i++ )
+          positions[i] = tp->nextPosition() - offset;
+
+      positionsLength = freq;
+      positionIndex = 0;
+      count = freq;
+  }
+
+  bool PhrasePositions::nextPosition(){
+  //Func - Move to the next position
+  //Pre  - loadPositions() has been called for the current doc
+  //Post -
+
       if (count-- > 0) {				  
-		  //read subsequent pos's
-          position = tp->nextPosition() - offset;
+		  //read subsequent pos's from the decoded block
+          position = positions[positionIndex++];
 
 		  //Check position always bigger than or equal to 0
           //bvk: todo, bug??? position < 0 occurs, cant figure out why,
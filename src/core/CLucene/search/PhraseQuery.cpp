@@ -373,6 +373,20 @@ void PhraseQuery::extractQueryTerms( QueryTermSet& termset ) const
 
     ValueArray<int32_t> positions;
 	parentQuery->getPositions(positions);
+
+	// order the terms rarest first: the scorer lets the first term propose
+	// candidate docs, so the fewer docs it has the fewer skipTo's are wasted.
+	// The offsets travel along, so matching is not affected by the order.
+	int32_t* docFreqs = _CL_NEWARRAY(int32_t,tpsLength);
+	for (int32_t i = 0; i < tpsLength; i++) {
+		docFreqs[i] = reader->docFreq((*parentQuery->terms)[i]);
+		for (int32_t j = i; j > 0 && docFreqs[j] < docFreqs[j-1]; j--) {
+			int32_t df = docFreqs[j]; docFreqs[j] = docFreqs[j-1]; docFreqs[j-1] = df;
+			TermPositions* tp = tps[j]; tps[j] = tps[j-1]; tps[j-1] = tp;
+			int32_t pos = positions[j]; positions[j] = positions[j-1]; positions[j-1] = pos;
+		}
+	}
+	_CLDELETE_LARRAY(docFreqs);
 	int32_t slop = parentQuery->getSlop();
 	if ( slop != 0)
 		 // optimize exact case
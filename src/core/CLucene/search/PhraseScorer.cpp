@@ -22,7 +22,7 @@ CL_NS_DEF(search)
 	PhraseScorer::PhraseScorer(Weight* _weight, TermPositions** tps, 
 		int32_t* offsets, Similarity* similarity, uint8_t* _norms):
 		Scorer(similarity), weight(_weight), norms(_norms), value(_weight->getValue()), firstTime(true), more(true), freq(0.0f),
-			first(NULL), last(NULL)
+			first(NULL), last(NULL), pps(NULL), ppsLength(0)
 	{
 	//Func - Constructor
 	//Pre  - tps != NULL and is an array of TermPositions
@@ -54,6 +54,12 @@ CL_NS_DEF(search)
 
 		pq = _CLNEW PhraseQueue(i); //i==tps.length
 		CND_CONDITION(pq != NULL,"Could not allocate memory for pq");
+
+		ppsLength = i;
+		pps = _CL_NEWARRAY(PhrasePositions*, ppsLength);
+		i = 0;
+		for (PhrasePositions* pp = first; pp != NULL; pp = pp->_next)
+			pps[i++] = pp;
 	}
 
 	PhraseScorer::~PhraseScorer() {
@@ -67,6 +73,7 @@ CL_NS_DEF(search)
 		//first, rather than the destructor of pq.
 		_CLLDELETE(first);
 		_CLLDELETE(pq);
+		_CLDELETE_LARRAY(pps); //the nodes are owned by the list above
 	}
 
 	bool PhraseScorer::next(){
@@ -74,7 +81,7 @@ CL_NS_DEF(search)
 			init();
 			firstTime = false;
 		} else if (more) {
-			more = last->next(); // trigger further scanning
+			more = pps[0]->next(); // trigger further scanning
 		}
 		return doNext();
 	}
@@ -82,19 +89,28 @@ CL_NS_DEF(search)
 	// next without initial increment
 	bool PhraseScorer::doNext() {
 		while (more) {
-			while (more && first->doc < last->doc) {      // find doc w/ all the terms
-				more = first->skipTo(last->doc);            // skip first upto last
-				firstToLast();                            // and move it to the end
+			// the rarest term proposes a candidate and all others are skipped to it
+			const int32_t target = pps[0]->doc;
+			int32_t i = 1;
+			for (; i < ppsLength; i++) {
+				PhrasePositions* pp = pps[i];
+				if (pp->doc < target && !(more = pp->skipTo(target)))
+					return false;                       // a term ran out
+				if (pp->doc > target)
+					break;                              // overshot: not all terms here
 			}
 
-			if (more) {
-				// found a doc with all of the terms
-				freq = phraseFreq();                      // check for phrase
-				if (freq == 0.0f)                         // no match
-					more = last->next();                     // trigger further scanning
-				else
-					return true;                            // found a match
+			if (i < ppsLength) {
+				more = pps[0]->skipTo(pps[i]->doc);     // skip rarest up to the overshoot
+				continue;
 			}
+
+			// found a doc with all of the terms
+			freq = phraseFreq();                      // check for phrase
+			if (freq == 0.0f)                         // no match
+				more = pps[0]->next();                  // trigger further scanning
+			else
+				return true;                            // found a match
 		}
 		return false;                                 // no more matches
 	}
@@ -107,26 +123,15 @@ CL_NS_DEF(search)
 
 	bool PhraseScorer::skipTo(int32_t target) {
 		firstTime = false;
-		for (PhrasePositions* pp = first; more && pp != NULL; pp = pp->_next) {
-			more = pp->skipTo(target);
+		for (int32_t i = 0; more && i < ppsLength; i++) {
+			more = pps[i]->skipTo(target);
 		}
-		if (more)
-			sort();                                     // re-sort
 		return doNext();
 	}
 
 	void PhraseScorer::init() {
-		for (PhrasePositions* pp = first; more && pp != NULL; pp = pp->_next) 
-			more = pp->next();
-		if(more)
-			sort();
-	}
-	  
-	void PhraseScorer::sort() {
-		pq->clear();
-		for (PhrasePositions* pp = first; pp != NULL; pp = pp->_next)
-			pq->put(pp);
-		pqToList();
+		for (int32_t i = 0; more && i < ppsLength; i++) 
+			more = pps[i]->next();
 	}
 
 	void PhraseScorer::pqToList(){
@@ -193,7 +198,7 @@ CL_NS_DEF(search)
 		while (next() && doc() < _doc){
 		}
 
-		float_t phraseFreq = (doc() == _doc) ? freq : 0.0f;
+		float_t phraseFreq = (more && doc() == _doc) ? freq : 0.0f;
 		tfExplanation->setValue(getSimilarity()->tf(phraseFreq));
 
 		StringBuffer buf;
@@ -13,6 +13,7 @@
 #include "BooleanClause.h"
 #include "BooleanQuery.h"
 #include "TermQuery.h"
+#include "QueryProfile.h"
 #include "CLucene/util/BitSet.h"
 #include "CLucene/util/StringBuffer.h"
 
@@ -144,10 +145,12 @@ CL_NS_DEF(search)
 			Query* ret = c->getQuery();
 
 			_CLDELETE(query);
+			QueryProfile::termsExpanded(ret, 1);
 			return ret;
         }
 	}
 
+    QueryProfile::termsExpanded(query, (int32_t)query->getClauseCount());
     return query;
   }
 
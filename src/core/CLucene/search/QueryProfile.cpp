@@ -0,0 +1,368 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "QueryProfile.h"
+#include "SearchHeader.h"
+#include "Scorer.h"
+#include "Query.h"
+#include "CLucene/util/StringBuffer.h"
+#include "CLucene/util/Misc.h"
+#include "CLucene/util/_ProfileHook.h"
+
+CL_NS_USE(index)
+CL_NS_USE(util)
+CL_NS_DEF(search)
+
+/**
+* Reports the lookups and reads of the index and store code, while the
+* profile is current. QueryProfile is the only ProfileHook, so the current
+* hook of a thread is the hook of its current profile.
+*/
+class QueryProfile::Hook: public ProfileHook{
+public:
+	QueryProfile* profile;
+	Hook(QueryProfile* profile):
+		profile(profile)
+	{
+	}
+	void termLookup(int64_t micros){
+		profile->termLookup(micros);
+	}
+	void bytesRead(int64_t bytes){
+		profile->bytes += bytes;
+		if ( profile->currentNode != NULL )
+			profile->currentNode->bytesRead += bytes;
+	}
+};
+
+
+/** Counts the hits of a scorer and, for the top level scorer, times their collection */
+class ProfiledCollector: public HitCollector{
+	HitCollector* results;
+	QueryProfile::Node* node;
+	QueryProfile* timed;	// the profile to add the collect time to, or NULL
+	int32_t skipDoc;		// a document that was already counted
+public:
+	ProfiledCollector(HitCollector* results, QueryProfile::Node* node, QueryProfile* timed, int32_t skipDoc):
+		results(results),
+		node(node),
+		timed(timed),
+		skipDoc(skipDoc)
+	{
+	}
+	bool collect(const int32_t doc, const float_t score){
+		if ( doc != skipDoc )
+			node->docsMatched++;
+		skipDoc = -1;
+		if ( timed == NULL )
+			return results->collect(doc, score);
+		int64_t start = Misc::currentTimeMicros();
+		bool ret = results->collect(doc, score);
+		timed->phaseMicros[QueryProfile::COLLECT] += Misc::currentTimeMicros() - start;
+		return ret;
+	}
+};
+
+/**
+* Counts the calls of a scorer for its node, and makes its node the current
+* one while the scorer works, so that lookups and reads are counted for it.
+*/
+class ProfiledScorer: public Scorer{
+	Scorer* scorer;
+	QueryProfile* profile;
+	QueryProfile::Node* node;
+
+	// times the scoring of the top level scorer
+	bool scoreAll(HitCollector* hc, const int32_t maxDoc, bool bounded){
+		const bool top = node == profile->root;
+		ProfiledCollector collector(hc, node, top ? profile : NULL, bounded ? scorer->doc() : -1);
+		int64_t start = top ? Misc::currentTimeMicros() : 0;
+		int64_t collected = profile->phaseMicros[QueryProfile::COLLECT];
+		bool ret = true;
+		QueryProfile::Node* prev = profile->enter(node);
+		try{
+			if ( bounded )
+				ret = scorer->score(&collector, maxDoc);
+			else
+				scorer->score(&collector);
+		}_CLFINALLY(profile->leave(prev));
+		if ( top ){
+			collected = profile->phaseMicros[QueryProfile::COLLECT] - collected;
+			profile->phaseMicros[QueryProfile::SCORE] += Misc::currentTimeMicros() - start - collected;
+		}
+		return ret;
+	}
+public:
+	ProfiledScorer(Scorer* scorer, QueryProfile* profile, QueryProfile::Node* node):
+		Scorer(scorer->getSimilarity()),
+		scorer(scorer),
+		profile(profile),
+		node(node)
+	{
+	}
+	~ProfiledScorer(){
+		_CLDELETE(scorer);
+	}
+
+	void score(HitCollector* hc){
+		scoreAll(hc, 0, false);
+	}
+	bool score(HitCollector* hc, const int32_t maxDoc){
+		return scoreAll(hc, maxDoc, true);
+	}
+	bool next(){
+		QueryProfile::Node* prev = profile->enter(node);
+		bool ret = scorer->next();
+		profile->leave(prev);
+		node->nextCalls++;
+		if ( ret )
+			node->docsMatched++;
+		return ret;
+	}
+	bool skipTo(int32_t target){
+		QueryProfile::Node* prev = profile->enter(node);
+		bool ret = scorer->skipTo(target);
+		profile->leave(prev);
+		node->skipToCalls++;
+		if ( ret )
+			node->docsMatched++;
+		return ret;
+	}
+	int32_t doc() const{
+		return scorer->doc();
+	}
+	float_t score(){
+		QueryProfile::Node* prev = profile->enter(node);
+		float_t ret = scorer->score();
+		profile->leave(prev);
+		return ret;
+	}
+	Explanation* explain(int32_t doc){
+		return scorer->explain(doc);
+	}
+	TCHAR* toString(){
+		return scorer->toString();
+	}
+};
+
+
+QueryProfile::Node::Node(const Query* q):
+	query(q->toString()),
+	queryClass(q->getObjectName()),
+	docsMatched(0),
+	nextCalls(0),
+	skipToCalls(0),
+	termsExpanded(0),
+	termLookups(0),
+	bytesRead(0)
+{
+}
+QueryProfile::Node::~Node(){
+	for ( size_t i=0;i<children.size();i++ )
+		_CLDELETE(children[i]);
+	_CLDELETE_LCARRAY(query);
+}
+const TCHAR* QueryProfile::Node::getQuery() const{
+	return query;
+}
+const char* QueryProfile::Node::getQueryClass() const{
+	return queryClass;
+}
+size_t QueryProfile::Node::getChildCount() const{
+	return children.size();
+}
+QueryProfile::Node* QueryProfile::Node::getChild(size_t i) const{
+	return children[i];
+}
+void QueryProfile::Node::addChild(Node* child){
+	children.push_back(child);
+}
+
+
+QueryProfile::QueryProfile():
+	hook(NULL),
+	previous(NULL),
+	root(NULL),
+	currentNode(NULL)
+{
+	clear();
+}
+QueryProfile::~QueryProfile(){
+	_CLDELETE(root);
+	_CLDELETE(hook);
+}
+
+void QueryProfile::clear(){
+	for ( int32_t i=0;i<PHASE_COUNT;i++ )
+		phaseMicros[i] = 0;
+	beginTime = 0;
+	totalMicros = 0;
+	termLookups = 0;
+	termLookupMicros = 0;
+	bytes = 0;
+	_CLDELETE(root);
+	currentNode = NULL;
+	expansions.clear();
+}
+
+void QueryProfile::begin(){
+	clear();
+	if ( hook == NULL )
+		hook = _CLNEW Hook(this);
+	previous = ProfileHook::setCurrent(hook);
+	beginTime = Misc::currentTimeMicros();
+}
+
+void QueryProfile::end(){
+	CND_PRECONDITION(current() == this, "profile is not the current profile");
+	totalMicros = Misc::currentTimeMicros() - beginTime;
+	ProfileHook::setCurrent(previous);
+	previous = NULL;
+	currentNode = NULL;
+}
+
+QueryProfile* QueryProfile::current(){
+	ProfileHook* ret = ProfileHook::current();
+	if ( ret == NULL )
+		return NULL;
+	return static_cast<Hook*>(ret)->profile;
+}
+
+int64_t QueryProfile::getPhaseMicros(Phase phase) const{
+	return phaseMicros[phase];
+}
+int64_t QueryProfile::getTotalMicros() const{
+	return totalMicros;
+}
+int32_t QueryProfile::getTermLookups() const{
+	return termLookups;
+}
+int64_t QueryProfile::getTermLookupMicros() const{
+	return termLookupMicros;
+}
+int64_t QueryProfile::getBytesRead() const{
+	return bytes;
+}
+QueryProfile::Node* QueryProfile::getRoot() const{
+	return root;
+}
+
+void QueryProfile::phaseDone(Phase phase, int64_t& start){
+	int64_t now = Misc::currentTimeMicros();
+	phaseMicros[phase] += now - start;
+	start = now;
+}
+
+QueryProfile::Node* QueryProfile::enter(Node* node){
+	Node* ret = currentNode;
+	currentNode = node;
+	return ret;
+}
+void QueryProfile::leave(Node* prev){
+	currentNode = prev;
+}
+
+Scorer* QueryProfile::scorer(Weight* weight, IndexReader* reader){
+	QueryProfile* profile = current();
+	if ( profile == NULL )
+		return weight->scorer(reader);
+
+	Query* query = weight->getQuery();
+	Node* node = _CLNEW Node(query);
+	std::map<const Query*, int32_t>::iterator itr = profile->expansions.find(query);
+	if ( itr != profile->expansions.end() )
+		node->termsExpanded = itr->second;
+	if ( profile->currentNode != NULL )
+		profile->currentNode->addChild(node);
+	else{
+		_CLDELETE(profile->root); // a second search with the same profile
+		profile->root = node;
+	}
+
+	Scorer* ret;
+	Node* prev = profile->enter(node);
+	try{
+		ret = weight->scorer(reader);
+	}_CLFINALLY(profile->leave(prev));
+	if ( ret == NULL )
+		return NULL;
+	return _CLNEW ProfiledScorer(ret, profile, node);
+}
+
+void QueryProfile::termsExpanded(const Query* query, int32_t terms){
+	QueryProfile* profile = current();
+	if ( profile != NULL )
+		profile->expansions[query] = terms;
+}
+
+void QueryProfile::termLookup(int64_t micros){
+	termLookups++;
+	termLookupMicros += micros;
+	if ( currentNode != NULL )
+		currentNode->termLookups++;
+}
+
+void QueryProfile::bytesRead(int64_t bytes){
+	ProfileHook::recordBytesRead(bytes);
+}
+
+static const TCHAR* phaseNames[] = {
+	_T("rewrite"), _T("weight"), _T("scorer"), _T("score"), _T("collect")
+};
+
+TCHAR* QueryProfile::toString() const{
+	StringBuffer buf;
+	buf.append(_T("total: "));
+	buf.appendInt(totalMicros);
+	buf.append(_T("us"));
+	for ( int32_t i=0;i<PHASE_COUNT;i++ ){
+		buf.append(_T(", "));
+		buf.append(phaseNames[i]);
+		buf.append(_T(": "));
+		buf.appendInt(phaseMicros[i]);
+		buf.append(_T("us"));
+	}
+	buf.append(_T("\nterm lookups: "));
+	buf.appendInt(termLookups);
+	buf.append(_T(" in "));
+	buf.appendInt(termLookupMicros);
+	buf.append(_T("us, bytes read: "));
+	buf.appendInt(bytes);
+	buf.appendChar(_T('\n'));
+	if ( root != NULL )
+		toString(buf, root, 0);
+	return buf.toString();
+}
+
+void QueryProfile::toString(StringBuffer& buf, const Node* node, int32_t depth) const{
+	for ( int32_t i=0;i<depth;i++ )
+		buf.append(_T("  "));
+	buf.append(node->getQuery());
+	buf.append(_T(" ["));
+	TCHAR name[64];
+	STRCPY_AtoT(name, node->getQueryClass(), 64);
+	buf.append(name);
+	buf.append(_T("] matched: "));
+	buf.appendInt(node->docsMatched);
+	buf.append(_T(", next: "));
+	buf.appendInt(node->nextCalls);
+	buf.append(_T(", skipTo: "));
+	buf.appendInt(node->skipToCalls);
+	if ( node->termsExpanded > 0 ){
+		buf.append(_T(", terms: "));
+		buf.appendInt(node->termsExpanded);
+	}
+	buf.append(_T(", lookups: "));
+	buf.appendInt(node->termLookups);
+	buf.append(_T(", bytes: "));
+	buf.appendInt(node->bytesRead);
+	buf.appendChar(_T('\n'));
+	for ( size_t i=0;i<node->getChildCount();i++ )
+		toString(buf, node->getChild(i), depth + 1);
+}
+
+CL_NS_END
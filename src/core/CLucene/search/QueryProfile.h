@@ -0,0 +1,155 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_QueryProfile_
+#define _lucene_search_QueryProfile_
+
+#include "CLucene/LuceneThreads.h"
+#include <vector>
+#include <map>
+
+CL_CLASS_DEF(index,IndexReader)
+CL_CLASS_DEF(util,StringBuffer)
+CL_CLASS_DEF(util,ProfileHook)
+
+CL_NS_DEF(search)
+
+class Query;
+class Weight;
+class Scorer;
+
+/**
+* Expert: where the time of a search went.
+*
+* <p>Pass a QueryProfile to {@link IndexSearcher#_search(Query*,Similarity*,Filter*,int32_t,QueryProfile&)}
+* to record the wall time of each phase of the search, and a tree of counters
+* that follows the scorers of the rewritten query: how many documents each
+* node matched, how often it was advanced with next() and skipTo(), how many
+* terms a multi term query expanded to, and the term dictionary lookups and
+* bytes read while that node was doing work.</p>
+*
+* <p>The profile is collected in the thread that searches, between
+* {@link #begin} and {@link #end}. Outside of a profiled search, the hooks
+* cost a single check and nothing is recorded. Profiling wraps each scorer and
+* times each collected hit, so a profiled search is slower than a normal one;
+* compare profiles with each other, not with unprofiled searches.</p>
+*
+* <p>Bytes are counted as buffers of buffered and RAM inputs are filled, memory
+* mapped inputs are not counted.</p>
+*/
+class CLUCENE_EXPORT QueryProfile: LUCENE_BASE{
+public:
+	/** The phases of a search */
+	enum Phase{
+		REWRITE=0,	///< rewriting the query, including expanding multi term queries
+		WEIGHT,		///< creating the weights, including the idf lookups
+		SCORER,		///< creating the scorers and the filter bits
+		SCORE,		///< iterating and scoring the matches, without collecting them
+		COLLECT,	///< collecting the hits
+		PHASE_COUNT
+	};
+
+	/** The counters of one node of the rewritten query */
+	class CLUCENE_EXPORT Node: LUCENE_BASE{
+		TCHAR* query;
+		const char* queryClass;
+		std::vector<Node*> children;
+	public:
+		int32_t docsMatched;	///< documents the scorer of this node returned
+		int32_t nextCalls;		///< calls of next() on its scorer
+		int32_t skipToCalls;	///< calls of skipTo() on its scorer
+		int32_t termsExpanded;	///< terms a multi term query was rewritten to, or 0
+		int32_t termLookups;	///< term dictionary lookups while this node was working
+		int64_t bytesRead;		///< bytes read while this node was working
+
+		Node(const Query* query);
+		~Node();
+
+		/** The query of this node, as a string */
+		const TCHAR* getQuery() const;
+		/** The class name of the query of this node */
+		const char* getQueryClass() const;
+
+		size_t getChildCount() const;
+		Node* getChild(size_t i) const;
+		void addChild(Node* child);
+	};
+
+	QueryProfile();
+	~QueryProfile();
+
+	/**
+	* Clears this profile and makes it current in the calling thread, until
+	* {@link #end} is called. Profiles nest: the previous profile is current
+	* again after end().
+	*/
+	void begin();
+	/** Stops recording; this profile must be the current one of the calling thread */
+	void end();
+
+	/** The profile current in the calling thread, or NULL */
+	static QueryProfile* current();
+
+	/** The wall time spent in a phase, in microseconds */
+	int64_t getPhaseMicros(Phase phase) const;
+	/** The wall time of the whole search, in microseconds */
+	int64_t getTotalMicros() const;
+	/** Term dictionary lookups of the whole search */
+	int32_t getTermLookups() const;
+	/** Time spent in term dictionary lookups, in microseconds */
+	int64_t getTermLookupMicros() const;
+	/** Bytes read by the whole search */
+	int64_t getBytesRead() const;
+
+	/** The node of the top level query, or NULL if no scorer was created */
+	Node* getRoot() const;
+
+	/** A readable, indented dump of the phases and the node tree */
+	TCHAR* toString() const;
+
+	/** Adds the time since start to phase, and sets start to now */
+	void phaseDone(Phase phase, int64_t& start);
+	/** Records a term dictionary lookup that took the given time */
+	void termLookup(int64_t micros);
+
+	/**
+	* Creates the scorer of weight. If a profile is current, the scorer is
+	* wrapped so that it counts for a node of the query of weight, below the
+	* node whose scorer is being created. Composite weights must create the
+	* scorers of their clauses through this method.
+	*/
+	static Scorer* scorer(Weight* weight, CL_NS(index)::IndexReader* reader);
+
+	/** Records that a multi term query was rewritten to query, with the given number of terms */
+	static void termsExpanded(const Query* query, int32_t terms);
+	/** Records bytes read from an index input */
+	static void bytesRead(int64_t bytes);
+
+private:
+	class Hook;
+	Hook* hook;				// reports the lookups and reads of the index and store code
+	CL_NS(util)::ProfileHook* previous;	// the hook that was current when this one began
+	int64_t phaseMicros[PHASE_COUNT];
+	int64_t beginTime;
+	int64_t totalMicros;
+	int32_t termLookups;
+	int64_t termLookupMicros;
+	int64_t bytes;
+	Node* root;
+	Node* currentNode;		// the node whose scorer is working
+	std::map<const Query*, int32_t> expansions;
+
+	void clear();
+	Node* enter(Node* node);
+	void leave(Node* previous);
+	void toString(CL_NS(util)::StringBuffer& buf, const Node* node, int32_t depth) const;
+	friend class ProfiledScorer;
+	friend class ProfiledCollector;
+	friend class Hook;
+};
+
+CL_NS_END
+#endif
@@ -0,0 +1,414 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "QueryResultCache.h"
+#include "SearchHeader.h"
+#include "Query.h"
+#include "Sort.h"
+#include "FieldDoc.h"
+#include "Similarity.h"
+#include "_FieldDocSortedHitQueue.h"
+#include "CLucene/index/IndexReader.h"
+#include "CLucene/util/Equators.h"
+#include "CLucene/util/Misc.h"
+
+#include <list>
+#include <map>
+#include <set>
+
+CL_NS_USE(index)
+CL_NS_USE(util)
+CL_NS_DEF(search)
+
+//rough cost of a cached query clone and the bookkeeping around an entry
+#define QUERY_RESULT_CACHE_ENTRY_OVERHEAD 256
+
+class QueryResultCacheEntry: LUCENE_BASE{
+public:
+	IndexReader* reader;
+	Query* query;
+	int32_t nDocs;
+	TCHAR* sort;        //Sort::toString() of the sort, NULL for relevance
+	int32_t modificationCount;	//of the reader, at the time the result was stored
+	size_t hash;
+	size_t bytes;
+	TopDocs* docs;      //a TopFieldDocs if sort != NULL
+
+	QueryResultCacheEntry():
+		reader(NULL),query(NULL),nDocs(0),sort(NULL),
+		modificationCount(0),hash(0),bytes(0),docs(NULL)
+	{
+	}
+	~QueryResultCacheEntry(){
+		_CLLDELETE(query);
+		_CLDELETE_CARRAY(sort);
+		_CLLDELETE(docs);
+	}
+	bool matches(IndexReader* r, Query* q, int32_t n, const TCHAR* s) const{
+		if ( reader != r || nDocs != n )
+			return false;
+		if ( sort == NULL || s == NULL )
+			return sort == s && query->equals(q);
+		return _tcscmp(sort,s) == 0 && query->equals(q);
+	}
+};
+
+struct QueryResultCache::Internal{
+	typedef std::list<QueryResultCacheEntry*> LruList;
+	typedef std::multimap<size_t, LruList::iterator> IndexMap;
+
+	LruList lru;            //most recently used first
+	IndexMap index;
+	size_t maxBytes;
+	size_t bytes;
+	int64_t hits;
+	int64_t misses;
+	int64_t evictions;
+	DEFINE_MUTEX(cache_LOCK)
+
+	Internal(size_t _maxBytes):
+		maxBytes(_maxBytes),bytes(0),hits(0),misses(0),evictions(0)
+	{
+	}
+	~Internal(){
+		for ( LruList::iterator itr = lru.begin(); itr != lru.end(); ++itr )
+			_CLLDELETE(*itr);
+	}
+
+	static size_t hashKey(IndexReader* reader, Query* query, int32_t nDocs, const TCHAR* sort){
+		size_t h = query->hashCode();
+		h = 31 * h + (size_t)reader;
+		h = 31 * h + (size_t)nDocs;
+		if ( sort != NULL )
+			h = 31 * h + Misc::thashCode(sort);
+		return h;
+	}
+
+	void remove(IndexMap::iterator pos){
+		LruList::iterator entry = pos->second;
+		bytes -= (*entry)->bytes;
+		_CLLDELETE(*entry);
+		lru.erase(entry);
+		index.erase(pos);
+	}
+
+	void remove(LruList::iterator entry){
+		std::pair<IndexMap::iterator,IndexMap::iterator> range = index.equal_range((*entry)->hash);
+		for ( IndexMap::iterator itr = range.first; itr != range.second; ++itr ){
+			if ( itr->second == entry ){
+				remove(itr);
+				return;
+			}
+		}
+	}
+
+	void evict(){
+		while ( bytes > maxBytes && !lru.empty() ){
+			LruList::iterator oldest = lru.end();
+			--oldest;
+			remove(oldest);
+			evictions++;
+		}
+	}
+
+	//returns the live entry for the key and marks it as recently used.
+	//modificationCount is that of the reader, read by the caller before it
+	//took cache_LOCK
+	QueryResultCacheEntry* find(IndexReader* reader, int32_t modificationCount, Query* query, int32_t nDocs, const TCHAR* sort){
+		size_t h = hashKey(reader,query,nDocs,sort);
+		std::pair<IndexMap::iterator,IndexMap::iterator> range = index.equal_range(h);
+		for ( IndexMap::iterator itr = range.first; itr != range.second; ++itr ){
+			QueryResultCacheEntry* entry = *itr->second;
+			if ( !entry->matches(reader,query,nDocs,sort) )
+				continue;
+			if ( entry->modificationCount != modificationCount ){
+				//documents were deleted or undeleted, or norms were set,
+				//through this reader since the result was stored
+				remove(itr);
+				break;
+			}
+			lru.splice(lru.begin(), lru, itr->second);
+			hits++;
+			return entry;
+		}
+		misses++;
+		return NULL;
+	}
+
+	void add(QueryResultCacheEntry* entry){
+		//replace a result that was stored concurrently for the same key
+		std::pair<IndexMap::iterator,IndexMap::iterator> range = index.equal_range(entry->hash);
+		for ( IndexMap::iterator itr = range.first; itr != range.second; ++itr ){
+			if ( (*itr->second)->matches(entry->reader,entry->query,entry->nDocs,entry->sort) ){
+				remove(itr);
+				break;
+			}
+		}
+		if ( entry->bytes > maxBytes ){
+			_CLLDELETE(entry);
+			return;
+		}
+		lru.push_front(entry);
+		index.insert(std::pair<const size_t, LruList::iterator>(entry->hash, lru.begin()));
+		bytes += entry->bytes;
+		evict();
+	}
+
+	void invalidate(IndexReader* reader){
+		LruList::iterator itr = lru.begin();
+		while ( itr != lru.end() ){
+			LruList::iterator cur = itr++;
+			if ( (*cur)->reader == reader )
+				remove(cur);
+		}
+	}
+};
+
+//The caches that stored results of each reader. A reader keeps one parameter
+//per close callback, so the callback is registered with a NULL parameter and
+//looks the caches of the closed reader up here. Lock order: the lock of the
+//reader (held while it runs its close callbacks), REGISTRY_LOCK, cache_LOCK.
+typedef std::map<IndexReader*, std::set<QueryResultCache*> > QueryResultCacheRegistry;
+static QueryResultCacheRegistry queryResultCacheRegistry;
+STATIC_DEFINE_MUTEX(REGISTRY_LOCK)
+
+//copies a sort value, returns NULL for values of custom comparators
+static Comparable* copySortValue(Comparable* value){
+	if ( value->instanceOf(Compare::Int32::getClassName()) )
+		return _CLNEW Compare::Int32(static_cast<Compare::Int32*>(value)->getValue());
+	if ( value->instanceOf(Compare::Float::getClassName()) )
+		return _CLNEW Compare::Float(static_cast<Compare::Float*>(value)->getValue());
+	if ( value->instanceOf(Compare::TChar::getClassName()) )
+		//points into the FieldCache of the reader, which outlives our entries
+		return _CLNEW Compare::TChar(static_cast<Compare::TChar*>(value)->getValue());
+	return NULL;
+}
+
+static TopDocs* copyTopDocs(const TopDocs* docs){
+	ScoreDoc* scoreDocs = new ScoreDoc[docs->scoreDocsLength];
+	for ( int32_t i = 0; i < docs->scoreDocsLength; i++ )
+		scoreDocs[i] = docs->scoreDocs[i];
+	return _CLNEW TopDocs(docs->totalHits, scoreDocs, docs->scoreDocsLength);
+}
+
+//returns NULL if one of the sort values cannot be copied
+static TopFieldDocs* copyTopFieldDocs(const TopFieldDocs* docs){
+	int32_t len = docs->scoreDocsLength;
+	FieldDoc** fieldDocs = _CL_NEWARRAY(FieldDoc*,len);
+	int32_t copied = 0;
+	bool ok = true;
+	for ( ; ok && copied < len; copied++ ){
+		FieldDoc* src = docs->fieldDocs[copied];
+		Comparable** values = NULL;
+		if ( src->fields != NULL ){
+			int32_t n = 0;
+			while ( src->fields[n] != NULL )
+				n++;
+			values = _CL_NEWARRAY(Comparable*,n+1);
+			for ( int32_t i = 0; i < n; i++ ){
+				values[i] = copySortValue(src->fields[i]);
+				if ( values[i] == NULL ){
+					n = i;
+					ok = false;
+					break;
+				}
+			}
+			values[n] = NULL;
+		}
+		fieldDocs[copied] = _CLNEW FieldDoc(src->scoreDoc.doc, src->scoreDoc.score, values);
+	}
+	if ( !ok ){
+		for ( int32_t i = 0; i < copied; i++ )
+			_CLLDELETE(fieldDocs[i]);
+		_CLDELETE_LARRAY(fieldDocs);
+		return NULL;
+	}
+
+	SortField** fields = NULL;
+	if ( docs->fields != NULL ){
+		int32_t n = 0;
+		while ( docs->fields[n] != NULL )
+			n++;
+		fields = _CL_NEWARRAY(SortField*,n+1);
+		for ( int32_t i = 0; i < n; i++ )
+			fields[i] = docs->fields[i]->clone();
+		fields[n] = NULL;
+	}
+	TopFieldDocs* ret = _CLNEW TopFieldDocs(docs->totalHits, fieldDocs, len, fields);
+	//TopFieldDocs builds its own scoreDocs from the fieldDocs, keep the (possibly normalized) originals
+	for ( int32_t i = 0; i < len; i++ )
+		ret->scoreDocs[i] = docs->scoreDocs[i];
+	return ret;
+}
+
+static size_t sizeOfTopDocs(const TopDocs* docs, bool sorted){
+	size_t ret = sizeof(TopDocs) + docs->scoreDocsLength * sizeof(ScoreDoc);
+	if ( sorted ){
+		const TopFieldDocs* fdocs = static_cast<const TopFieldDocs*>(docs);
+		for ( int32_t i = 0; i < fdocs->scoreDocsLength; i++ ){
+			ret += sizeof(FieldDoc*) + sizeof(FieldDoc);
+			Comparable** values = fdocs->fieldDocs[i]->fields;
+			for ( int32_t j = 0; values != NULL && values[j] != NULL; j++ )
+				ret += sizeof(Comparable*) + sizeof(Compare::Int32);
+		}
+	}
+	return ret;
+}
+
+
+QueryResultCache::QueryResultCache(size_t maxBytes):
+	_internal(_CLNEW Internal(maxBytes))
+{
+}
+QueryResultCache::~QueryResultCache(){
+	{
+		//readers outliving us must not call back into a deleted cache
+		SCOPED_LOCK_MUTEX(REGISTRY_LOCK)
+		QueryResultCacheRegistry::iterator itr = queryResultCacheRegistry.begin();
+		while ( itr != queryResultCacheRegistry.end() ){
+			QueryResultCacheRegistry::iterator cur = itr++;
+			cur->second.erase(this);
+			if ( cur->second.empty() )
+				queryResultCacheRegistry.erase(cur);
+		}
+	}
+	_CLDELETE(_internal);
+}
+
+void QueryResultCache::closeCallback(IndexReader* reader, void* /*param*/){
+	SCOPED_LOCK_MUTEX(REGISTRY_LOCK)
+	QueryResultCacheRegistry::iterator itr = queryResultCacheRegistry.find(reader);
+	if ( itr == queryResultCacheRegistry.end() )
+		return;
+	for ( std::set<QueryResultCache*>::iterator cache = itr->second.begin(); cache != itr->second.end(); ++cache )
+		(*cache)->invalidate(reader);
+	queryResultCacheRegistry.erase(itr);
+}
+
+void QueryResultCache::registerReader(IndexReader* reader){
+	SCOPED_LOCK_MUTEX(REGISTRY_LOCK)
+	std::set<QueryResultCache*>& caches = queryResultCacheRegistry[reader];
+	if ( caches.empty() )
+		reader->addCloseCallback(QueryResultCache::closeCallback, NULL);
+	caches.insert(this);
+}
+
+bool QueryResultCache::isCacheable(Similarity* similarity, Filter* filter){
+	//filters and similarities have no identity beyond their address, which
+	//may be reused by another instance once they are deleted
+	return filter == NULL && (similarity == NULL || similarity == Similarity::getDefault());
+}
+
+TopDocs* QueryResultCache::get(IndexReader* reader, Query* query, Similarity* similarity, Filter* filter, const int32_t nDocs){
+	if ( !isCacheable(similarity, filter) )
+		return NULL;
+	const int32_t modificationCount = reader->getModificationCount();
+	SCOPED_LOCK_MUTEX(_internal->cache_LOCK)
+	QueryResultCacheEntry* entry = _internal->find(reader,modificationCount,query,nDocs,NULL);
+	return entry == NULL ? NULL : copyTopDocs(entry->docs);
+}
+
+TopFieldDocs* QueryResultCache::get(IndexReader* reader, Query* query, Similarity* similarity, Filter* filter, const int32_t nDocs, const Sort* sort){
+	if ( !isCacheable(similarity, filter) )
+		return NULL;
+	const int32_t modificationCount = reader->getModificationCount();
+	TCHAR* sortKey = sort->toString();
+	TopFieldDocs* ret = NULL;
+	{
+		SCOPED_LOCK_MUTEX(_internal->cache_LOCK)
+		QueryResultCacheEntry* entry = _internal->find(reader,modificationCount,query,nDocs,sortKey);
+		if ( entry != NULL )
+			ret = copyTopFieldDocs(static_cast<TopFieldDocs*>(entry->docs));
+	}
+	_CLDELETE_CARRAY(sortKey);
+	return ret;
+}
+
+void QueryResultCache::put(IndexReader* reader, Query* query, Similarity* similarity, Filter* filter, const int32_t nDocs, const TopDocs* docs){
+	if ( !isCacheable(similarity, filter) )
+		return;
+	QueryResultCacheEntry* entry = _CLNEW QueryResultCacheEntry;
+	entry->reader = reader;
+	entry->query = query->clone();
+	entry->nDocs = nDocs;
+	entry->modificationCount = reader->getModificationCount();
+	entry->hash = Internal::hashKey(reader,query,nDocs,NULL);
+	entry->docs = copyTopDocs(docs);
+	entry->bytes = QUERY_RESULT_CACHE_ENTRY_OVERHEAD + sizeOfTopDocs(docs, false);
+
+	registerReader(reader);
+	SCOPED_LOCK_MUTEX(_internal->cache_LOCK)
+	_internal->add(entry);
+}
+
+void QueryResultCache::put(IndexReader* reader, Query* query, Similarity* similarity, Filter* filter, const int32_t nDocs, const Sort* sort, const TopFieldDocs* docs){
+	if ( !isCacheable(similarity, filter) )
+		return;
+	TopFieldDocs* copy = copyTopFieldDocs(docs);
+	if ( copy == NULL )
+		return; //custom sort values can't be copied, so they are not cached
+
+	QueryResultCacheEntry* entry = _CLNEW QueryResultCacheEntry;
+	entry->reader = reader;
+	entry->query = query->clone();
+	entry->nDocs = nDocs;
+	entry->sort = sort->toString();
+	entry->modificationCount = reader->getModificationCount();
+	entry->hash = Internal::hashKey(reader,query,nDocs,entry->sort);
+	entry->docs = copy;
+	entry->bytes = QUERY_RESULT_CACHE_ENTRY_OVERHEAD + sizeOfTopDocs(docs, true);
+
+	registerReader(reader);
+	SCOPED_LOCK_MUTEX(_internal->cache_LOCK)
+	_internal->add(entry);
+}
+
+void QueryResultCache::invalidate(IndexReader* reader){
+	SCOPED_LOCK_MUTEX(_internal->cache_LOCK)
+	_internal->invalidate(reader);
+}
+
+void QueryResultCache::clear(){
+	SCOPED_LOCK_MUTEX(_internal->cache_LOCK)
+	while ( !_internal->lru.empty() )
+		_internal->remove(_internal->lru.begin());
+}
+
+void QueryResultCache::setMaxBytes(size_t maxBytes){
+	SCOPED_LOCK_MUTEX(_internal->cache_LOCK)
+	_internal->maxBytes = maxBytes;
+	_internal->evict();
+}
+size_t QueryResultCache::getMaxBytes() const{
+	return _internal->maxBytes;
+}
+size_t QueryResultCache::getBytes() const{
+	SCOPED_LOCK_MUTEX(_internal->cache_LOCK)
+	return _internal->bytes;
+}
+size_t QueryResultCache::size() const{
+	SCOPED_LOCK_MUTEX(_internal->cache_LOCK)
+	return _internal->lru.size();
+}
+int64_t QueryResultCache::getHitCount() const{
+	SCOPED_LOCK_MUTEX(_internal->cache_LOCK)
+	return _internal->hits;
+}
+int64_t QueryResultCache::getMissCount() const{
+	SCOPED_LOCK_MUTEX(_internal->cache_LOCK)
+	return _internal->misses;
+}
+int64_t QueryResultCache::getEvictionCount() const{
+	SCOPED_LOCK_MUTEX(_internal->cache_LOCK)
+	return _internal->evictions;
+}
+void QueryResultCache::resetCounters(){
+	SCOPED_LOCK_MUTEX(_internal->cache_LOCK)
+	_internal->hits = _internal->misses = _internal->evictions = 0;
+}
+
+CL_NS_END
@@ -0,0 +1,99 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_QueryResultCache_
+#define _lucene_search_QueryResultCache_
+
+CL_CLASS_DEF(index,IndexReader)
+
+CL_NS_DEF(search)
+
+class Query;
+class Filter;
+class Sort;
+class Similarity;
+class TopDocs;
+class TopFieldDocs;
+
+/**
+ * Expert: A cache of top-N results, shared by any number of IndexSearchers
+ * through {@link IndexSearcher#setQueryResultCache}.
+ *
+ * <p>Results are keyed by the IndexReader, the query (through
+ * {@link Query#hashCode()} and {@link Query#equals()}), the number of
+ * requested hits and the sort criteria. Only searches without a Filter that
+ * score with {@link Similarity#getDefault()} are cached: filters and
+ * similarities have no equals() in this port, and the address of a deleted
+ * instance may be reused by another one. Call {@link #clear()} after
+ * changing the default with {@link Similarity#setDefault()}.</p>
+ *
+ * <p>Entries of a reader are dropped when that reader is closed, so a
+ * searcher over the result of {@link IndexReader#reopen()} never sees results
+ * of the old reader. Entries are also dropped when documents were deleted
+ * or undeleted, or norms were set, through their reader since they were
+ * stored (see {@link IndexReader#getModificationCount()}). Any number of
+ * caches may hold results of the same reader.</p>
+ *
+ * <p>The cache is bounded by an approximate memory budget and evicts the
+ * least recently used results first. Sorted results are only cached when all
+ * their sort values are ints, floats or strings (i.e. no custom comparators).</p>
+ *
+ * <p>All methods are thread safe. Results are returned as copies, the caller
+ * owns them just like results returned by IndexSearcher::_search.</p>
+ */
+class CLUCENE_EXPORT QueryResultCache: LUCENE_BASE
+{
+	struct Internal;
+	Internal* _internal;
+	static void closeCallback(CL_NS(index)::IndexReader* reader, void* param);
+	//makes the close callback of reader invalidate this cache
+	void registerReader(CL_NS(index)::IndexReader* reader);
+	static bool isCacheable(Similarity* similarity, Filter* filter);
+public:
+	/**
+	* @param maxBytes approximate upper bound of the memory held by cached results
+	*/
+	QueryResultCache(size_t maxBytes=LUCENE_DEFAULT_QUERY_RESULT_CACHE_BYTES);
+	virtual ~QueryResultCache();
+
+	/** Returns a copy of the cached relevance sorted result or NULL if there is none
+	* or the search is not cached */
+	TopDocs* get(CL_NS(index)::IndexReader* reader, Query* query, Similarity* similarity, Filter* filter, const int32_t nDocs);
+	/** Returns a copy of the cached field sorted result or NULL if there is none */
+	TopFieldDocs* get(CL_NS(index)::IndexReader* reader, Query* query, Similarity* similarity, Filter* filter, const int32_t nDocs, const Sort* sort);
+
+	/** Stores a copy of <code>docs</code> unless the search is not cached; the
+	* caller keeps ownership of docs and query */
+	void put(CL_NS(index)::IndexReader* reader, Query* query, Similarity* similarity, Filter* filter, const int32_t nDocs, const TopDocs* docs);
+	/** Stores a copy of <code>docs</code>; the caller keeps ownership of docs, query and sort */
+	void put(CL_NS(index)::IndexReader* reader, Query* query, Similarity* similarity, Filter* filter, const int32_t nDocs, const Sort* sort, const TopFieldDocs* docs);
+
+	/** Drops all cached results of <code>reader</code> */
+	void invalidate(CL_NS(index)::IndexReader* reader);
+	/** Drops all cached results */
+	void clear();
+
+	/** Changes the memory budget, evicting results if necessary */
+	void setMaxBytes(size_t maxBytes);
+	size_t getMaxBytes() const;
+
+	/** Approximate memory held by the cached results */
+	size_t getBytes() const;
+	/** Number of cached results */
+	size_t size() const;
+
+	/** Number of lookups answered from the cache */
+	int64_t getHitCount() const;
+	/** Number of lookups that were not found in the cache */
+	int64_t getMissCount() const;
+	/** Number of results evicted to stay within the memory budget */
+	int64_t getEvictionCount() const;
+	/** Resets the hit, miss and eviction counters */
+	void resetCounters();
+};
+
+CL_NS_END
+#endif
@@ -11,6 +11,7 @@
 #include "Scorer.h"
 #include "BooleanQuery.h"
 #include "TermQuery.h"
+#include "QueryProfile.h"
 #include "Similarity.h"
 
 #include "CLucene/index/Term.h"
@@ -144,6 +145,7 @@ CL_NS_DEF(search)
 		enumerator->close();
 		_CLDELETE(enumerator);
 
+        QueryProfile::termsExpanded(query, (int32_t)query->getClauseCount());
         return query;
     }
 
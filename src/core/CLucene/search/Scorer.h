@@ -7,6 +7,7 @@
 #ifndef _lucene_search_Scorer_
 #define _lucene_search_Scorer_
 
+#include "CLucene/util/Arena.h"
 CL_CLASS_DEF(search,Similarity)
 CL_CLASS_DEF(search,HitCollector)
 CL_CLASS_DEF(search,Explanation)
@@ -38,6 +39,7 @@ protected:
 
 public:
 	virtual ~Scorer();
+	LUCENE_ARENA_ALLOCATED
 
 	/** Returns the Similarity implementation used by this scorer. */
 	Similarity* getSimilarity()  const;
@@ -12,6 +12,9 @@
 #include "Searchable.h"
 #include "Hits.h"
 #include "_FieldDocSortedHitQueue.h"
+#include "_HitQueue.h"
+#include "QueryProfile.h"
+#include "CLucene/util/Misc.h"
 #include <assert.h>
 
 CL_NS_USE(index)
@@ -119,11 +122,17 @@ void Query::setBoost(float_t b) { boost = b; }
 float_t Query::getBoost() const { return boost; }
 
 Weight* Query::weight(Searcher* searcher, Similarity* similarity){
+    QueryProfile* profile = QueryProfile::current();
+    int64_t start = profile == NULL ? 0 : CL_NS(util)::Misc::currentTimeMicros();
     Query* query = searcher->rewrite(this);
+    if ( profile != NULL )
+        profile->phaseDone(QueryProfile::REWRITE, start);
     Weight* weight = query->_createWeight(searcher, similarity);
     float_t sum = weight->sumOfSquaredWeights();
     float_t norm = similarity->queryNorm(sum);
     weight->normalize(norm);
+    if ( profile != NULL )
+        profile->phaseDone(QueryProfile::WEIGHT, start);
     return weight;
 }
 
@@ -202,6 +211,51 @@ void Searcher::_search(Query* query, Similarity* sim, HitCollector* results) {
 	_search(query, sim == NULL ? similarity : sim, NULL, results);
 }
 
+/** Collects the best hits ranking after a given ScoreDoc into a bounded HitQueue */
+class TopDocsAfterCollector: public HitCollector{
+	const ScoreDoc* after;
+	HitQueue* hq;
+	size_t nDocs;
+	int32_t totalHits;
+public:
+	TopDocsAfterCollector(const ScoreDoc* _after, HitQueue* _hq, size_t _nDocs):
+		after(_after),
+		hq(_hq),
+		nDocs(_nDocs),
+		totalHits(0)
+	{
+	}
+	bool collect(const int32_t doc, const float_t score){
+		if ( score <= 0.0f ) // ignore zeroed buckets
+			return true;
+		++totalHits;
+		if ( after != NULL &&
+			( score > after->score || (score == after->score && doc <= after->doc) ) )
+			return true; // already returned on an earlier page
+		if ( hq->size() < nDocs || score >= hq->top().score ){
+			ScoreDoc sd = {doc, score};
+			hq->insert(sd);
+		}
+		return true;
+	}
+	int32_t getTotalHits() const{ return totalHits; }
+};
+
+TopDocs* Searcher::searchAfter(const ScoreDoc* after, Query* query, Similarity* sim, Filter* filter, const int32_t nDocs){
+	CND_PRECONDITION(query != NULL, "query is NULL");
+	CND_PRECONDITION(nDocs > 0, "nDocs must be positive");
+
+	HitQueue hq(nDocs);
+	TopDocsAfterCollector collector(after, &hq, nDocs);
+	_search(query, sim == NULL ? similarity : sim, filter, &collector);
+
+	int32_t scoreDocsLength = hq.size();
+	ScoreDoc* scoreDocs = new ScoreDoc[scoreDocsLength];
+	for (int32_t i = scoreDocsLength-1; i >= 0; --i) // put docs in array
+		scoreDocs[i] = hq.pop();
+	return _CLNEW TopDocs(collector.getTotalHits(), scoreDocs, scoreDocsLength);
+}
+
 void Searcher::setSimilarity(Similarity* similarity) {
 	this->similarity = similarity;
 }
@@ -7,6 +7,7 @@
 #ifndef _lucene_search_SearchHeader_
 #define _lucene_search_SearchHeader_
 
+#include "CLucene/util/Arena.h"
 
 //#include "CLucene/index/IndexReader.h"
 CL_CLASS_DEF(index,Term)
@@ -113,6 +114,7 @@ CL_NS_DEF(search)
     {
     public:
 		virtual ~Weight();
+		LUCENE_ARENA_ALLOCATED
 
       /** The query that this concerns. */
       virtual Query* getQuery() = 0;
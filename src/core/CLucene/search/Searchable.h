@@ -30,6 +30,7 @@ CL_NS_DEF(search)
 	class Similarity;
 	class TopFieldDocs;
 	class Sort;
+	struct ScoreDoc;
 	
 
    /** The interface for search implementations.
@@ -161,6 +162,24 @@ CL_NS_DEF(search)
 		*/
 		void _search(Query* query, Similarity* sim, HitCollector* results);
 
+		/** Returns the page of at most <code>nDocs</code> hits that directly follows
+		* <code>after</code> in relevance order, i.e. the best hits scoring lower
+		* than <code>after</code> or scoring the same with a higher document number.
+		* Pass NULL for <code>after</code> to get the first page, then the last
+		* ScoreDoc of each page to get the next one.
+		*
+		* <p>Unlike {@link Hits}, every page is a single pass over the matching
+		* documents with a heap bounded by <code>nDocs</code>, so the cost of a
+		* page does not grow with its depth and no search is repeated behind
+		* the caller's back. Scores are raw, just like those of
+		* {@link #_search(Query*,Similarity*,Filter*,int32_t)}, and
+		* <code>totalHits</code> counts all matching documents.
+		*
+		* <p>Pages are only consistent with each other while the index does not
+		* change. The caller owns the returned TopDocs.
+		*/
+		TopDocs* searchAfter(const ScoreDoc* after, Query* query, Similarity* sim, Filter* filter, const int32_t nDocs);
+
 		/** Expert: Set the Similarity implementation used by this Searcher.
 		*
 		* @see Similarity#setDefault(Similarity)
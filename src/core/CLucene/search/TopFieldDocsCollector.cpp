@@ -0,0 +1,262 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "_TopFieldDocsCollector.h"
+#include "_FieldDocSortedHitQueue.h"
+#include "Sort.h"
+#include "FieldCache.h"
+#include "CLucene/index/IndexReader.h"
+#include "CLucene/util/BitSet.h"
+#include "CLucene/util/Equators.h"
+
+CL_NS_USE(index)
+CL_NS_USE(util)
+CL_NS_DEF(search)
+
+TopFieldDocsCollector::TopFieldDocsCollector(){
+}
+TopFieldDocsCollector::~TopFieldDocsCollector(){
+}
+
+/**
+* The collector for one sort key type: int32_t for INT fields and for the
+* ordinals of STRING fields, float_t for FLOAT fields.
+*/
+template<typename T>
+class SingleFieldTopDocsCollector: public TopFieldDocsCollector{
+public:
+	struct Entry{
+		T key;
+		float_t score;
+		int32_t doc;
+	};
+private:
+	const T* keys;
+	const FieldCache::StringIndex* stringIndex; //set if keys are string ordinals
+	bool reverse;
+	int32_t tieType;    //SortField::DOCSCORE, SortField::DOC or -1 for none
+	bool tieReverse;
+	const BitSet* bits;
+	Entry* heap;        //1-based, heap[1] is the weakest hit
+	size_t _size;
+	size_t maxSize;
+	int32_t totalHits;
+	float_t maxscore;
+	SortField** fields;
+
+	/** true if a sorts after b, same semantics as FieldSortedHitQueue::lessThan */
+	inline bool lessThan(const Entry& a, const Entry& b) const{
+		int32_t c = 0;
+		if ( a.key < b.key ) c = -1;
+		else if ( a.key > b.key ) c = 1;
+		if ( reverse ) c = -c;
+		if ( c == 0 && tieType != -1 ){
+			if ( tieType == SortField::DOCSCORE ){
+				if ( a.score > b.score ) c = -1;
+				else if ( a.score < b.score ) c = 1;
+			}else{
+				if ( a.doc < b.doc ) c = -1;
+				else if ( a.doc > b.doc ) c = 1;
+			}
+			if ( tieReverse ) c = -c;
+		}
+		if ( c == 0 )
+			return a.doc > b.doc;
+		return c > 0;
+	}
+
+	void upHeap(){
+		size_t i = _size;
+		Entry node = heap[i];
+		size_t j = i >> 1;
+		while ( j > 0 && lessThan(node,heap[j]) ){
+			heap[i] = heap[j];
+			i = j;
+			j = j >> 1;
+		}
+		heap[i] = node;
+	}
+
+	void downHeap(){
+		size_t i = 1;
+		Entry node = heap[i];
+		size_t j = i << 1;
+		size_t k = j + 1;
+		if ( k <= _size && lessThan(heap[k], heap[j]) )
+			j = k;
+		while ( j <= _size && lessThan(heap[j],node) ){
+			heap[i] = heap[j];
+			i = j;
+			j = i << 1;
+			k = j + 1;
+			if ( k <= _size && lessThan(heap[k], heap[j]) )
+				j = k;
+		}
+		heap[i] = node;
+	}
+
+	static Comparable* sortValue(int32_t key, const FieldCache::StringIndex* stringIndex){
+		if ( stringIndex != NULL )
+			return _CLNEW Compare::TChar(stringIndex->lookup[key]);
+		return _CLNEW Compare::Int32(key);
+	}
+	static Comparable* sortValue(float_t key, const FieldCache::StringIndex* /*stringIndex*/){
+		return _CLNEW Compare::Float(key);
+	}
+
+public:
+	SingleFieldTopDocsCollector(const T* _keys, const FieldCache::StringIndex* _stringIndex, bool _reverse,
+			int32_t _tieType, bool _tieReverse, const BitSet* _bits, int32_t nDocs, SortField** _fields):
+		keys(_keys),
+		stringIndex(_stringIndex),
+		reverse(_reverse),
+		tieType(_tieType),
+		tieReverse(_tieReverse),
+		bits(_bits),
+		_size(0),
+		maxSize(nDocs > 0 ? nDocs : 0),
+		totalHits(0),
+		maxscore(1.0f),
+		fields(_fields)
+	{
+		heap = _CL_NEWARRAY(Entry, maxSize+1);
+	}
+	virtual ~SingleFieldTopDocsCollector(){
+		_CLDELETE_LARRAY(heap);
+		if ( fields != NULL ){
+			for ( int32_t i=0; fields[i]!=NULL; i++ )
+				_CLDELETE(fields[i]);
+			_CLDELETE_LARRAY(fields);
+		}
+	}
+
+	bool collect(const int32_t doc, const float_t score){
+		if ( score <= 0.0f ||			  // ignore zeroed buckets
+			(bits != NULL && !bits->get(doc)) )	  // skip docs not in bits
+			return true;
+		++totalHits;
+		if ( score > maxscore ) maxscore = score;
+
+		const T key = keys[doc];
+		if ( _size < maxSize ){
+			++_size;
+			heap[_size].key = key;
+			heap[_size].score = score;
+			heap[_size].doc = doc;
+			upHeap();
+		}else if ( _size > 0 ){
+			// the common case: the key alone says the hit is not competitive
+			if ( reverse ? key < heap[1].key : key > heap[1].key )
+				return true;
+			Entry e;
+			e.key = key;
+			e.score = score;
+			e.doc = doc;
+			if ( !lessThan(e, heap[1]) ){
+				heap[1] = e;
+				downHeap();
+			}
+		}
+		return true;
+	}
+
+	int32_t getTotalHits() const{
+		return totalHits;
+	}
+
+	TopFieldDocs* topDocs(){
+		// FieldSortedHitQueue only sees the scores of hits it compares, i.e. none
+		// if there was only one hit
+		float_t norm = totalHits > 1 ? maxscore : 1.0f;
+		int32_t len = (int32_t)_size;
+		int32_t nFields = tieType == -1 ? 1 : 2;
+		FieldDoc** fieldDocs = _CL_NEWARRAY(FieldDoc*,len);
+		for ( int32_t i = len-1; i >= 0; --i ){
+			Entry e = heap[1];
+			heap[1] = heap[_size];
+			--_size;
+			if ( _size > 0 )
+				downHeap();
+
+			Comparable** values = _CL_NEWARRAY(Comparable*,nFields+1);
+			values[0] = sortValue(e.key, stringIndex);
+			if ( tieType == SortField::DOCSCORE )
+				values[1] = _CLNEW Compare::Float(e.score);
+			else if ( tieType == SortField::DOC )
+				values[1] = _CLNEW Compare::Int32(e.doc);
+			values[nFields] = NULL;
+
+			float_t score = e.score;
+			if ( norm > 1.0f )
+				score /= norm;   // normalize scores
+			fieldDocs[i] = _CLNEW FieldDoc(e.doc, score, values);
+		}
+		SortField** ret = fields;
+		fields = NULL; //move ownership to TopFieldDocs
+		return _CLNEW TopFieldDocs(totalHits, fieldDocs, len, ret);
+	}
+};
+
+TopFieldDocsCollector* TopFieldDocsCollector::newInstance(IndexReader* reader, const Sort* sort,
+	const BitSet* bits, int32_t nDocs)
+{
+	SortField** sortFields = sort->getSort();
+	if ( sortFields == NULL || sortFields[0] == NULL )
+		return NULL;
+	SortField* primary = sortFields[0];
+	SortField* tie = sortFields[1];
+	if ( tie != NULL && sortFields[2] != NULL )
+		return NULL;
+	if ( tie != NULL && tie->getType() != SortField::DOCSCORE && tie->getType() != SortField::DOC )
+		return NULL;
+
+	int32_t type = primary->getType();
+	if ( type != SortField::AUTO && type != SortField::INT &&
+		 type != SortField::FLOAT && type != SortField::STRING )
+		return NULL;
+
+	const TCHAR* field = primary->getField();
+	if ( type == SortField::AUTO ){
+		FieldCacheAuto* fa = FieldCache::DEFAULT()->getAuto(reader, field);
+		if ( fa->contentType == FieldCacheAuto::INT_ARRAY )
+			type = SortField::INT;
+		else if ( fa->contentType == FieldCacheAuto::FLOAT_ARRAY )
+			type = SortField::FLOAT;
+		else if ( fa->contentType == FieldCacheAuto::STRING_INDEX ||
+				  fa->contentType == FieldCacheAuto::STRING_ARRAY )
+			type = SortField::STRING;
+		else
+			return NULL;
+	}
+
+	//the resolved sort criteria, as FieldSortedHitQueue reports them
+	SortField** fields = _CL_NEWARRAY(SortField*, tie == NULL ? 2 : 3);
+	fields[0] = _CLNEW SortField(field, type, primary->getReverse());
+	fields[1] = NULL;
+	if ( tie != NULL ){
+		fields[1] = _CLNEW SortField(tie->getField(), tie->getType(), tie->getReverse());
+		fields[2] = NULL;
+	}
+	int32_t tieType = tie == NULL ? -1 : tie->getType();
+	bool tieReverse = tie == NULL ? false : tie->getReverse();
+
+	if ( type == SortField::INT ){
+		FieldCacheAuto* fa = FieldCache::DEFAULT()->getInts(reader, field);
+		return _CLNEW SingleFieldTopDocsCollector<int32_t>(fa->intArray, NULL,
+			primary->getReverse(), tieType, tieReverse, bits, nDocs, fields);
+	}else if ( type == SortField::FLOAT ){
+		FieldCacheAuto* fa = FieldCache::DEFAULT()->getFloats(reader, field);
+		return _CLNEW SingleFieldTopDocsCollector<float_t>(fa->floatArray, NULL,
+			primary->getReverse(), tieType, tieReverse, bits, nDocs, fields);
+	}else{
+		FieldCacheAuto* fa = FieldCache::DEFAULT()->getStringIndex(reader, field);
+		return _CLNEW SingleFieldTopDocsCollector<int32_t>(fa->stringIndex->order, fa->stringIndex,
+			primary->getReverse(), tieType, tieReverse, bits, nDocs, fields);
+	}
+}
+
+CL_NS_END
@@ -91,30 +91,6 @@ protected:
 	bool lessThan (FieldDoc* docA, FieldDoc* docB);
 };
 
-
-/**
-* Expert: Returned by low-level sorted search implementations.
-*
-* @see Searchable#search(Query,Filter,int32_t,Sort)
-*/
-class TopFieldDocs: public TopDocs {
-public:
-	/// The fields which were used to sort results by.
-	SortField** fields;
-
-	FieldDoc** fieldDocs;
-
-   /** Creates one of these objects.
-   * @param totalHits  Total number of hits for the query.
-   * @param fieldDocs  The top hits for the query.
-   * @param scoreDocs  The top hits for the query.
-   * @param scoreDocsLen  Length of fieldDocs and scoreDocs
-   * @param fields     The sort criteria used to find the top hits.
-   */
-  TopFieldDocs (int32_t totalHits, FieldDoc** fieldDocs, int32_t scoreDocsLen, SortField** fields);
-	~TopFieldDocs();
-};
-
 CL_NS_END
 #endif
 
@@ -16,6 +16,7 @@ CL_NS_DEF(search)
  */
 class PhrasePositions:LUCENE_BASE {
 public:
+	LUCENE_ARENA_ALLOCATED
 	int32_t doc;					  // current doc
 	int32_t position;					  // position in doc
 	int32_t count;					  // remaining pos in this doc
@@ -24,6 +25,11 @@ public:
 	PhrasePositions* _next;				  // used to make lists
 	bool repeats;       // there's other pp for same term (e.g. query="1st word 2nd word"~1) 
 
+	int32_t* positions;       // positions of the current doc (minus offset), decoded in bulk
+	int32_t positionsLength;  // number of positions decoded for the current doc
+	int32_t positionsSize;    // allocated length of positions
+	int32_t positionIndex;    // index of the next position to return from positions
+
 	PhrasePositions(CL_NS(index)::TermPositions* Tp, const int32_t o);
 	~PhrasePositions();
 
@@ -32,6 +38,14 @@ public:
 
 	void firstPosition();
 
+	/**
+	* Decode all positions of the current document into <code>positions</code>
+	* in one pass, without consuming any of them. Afterwards <code>count</code>
+	* holds the number of positions and <code>nextPosition()</code> walks the
+	* decoded array instead of the underlying TermPositions.
+	*/
+	void loadPositions();
+
 	/**
 	* Go to next location of this term current document, and set 
 	* <code>position</code> as <code>location - offset</code>, so that a 
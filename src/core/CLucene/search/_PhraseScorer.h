@@ -22,6 +22,8 @@ class Explanation;
 * is invoked for each document containing all the phrase query terms, in order to 
 * compute the frequency of the phrase query in that document. A non zero frequency
 * means a match. 
+* <br>Candidate documents are found by letting the first TermPositions (which should
+* be the rarest term) propose a doc and skipping all other terms to it.
 */
 class PhraseScorer: public Scorer {
 private:
@@ -39,6 +41,11 @@ protected:
 	PhrasePositions* first; //Points to the first in the list of PhrasePositions
 	PhrasePositions* last;  //Points to the last in the list of PhrasePositions
 
+	//The PhrasePositions in the order the TermPositions were passed in.
+	//pps[0] drives the doc intersection, so callers should pass the rarest term first.
+	PhrasePositions** pps;
+	int32_t ppsLength;
+
 public:
 	//Constructor
 	PhraseScorer(Weight* _weight, CL_NS(index)::TermPositions** tps, 
@@ -72,7 +79,6 @@ protected:
 private:
 	bool doNext();
 	void init();
-	void sort();
 };
 CL_NS_END
 #endif
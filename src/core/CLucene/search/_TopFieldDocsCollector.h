@@ -0,0 +1,52 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_TopFieldDocsCollector_
+#define _lucene_search_TopFieldDocsCollector_
+
+#include "SearchHeader.h"
+
+CL_CLASS_DEF(index,IndexReader)
+CL_CLASS_DEF(util,BitSet)
+
+CL_NS_DEF(search)
+
+class Sort;
+class TopFieldDocs;
+
+/**
+* Collects the top hits of a sort by a single INT, FLOAT, STRING (or AUTO)
+* field, optionally followed by a score or index order sort.
+*
+* <p>The sort keys are read straight from the FieldCache arrays (the ordinals
+* for strings) and kept inline in a flat heap, so that non-competitive hits are
+* rejected with a single comparison of their key against the weakest key of
+* the heap, without building a FieldDoc or calling a ScoreDocComparator.
+* The results are identical to those of {@link FieldSortedHitQueue}.</p>
+*/
+class TopFieldDocsCollector: public HitCollector{
+protected:
+	TopFieldDocsCollector();
+public:
+	virtual ~TopFieldDocsCollector();
+
+	/**
+	* Returns a collector for <code>sort</code>, or NULL if the sort is not one
+	* of the specialized cases and FieldSortedHitQueue should be used instead.
+	* @param bits documents to collect, or NULL to collect all hits
+	*/
+	static TopFieldDocsCollector* newInstance(CL_NS(index)::IndexReader* reader, const Sort* sort,
+		const CL_NS(util)::BitSet* bits, int32_t nDocs);
+
+	/** Number of collected hits */
+	virtual int32_t getTotalHits() const = 0;
+
+	/** Returns the collected hits, best first. Can only be called once. */
+	virtual TopFieldDocs* topDocs() = 0;
+};
+
+CL_NS_END
+#endif
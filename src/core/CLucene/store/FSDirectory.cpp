@@ -19,6 +19,9 @@
 #ifdef _CL_HAVE_DIRECT_H
 	#include <direct.h>
 #endif
+#ifdef _CL_HAVE_SYS_SENDFILE_H
+	#include <sys/sendfile.h>
+#endif
 #include <errno.h>
 
 #include <assert.h>
@@ -74,6 +77,7 @@ CL_NS_USE(util)
 		};
 	protected:
 		FSIndexInput(const FSIndexInput& clone);
+		friend class FSDirectory::FSIndexOutput;
 	public:
 		static bool open(const char* path, IndexInput*& ret, CLuceneError& error, int32_t bufferSize=-1);
 		~FSIndexInput();
@@ -108,6 +112,9 @@ CL_NS_USE(util)
 		// Random-access methods
 		void seek(const int64_t pos);
 		int64_t length() const;
+
+		/** Copies from another FSIndexInput inside the kernel where possible */
+		void copyBytes(IndexInput* input, int64_t numBytes);
 	};
 
 	bool FSDirectory::FSIndexInput::open(const char* path, IndexInput*& ret, CLuceneError& error, int32_t __bufferSize )    {
@@ -230,7 +237,7 @@ CL_NS_USE(util)
   }
 
   void FSDirectory::FSIndexInput::seekInternal(const int64_t position)  {
-	CND_PRECONDITION(position>=0 &&position<handle->_length,"Seeking out of range")
+	CND_PRECONDITION(position>=0 &&position<=handle->_length,"Seeking out of range")
 	_pos = position;
   }
 
@@ -341,6 +348,73 @@ void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
 	  return fileSize(fhandle);
   }
 
+#if defined(_CL_HAVE_FUNCTION_COPY_FILE_RANGE) || (defined(_CL_HAVE_FUNCTION_SENDFILE) && defined(_CL_HAVE_SYS_SENDFILE_H))
+  #define LUCENE_FS_KERNEL_COPY
+  /**
+  * Copies up to len bytes from offset *pos of the file in to the current
+  * position of the file out without passing them through user space, and
+  * advances *pos. Returns the number of bytes copied, 0 at the end of in or
+  * -1 if the kernel can't copy between these files.
+  */
+  static int64_t kernelCopy(int32_t in, int64_t* pos, int32_t out, int64_t len){
+	  //keep the count representable in a ssize_t on 32 bit systems
+	  size_t count = (size_t)cl_min(len, (int64_t)0x40000000);
+	#ifdef _CL_HAVE_FUNCTION_COPY_FILE_RANGE
+	  int64_t off = *pos;
+	  ssize_t ret = ::copy_file_range(in, &off, out, NULL, count, 0);
+	  if ( ret >= 0 ){
+		  *pos = off;
+		  return ret;
+	  }
+	  //ENOSYS, EXDEV on older kernels, EINVAL for special files: try sendfile
+	#endif
+	#if defined(_CL_HAVE_FUNCTION_SENDFILE) && defined(_CL_HAVE_SYS_SENDFILE_H)
+	  off_t soff = (off_t)*pos;
+	  ssize_t sent = ::sendfile(out, in, &soff, count);
+	  if ( sent >= 0 ){
+		  *pos = soff;
+		  return sent;
+	  }
+	#endif
+	  return -1;
+  }
+#endif
+
+  void FSDirectory::FSIndexOutput::copyBytes(IndexInput* input, int64_t numBytes){
+#ifdef LUCENE_FS_KERNEL_COPY
+	  CND_PRECONDITION(fhandle>=0,"file is not open");
+	  if ( numBytes > 0 && input->instanceOf(FSIndexInput::getClassName()) ){
+		  FSIndexInput* in = static_cast<FSIndexInput*>(input);
+		  CND_PRECONDITION(in->handle!=NULL,"shared file handle has closed");
+
+		  //the buffered bytes must reach the file before the copied ones.
+		  //The copy reads at an explicit offset, so the position of the
+		  //shared input handle is left alone.
+		  flush();
+		  const int64_t outStart = getFilePointer();
+		  const int64_t inStart = input->getFilePointer();
+		  int64_t inPos = inStart;
+		  int64_t left = numBytes;
+		  while ( left > 0 ){
+			  int64_t n = kernelCopy(in->handle->fhandle, &inPos, fhandle, left);
+			  if ( n <= 0 )
+				  break; //let the buffered copy below deal with it
+			  left -= n;
+		  }
+
+		  const int64_t copied = numBytes - left;
+		  if ( copied > 0 ){
+			  seek(outStart + copied);
+			  input->seek(inStart + copied);
+		  }
+		  if ( left == 0 )
+			  return;
+		  numBytes = left;
+	  }
+#endif
+	  IndexOutput::copyBytes(input, numBytes);
+  }
+
 
 	const char* FSDirectory::LOCK_DIR=NULL;
 	const char* FSDirectory::getLockDir(){
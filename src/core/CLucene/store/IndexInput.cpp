@@ -7,7 +7,9 @@
 #include "CLucene/_ApiHeader.h"
 #include "IndexInput.h"
 #include "IndexOutput.h"
+#include "_ModifiedUTF8.h"
 #include "CLucene/util/Misc.h"
+#include "CLucene/util/_ProfileHook.h"
 
 CL_NS_DEF(store)
 CL_NS_USE(util)
@@ -193,6 +195,21 @@ BufferedIndexInput::BufferedIndexInput(int32_t _bufferSize):
 	const char* BufferedIndexInput::getObjectName(){ return getClassName(); }
 	const char* BufferedIndexInput::getClassName(){ return "BufferedIndexInput"; }
 		
+  void BufferedIndexInput::readChars( TCHAR* b, const int32_t start, const int32_t len) {
+    TCHAR* out = b + start;
+    const TCHAR* end = out + len;
+    while ( out < end ) {
+      if (bufferPosition >= bufferLength)
+        refill();
+      bufferPosition = (int32_t)(ModifiedUTF8::decode(buffer + bufferPosition, buffer + bufferLength, out, end) - buffer);
+      if ( out < end && bufferPosition < bufferLength ){
+        // the next character is split over the end of the buffer
+        IndexInput::readChars(out, 0, 1);
+        ++out;
+      }
+    }
+  }
+
   void BufferedIndexInput::readBytes(uint8_t* b, const int32_t len){
     readBytes(b, len, true);
   }
@@ -240,6 +257,7 @@ BufferedIndexInput::BufferedIndexInput(int32_t _bufferSize):
         if(after > length())
           _CLTHROWA(CL_ERR_IO, "read past EOF");
         readInternal(b, len);
+        CL_NS(util)::ProfileHook::recordBytesRead(len);
         bufferStart = after;
         bufferPosition = 0;
         bufferLength = 0;                    // trigger refill() on read
@@ -288,7 +306,7 @@ BufferedIndexInput::BufferedIndexInput(int32_t _bufferSize):
       buffer = _CL_NEWARRAY(uint8_t,bufferSize);		  // allocate buffer lazily
     }
     readInternal(buffer, bufferLength);
-
+    CL_NS(util)::ProfileHook::recordBytesRead(bufferLength);
 
     bufferStart = start;
     bufferPosition = 0;
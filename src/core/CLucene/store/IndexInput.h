@@ -104,7 +104,7 @@ CL_NS_DEF(store)
 		* @param length the number of characters to read
 		* @see IndexOutput#writeChars(String,int32_t,int32_t)
 		*/
-		void readChars( TCHAR* buffer, const int32_t start, const int32_t len);
+		virtual void readChars( TCHAR* buffer, const int32_t start, const int32_t len);
 
 		void skipChars( const int32_t count);
 
@@ -169,6 +169,8 @@ CL_NS_DEF(store)
 		}
 		void readBytes(uint8_t* b, const int32_t len);
 		void readBytes(uint8_t* b, const int32_t len, bool useBuffer);
+		/** Decodes the characters straight from the buffer */
+		void readChars( TCHAR* buffer, const int32_t start, const int32_t len);
 		int64_t getFilePointer() const;
 		void seek(const int64_t pos);
 
@@ -7,6 +7,7 @@
 #include "CLucene/_ApiHeader.h"
 #include "IndexOutput.h"
 #include "IndexInput.h"
+#include "_ModifiedUTF8.h"
 #include "CLucene/util/Misc.h"
 
 CL_NS_USE(util)
@@ -146,19 +147,27 @@ CL_NS_DEF(store)
     if ( length < 0 )
       _CLTHROWA(CL_ERR_IllegalArgument, "IO Argument Error. Value must be a positive value.");
 
-    const int32_t end = length;
-    for (int32_t i = 0; i < end; ++i) {
-        const int32_t code = (int32_t)s[i];
-        if (code >= 0x01 && code <= 0x7F)
-					writeByte((uint8_t)code);
-        else if (((code >= 0x80) && (code <= 0x7FF)) || code == 0) {
-					writeByte((uint8_t)(0xC0 | (code >> 6)));
-					writeByte((uint8_t)(0x80 | (code & 0x3F)));
-        } else {
-					writeByte((uint8_t)(0xE0 | (((uint32_t)code) >> 12))); //unsigned shift
-					writeByte((uint8_t)(0x80 | ((code >> 6) & 0x3F)));
-					writeByte((uint8_t)(0x80 | (code & 0x3F)));
-        }
+    // encode in chunks, to call writeBytes rather than writeByte per byte
+    uint8_t chunk[1024];
+    const TCHAR* end = s + length;
+    while ( s < end ) {
+      uint8_t* out = chunk;
+      s = ModifiedUTF8::encode(s, end, out, chunk + sizeof(chunk));
+      writeBytes(chunk, (int32_t)(out - chunk));
+    }
+  }
+
+  void BufferedIndexOutput::writeChars(const TCHAR* s, const int32_t length){
+    if ( length < 0 )
+      _CLTHROWA(CL_ERR_IllegalArgument, "IO Argument Error. Value must be a positive value.");
+
+    const TCHAR* end = s + length;
+    while ( s < end ) {
+      if ( BUFFER_SIZE - bufferPosition < 3 )
+        flush();
+      uint8_t* out = buffer + bufferPosition;
+      s = ModifiedUTF8::encode(s, end, out, buffer + BUFFER_SIZE);
+      bufferPosition = (int32_t)(out - buffer);
     }
   }
 
@@ -77,7 +77,7 @@ public:
 	* @param length the number of characters in the sequence
 	* @see IndexInput#readChars(char[],int32_t,int32_t)
 	*/
-	void writeChars(const TCHAR* s, const int32_t length);
+	virtual void writeChars(const TCHAR* s, const int32_t length);
 
 	/** Closes this stream to further operations. */
 	virtual void close() = 0;
@@ -104,8 +104,11 @@ private:
 	uint8_t* copyBuffer;
 
 public:
-	/** Copy numBytes bytes from input to ourself. */
-	void copyBytes(CL_NS(store)::IndexInput* input, int64_t numBytes);
+	/** Copy numBytes bytes from input to ourself.
+	* Implementations may override this to copy without going through
+	* a user space buffer when both files belong to the same kind of Directory.
+	*/
+	virtual void copyBytes(CL_NS(store)::IndexInput* input, int64_t numBytes);
 };
 
 /** Base implementation class for buffered {@link IndexOutput}. */
@@ -133,6 +136,9 @@ public:
 	*/
 	virtual void writeBytes(const uint8_t* b, const int32_t length);
 
+	/** Encodes the characters straight into the buffer */
+	virtual void writeChars(const TCHAR* s, const int32_t length);
+
 	/** Closes this stream to further operations. */
 	virtual void close();
 
@@ -8,6 +8,7 @@
 
 #include "FSDirectory.h"
 #include "_MMapIndexInput.h"
+#include "_ModifiedUTF8.h"
 #include "CLucene/util/Misc.h"
 
 #include <fcntl.h>
@@ -230,6 +231,14 @@ CL_NS_USE(util)
 	memcpy(b, _internal->data+_internal->pos, len);
 	_internal->pos+=len;
   }
+  void MMapIndexInput::readChars(TCHAR* buffer, const int32_t start, const int32_t len){
+	TCHAR* out = buffer + start;
+	const uint8_t* in = _internal->data + _internal->pos;
+	const uint8_t* end = ModifiedUTF8::decode(in, _internal->data + _internal->_length, out, buffer + start + len);
+	_internal->pos += end - in;
+	if ( out < buffer + start + len )
+		_CLTHROWA(CL_ERR_IO, "read past EOF");
+  }
   int32_t MMapIndexInput::readVInt(){
 	  uint8_t b = *(_internal->data+(_internal->pos++));
 	  int32_t i = b & 0x7F;
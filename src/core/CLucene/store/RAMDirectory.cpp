@@ -14,6 +14,7 @@
 #include "CLucene/index/IndexReader.h"
 //#include "CLucene/util/VoidMap.h"
 #include "CLucene/util/Misc.h"
+#include "CLucene/util/_ProfileHook.h"
 #include <assert.h>
 
 CL_NS_USE(util)
@@ -351,6 +352,7 @@ CL_NS_DEF(store)
 		  bufferStart = (int64_t)BUFFER_SIZE * (int64_t)currentBufferIndex;
 		  int64_t bufLen = _length - bufferStart;
 		  bufferLength = bufLen > BUFFER_SIZE ? BUFFER_SIZE : static_cast<int32_t>(bufLen);
+		  CL_NS(util)::ProfileHook::recordBytesRead(bufferLength);
 	  }
     assert (bufferLength >=0);
   }
@@ -0,0 +1,203 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "RateLimiter.h"
+#include "_RateLimitedIndexOutput.h"
+#include "IndexInput.h"
+#include "CLucene/util/Misc.h"
+
+CL_NS_USE(util)
+CL_NS_DEF(store)
+
+
+RateLimiter::RateLimiter(double mbPerSec):
+	lastMs(0),
+	bytes(0),
+	stalledMs(0),
+	pauseCount(0)
+{
+	setMbPerSec(mbPerSec);
+}
+RateLimiter::~RateLimiter(){
+}
+
+void RateLimiter::setMbPerSec(double mbPerSec){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	if ( mbPerSec < 0 )
+		_CLTHROWA(CL_ERR_IllegalArgument, "mbPerSec must be >= 0");
+	this->mbPerSec = mbPerSec;
+	this->msPerByte = mbPerSec > 0 ? 1000.0 / (mbPerSec*1024*1024) : 0;
+}
+double RateLimiter::getMbPerSec(){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	return mbPerSec;
+}
+
+int64_t RateLimiter::pause(int64_t bytes){
+	int64_t pauseMs = 0;
+	{
+		SCOPED_LOCK_MUTEX(THIS_LOCK)
+		this->bytes += bytes;
+		if ( msPerByte == 0 )
+			return 0;
+
+		// the time at which these bytes may have been written if all bytes
+		// so far had been written at the maximum rate
+		const double now = (double)Misc::currentTimeMillis();
+		if ( lastMs < now )
+			lastMs = now;
+		lastMs += bytes * msPerByte;
+		pauseMs = (int64_t)(lastMs - now);
+		if ( pauseMs > 0 ){
+			stalledMs += pauseMs;
+			++pauseCount;
+		}
+	}
+	// sleep without holding the lock, other writers account their
+	// bytes after ours
+	if ( pauseMs > 0 )
+		_LUCENE_SLEEP((int)pauseMs);
+	return pauseMs > 0 ? pauseMs : 0;
+}
+
+int64_t RateLimiter::getBytes(){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	return bytes;
+}
+int64_t RateLimiter::getStalledMillis(){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	return stalledMs;
+}
+int64_t RateLimiter::getPauseCount(){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	return pauseCount;
+}
+void RateLimiter::resetStats(){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	bytes = 0;
+	stalledMs = 0;
+	pauseCount = 0;
+}
+
+
+RateLimitedIndexOutput::RateLimitedIndexOutput(IndexOutput* delegate, RateLimiter* limiter):
+	delegate(delegate),
+	limiter(limiter),
+	pending(0)
+{
+}
+RateLimitedIndexOutput::~RateLimitedIndexOutput(){
+	_CLDELETE(delegate);
+}
+
+void RateLimitedIndexOutput::reportPending(){
+	if ( pending > 0 ){
+		int32_t bytes = pending;
+		pending = 0;
+		limiter->pause(bytes);
+	}
+}
+
+void RateLimitedIndexOutput::writeByte(const uint8_t b){
+	delegate->writeByte(b);
+	if ( ++pending >= CHUNK_SIZE )
+		reportPending();
+}
+void RateLimitedIndexOutput::writeBytes(const uint8_t* b, const int32_t length){
+	delegate->writeBytes(b, length);
+	pending += length;
+	if ( pending >= CHUNK_SIZE )
+		reportPending();
+}
+void RateLimitedIndexOutput::copyBytes(IndexInput* input, int64_t numBytes){
+	// keep the fast copy paths of the delegate, pacing chunk by chunk
+	while ( numBytes > 0 ){
+		int32_t len = (int32_t)cl_min((int64_t)(CHUNK_SIZE - pending), numBytes);
+		delegate->copyBytes(input, len);
+		pending += len;
+		numBytes -= len;
+		if ( pending >= CHUNK_SIZE )
+			reportPending();
+	}
+}
+void RateLimitedIndexOutput::close(){
+	reportPending();
+	delegate->close();
+}
+int64_t RateLimitedIndexOutput::getFilePointer() const{
+	return delegate->getFilePointer();
+}
+void RateLimitedIndexOutput::seek(const int64_t pos){
+	delegate->seek(pos);
+}
+int64_t RateLimitedIndexOutput::length() const{
+	return delegate->length();
+}
+void RateLimitedIndexOutput::flush(){
+	delegate->flush();
+}
+
+
+RateLimitedDirectory::RateLimitedDirectory(Directory* delegate, RateLimiter* limiter):
+	delegate(_CL_POINTER(delegate)),
+	limiter(limiter)
+{
+}
+RateLimitedDirectory::~RateLimitedDirectory(){
+	_CLDECDELETE(delegate);
+}
+
+bool RateLimitedDirectory::doDeleteFile(const char* name){
+	return delegate->deleteFile(name, false);
+}
+bool RateLimitedDirectory::list(std::vector<std::string>* names) const{
+	return delegate->list(names);
+}
+bool RateLimitedDirectory::fileExists(const char* name) const{
+	return delegate->fileExists(name);
+}
+int64_t RateLimitedDirectory::fileModified(const char* name) const{
+	return delegate->fileModified(name);
+}
+int64_t RateLimitedDirectory::fileLength(const char* name) const{
+	return delegate->fileLength(name);
+}
+bool RateLimitedDirectory::openInput(const char* name, IndexInput*& ret, CLuceneError& error, int32_t bufferSize){
+	return delegate->openInput(name, ret, error, bufferSize);
+}
+void RateLimitedDirectory::touchFile(const char* name){
+	delegate->touchFile(name);
+}
+void RateLimitedDirectory::renameFile(const char* from, const char* to){
+	delegate->renameFile(from, to);
+}
+IndexOutput* RateLimitedDirectory::createOutput(const char* name){
+	return _CLNEW RateLimitedIndexOutput(delegate->createOutput(name), limiter);
+}
+LuceneLock* RateLimitedDirectory::makeLock(const char* name){
+	return delegate->makeLock(name);
+}
+void RateLimitedDirectory::clearLock(const char* name){
+	delegate->clearLock(name);
+}
+void RateLimitedDirectory::close(){
+	// the delegate is closed by its owner
+}
+std::string RateLimitedDirectory::toString() const{
+	return delegate->toString();
+}
+std::string RateLimitedDirectory::getLockID(){
+	return delegate->getLockID();
+}
+const char* RateLimitedDirectory::getObjectName() const{
+	return getClassName();
+}
+const char* RateLimitedDirectory::getClassName(){
+	return "RateLimitedDirectory";
+}
+
+CL_NS_END
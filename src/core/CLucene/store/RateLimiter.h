@@ -0,0 +1,66 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_store_RateLimiter_
+#define _lucene_store_RateLimiter_
+
+#include "CLucene/LuceneThreads.h"
+
+CL_NS_DEF(store)
+
+/**
+ * Expert: paces the bytes written by one or more threads to a maximum
+ * number of MB per second, by making the writers sleep.
+ *
+ * <p>{@link IndexWriter#setMergeRateLimiter} applies a RateLimiter to all
+ * files written while merging segments, so that big merges don't starve
+ * searches of disk bandwidth. The same instance may be shared by several
+ * IndexWriters to limit their merges together.</p>
+ *
+ * <p>The rate can be changed at any time, from any thread. The limiter also
+ * keeps statistics on the bytes that passed through it and the time writers
+ * spent stalled.</p>
+ */
+class CLUCENE_EXPORT RateLimiter: LUCENE_BASE
+{
+	DEFINE_MUTEX(THIS_LOCK)
+	double mbPerSec;
+	double msPerByte;
+	double lastMs;		// time at which the bytes paused so far may have been written
+	int64_t bytes;
+	int64_t stalledMs;
+	int64_t pauseCount;
+public:
+	/**
+	* @param mbPerSec the maximum rate, 0 for no limit
+	*/
+	RateLimiter(double mbPerSec=0);
+	virtual ~RateLimiter();
+
+	/** Sets the maximum rate in MB per second, 0 for no limit */
+	void setMbPerSec(double mbPerSec);
+	/** The maximum rate in MB per second, 0 if there is no limit */
+	double getMbPerSec();
+
+	/**
+	* Records that <code>bytes</code> were written and sleeps as long as
+	* needed to stay under the maximum rate.
+	* @return the number of milliseconds the caller was stalled
+	*/
+	int64_t pause(int64_t bytes);
+
+	/** The number of bytes recorded by {@link #pause} */
+	int64_t getBytes();
+	/** The total number of milliseconds writers were stalled */
+	int64_t getStalledMillis();
+	/** The number of times a writer was stalled */
+	int64_t getPauseCount();
+	/** Resets the byte, stall time and pause counters */
+	void resetStats();
+};
+
+CL_NS_END
+#endif
@@ -0,0 +1,350 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "_StatsDirectory.h"
+#include "CLucene/util/Misc.h"
+
+CL_NS_USE(util)
+CL_NS_DEF(store)
+
+
+IOStats::Counters::Counters(){
+	clear();
+}
+void IOStats::Counters::add(const Counters& other){
+	opens += other.opens;
+	readCalls += other.readCalls;
+	readBytes += other.readBytes;
+	seeks += other.seeks;
+	seekHits += other.seekHits;
+	creates += other.creates;
+	writeCalls += other.writeCalls;
+	writeBytes += other.writeBytes;
+	for ( int32_t i=0;i<LATENCY_BUCKETS;i++ ){
+		readLatency[i] += other.readLatency[i];
+		writeLatency[i] += other.writeLatency[i];
+	}
+}
+void IOStats::Counters::clear(){
+	opens = readCalls = readBytes = seeks = seekHits = 0;
+	creates = writeCalls = writeBytes = 0;
+	for ( int32_t i=0;i<LATENCY_BUCKETS;i++ ){
+		readLatency[i] = 0;
+		writeLatency[i] = 0;
+	}
+}
+int64_t IOStats::Counters::percentile(const int64_t* histogram, int32_t percent){
+	int64_t total = 0;
+	for ( int32_t i=0;i<LATENCY_BUCKETS;i++ )
+		total += histogram[i];
+	if ( total == 0 )
+		return 0;
+
+	// the smallest bucket below which at least percent of the calls are
+	int64_t target = (total * percent + 99) / 100;
+	int64_t seen = 0;
+	int32_t i = 0;
+	for ( ;i<LATENCY_BUCKETS-1;i++ ){
+		seen += histogram[i];
+		if ( seen >= target )
+			break;
+	}
+	return ((int64_t)1) << i;
+}
+
+
+IOStats::IOStats(){
+}
+IOStats::~IOStats(){
+}
+
+int32_t IOStats::bucket(int64_t micros){
+	int32_t b = 0;
+	while ( micros > 0 && b < LATENCY_BUCKETS-1 ){
+		micros >>= 1;
+		b++;
+	}
+	return b;
+}
+
+std::string IOStats::fileType(const char* name){
+	// segments_N, and the segments file of old indexes
+	if ( strncmp(name, "segments", 8) == 0 && name[8] != '.' )
+		return "segments";
+
+	const char* ext = strrchr(name, '.');
+	if ( ext == NULL )
+		return name;
+	ext++;
+
+	// separate norms (.sN) and old norms (.fN) of each field
+	if ( (*ext == 's' || *ext == 'f') && ext[1] != 0 ){
+		const char* p = ext + 1;
+		while ( *p >= '0' && *p <= '9' )
+			p++;
+		if ( *p == 0 ){
+			std::string type(ext, 1);
+			type += 'N';
+			return type;
+		}
+	}
+	return ext;
+}
+
+IOStats::Counters* IOStats::getCounters(const char* name){
+	std::string type = fileType(name);
+	SCOPED_LOCK_MUTEX(THIS_LOCK);
+	// map nodes are never erased, so the pointer stays valid
+	return &counters[type];
+}
+
+void IOStats::opened(Counters* c){
+	SCOPED_LOCK_MUTEX(THIS_LOCK);
+	c->opens++;
+}
+void IOStats::created(Counters* c){
+	SCOPED_LOCK_MUTEX(THIS_LOCK);
+	c->creates++;
+}
+void IOStats::read(Counters* c, int32_t bytes, int64_t micros){
+	int32_t b = bucket(micros);
+	SCOPED_LOCK_MUTEX(THIS_LOCK);
+	c->readCalls++;
+	c->readBytes += bytes;
+	c->readLatency[b]++;
+}
+void IOStats::seeked(Counters* c, bool hit){
+	SCOPED_LOCK_MUTEX(THIS_LOCK);
+	c->seeks++;
+	if ( hit )
+		c->seekHits++;
+}
+void IOStats::written(Counters* c, int32_t bytes, int64_t micros){
+	int32_t b = bucket(micros);
+	SCOPED_LOCK_MUTEX(THIS_LOCK);
+	c->writeCalls++;
+	c->writeBytes += bytes;
+	c->writeLatency[b]++;
+}
+
+void IOStats::snapshot(Snapshot& ret) const{
+	SCOPED_LOCK_MUTEX(THIS_LOCK);
+	ret = counters;
+}
+IOStats::Counters IOStats::getTotal() const{
+	Counters total;
+	SCOPED_LOCK_MUTEX(THIS_LOCK);
+	for ( Snapshot::const_iterator itr = counters.begin(); itr != counters.end(); ++itr )
+		total.add(itr->second);
+	return total;
+}
+void IOStats::reset(){
+	SCOPED_LOCK_MUTEX(THIS_LOCK);
+	for ( Snapshot::iterator itr = counters.begin(); itr != counters.end(); ++itr )
+		itr->second.clear();
+}
+
+std::string IOStats::toString() const{
+	Snapshot snap;
+	snapshot(snap);
+
+	std::string ret;
+	for ( Snapshot::const_iterator itr = snap.begin(); itr != snap.end(); ++itr ){
+		const Counters& c = itr->second;
+		ret += itr->first;
+		ret += ": opens=" + Misc::toString(c.opens);
+		ret += " reads=" + Misc::toString(c.readCalls);
+		ret += " read_bytes=" + Misc::toString(c.readBytes);
+		ret += " seeks=" + Misc::toString(c.seeks);
+		ret += " seek_hits=" + Misc::toString(c.seekHits);
+		ret += " read_p50_us=" + Misc::toString(Counters::percentile(c.readLatency, 50));
+		ret += " read_p99_us=" + Misc::toString(Counters::percentile(c.readLatency, 99));
+		ret += " creates=" + Misc::toString(c.creates);
+		ret += " writes=" + Misc::toString(c.writeCalls);
+		ret += " write_bytes=" + Misc::toString(c.writeBytes);
+		ret += " write_p50_us=" + Misc::toString(Counters::percentile(c.writeLatency, 50));
+		ret += " write_p99_us=" + Misc::toString(Counters::percentile(c.writeLatency, 99));
+		ret += "\n";
+	}
+	return ret;
+}
+
+
+StatsIndexInput::StatsIndexInput(IndexInput* delegate, IOStats* stats, IOStats::Counters* counters, int32_t bufferSize):
+	BufferedIndexInput(bufferSize),
+	delegate(delegate),
+	stats(stats),
+	counters(counters)
+{
+}
+StatsIndexInput::StatsIndexInput(const StatsIndexInput& other):
+	BufferedIndexInput(other),
+	delegate(other.delegate->clone()),
+	stats(other.stats),
+	counters(other.counters)
+{
+}
+StatsIndexInput::~StatsIndexInput(){
+	_CLDELETE(delegate);
+}
+
+void StatsIndexInput::readInternal(uint8_t* b, const int32_t len){
+	// the wrapped input is always positioned where our buffer ends
+	int64_t start = Misc::currentTimeMicros();
+	delegate->readBytes(b, len, false);
+	stats->read(counters, len, Misc::currentTimeMicros() - start);
+}
+void StatsIndexInput::seekInternal(const int64_t pos){
+	delegate->seek(pos);
+}
+void StatsIndexInput::seek(const int64_t pos){
+	bool hit = pos >= bufferStart && pos < bufferStart + bufferLength;
+	BufferedIndexInput::seek(pos);
+	stats->seeked(counters, hit);
+}
+IndexInput* StatsIndexInput::clone() const{
+	return _CLNEW StatsIndexInput(*this);
+}
+void StatsIndexInput::close(){
+	BufferedIndexInput::close();
+	delegate->close();
+}
+int64_t StatsIndexInput::length() const{
+	return delegate->length();
+}
+const char* StatsIndexInput::getDirectoryType() const{
+	return StatsDirectory::getClassName();
+}
+const char* StatsIndexInput::getObjectName() const{
+	return getClassName();
+}
+const char* StatsIndexInput::getClassName(){
+	return "StatsIndexInput";
+}
+
+
+StatsIndexOutput::StatsIndexOutput(IndexOutput* delegate, IOStats* stats, IOStats::Counters* counters):
+	delegate(delegate),
+	stats(stats),
+	counters(counters),
+	closed(false)
+{
+}
+StatsIndexOutput::~StatsIndexOutput(){
+	if ( !closed ){
+		try{
+			StatsIndexOutput::close();
+		}catch(CLuceneError& err){
+			//ignore IO errors...
+			if ( err.number() != CL_ERR_IO )
+				throw;
+		}
+	}
+	_CLDELETE(delegate);
+}
+
+void StatsIndexOutput::flushBuffer(const uint8_t* b, const int32_t len){
+	if ( len <= 0 )
+		return;
+	int64_t start = Misc::currentTimeMicros();
+	delegate->writeBytes(b, len);
+	stats->written(counters, len, Misc::currentTimeMicros() - start);
+}
+void StatsIndexOutput::close(){
+	closed = true;
+	BufferedIndexOutput::close();
+	delegate->close();
+}
+void StatsIndexOutput::seek(const int64_t pos){
+	BufferedIndexOutput::seek(pos);
+	delegate->seek(pos);
+}
+int64_t StatsIndexOutput::length() const{
+	// the wrapped output does not have our buffer yet
+	return cl_max(delegate->length(), getFilePointer());
+}
+
+
+StatsDirectory::StatsDirectory(Directory* delegate):
+	delegate(_CL_POINTER(delegate)),
+	stats(_CLNEW IOStats())
+{
+}
+StatsDirectory::~StatsDirectory(){
+	_CLDECDELETE(delegate);
+	_CLDELETE(stats);
+}
+
+IOStats* StatsDirectory::getStats(){
+	return stats;
+}
+Directory* StatsDirectory::getDelegate(){
+	return delegate;
+}
+IndexInput* StatsDirectory::wrapInput(const char* name, IndexInput* input, int32_t bufferSize){
+	IOStats::Counters* counters = stats->getCounters(name);
+	stats->opened(counters);
+	return _CLNEW StatsIndexInput(input, stats, counters, bufferSize > 0 ? bufferSize : -1);
+}
+
+bool StatsDirectory::doDeleteFile(const char* name){
+	return delegate->deleteFile(name, false);
+}
+bool StatsDirectory::list(std::vector<std::string>* names) const{
+	return delegate->list(names);
+}
+bool StatsDirectory::fileExists(const char* name) const{
+	return delegate->fileExists(name);
+}
+int64_t StatsDirectory::fileModified(const char* name) const{
+	return delegate->fileModified(name);
+}
+int64_t StatsDirectory::fileLength(const char* name) const{
+	return delegate->fileLength(name);
+}
+bool StatsDirectory::openInput(const char* name, IndexInput*& ret, CLuceneError& error, int32_t bufferSize){
+	IndexInput* input = NULL;
+	if ( !delegate->openInput(name, input, error, bufferSize) )
+		return false;
+	ret = wrapInput(name, input, bufferSize);
+	return true;
+}
+void StatsDirectory::touchFile(const char* name){
+	delegate->touchFile(name);
+}
+void StatsDirectory::renameFile(const char* from, const char* to){
+	delegate->renameFile(from, to);
+}
+IndexOutput* StatsDirectory::createOutput(const char* name){
+	IndexOutput* output = delegate->createOutput(name);
+	IOStats::Counters* counters = stats->getCounters(name);
+	stats->created(counters);
+	return _CLNEW StatsIndexOutput(output, stats, counters);
+}
+LuceneLock* StatsDirectory::makeLock(const char* name){
+	return delegate->makeLock(name);
+}
+void StatsDirectory::clearLock(const char* name){
+	delegate->clearLock(name);
+}
+void StatsDirectory::close(){
+	// the delegate is closed by its owner
+}
+std::string StatsDirectory::toString() const{
+	return std::string("StatsDirectory@") + delegate->toString();
+}
+std::string StatsDirectory::getLockID(){
+	return delegate->getLockID();
+}
+const char* StatsDirectory::getObjectName() const{
+	return getClassName();
+}
+const char* StatsDirectory::getClassName(){
+	return "StatsDirectory";
+}
+
+CL_NS_END
@@ -0,0 +1,163 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_store_StatsDirectory_
+#define _lucene_store_StatsDirectory_
+
+#include "Directory.h"
+#include <map>
+
+CL_NS_DEF(store)
+
+class IndexInput;
+
+/**
+* I/O counters of a {@link StatsDirectory}, kept per file type.
+*
+* <p>The file type is the extension of the file name, with the generation
+* of separate norms collapsed, so that <code>_1_2.s3</code> counts as
+* <code>sN</code>; <code>segments_N</code> counts as <code>segments</code>.
+* Files of a compound file count for their own extension.</p>
+*
+* <p>The counters are updated by the inputs and outputs of the directory as
+* they go to the underlying directory, that is once per buffer and not once
+* per byte, and can be read with {@link #snapshot} while the index is in use.</p>
+*/
+class CLUCENE_EXPORT IOStats: LUCENE_BASE{
+public:
+	/**
+	* Number of latency buckets. Bucket 0 counts calls that took less than
+	* 1 microsecond, bucket i calls that took 2^(i-1) to 2^i microseconds;
+	* the last bucket counts all slower calls.
+	*/
+	LUCENE_STATIC_CONSTANT(int32_t, LATENCY_BUCKETS=24);
+
+	/** The counters of one file type */
+	class CLUCENE_EXPORT Counters{
+	public:
+		int64_t opens;			///< inputs opened, clones not included
+		int64_t readCalls;		///< reads from the underlying directory
+		int64_t readBytes;		///< bytes read from the underlying directory
+		int64_t seeks;			///< seeks of the inputs
+		int64_t seekHits;		///< seeks that landed inside the buffer of the input
+		int64_t creates;		///< outputs created
+		int64_t writeCalls;		///< writes to the underlying directory
+		int64_t writeBytes;		///< bytes written to the underlying directory
+		int64_t readLatency[LATENCY_BUCKETS];	///< histogram of the read times
+		int64_t writeLatency[LATENCY_BUCKETS];	///< histogram of the write times
+
+		Counters();
+		/** Adds the counters of other to these */
+		void add(const Counters& other);
+		/** Sets all counters to 0 */
+		void clear();
+		/**
+		* Upper bound, in microseconds, of the bucket of a latency histogram
+		* that holds the given percentile (0 to 100) of the calls, or 0 if
+		* there were no calls
+		*/
+		static int64_t percentile(const int64_t* histogram, int32_t percent);
+	};
+
+	/** Counters by file type */
+	typedef std::map<std::string, Counters> Snapshot;
+
+	IOStats();
+	~IOStats();
+
+	/** Copies the current counters of every file type into ret */
+	void snapshot(Snapshot& ret) const;
+	/** The counters of all file types added together */
+	Counters getTotal() const;
+	/** Sets all counters to 0 */
+	void reset();
+	/** A table of the counters, one file type per line */
+	std::string toString() const;
+
+	/** The file type a file name counts for */
+	static std::string fileType(const char* name);
+
+	/** The counters of the type of the given file, created if needed. Never freed before this object */
+	Counters* getCounters(const char* name);
+
+	void opened(Counters* counters);
+	void created(Counters* counters);
+	void read(Counters* counters, int32_t bytes, int64_t micros);
+	void seeked(Counters* counters, bool hit);
+	void written(Counters* counters, int32_t bytes, int64_t micros);
+
+private:
+	DEFINE_MUTABLE_MUTEX(THIS_LOCK)
+	Snapshot counters;
+
+	static int32_t bucket(int64_t micros);
+};
+
+/**
+* A Directory that delegates everything to another Directory and keeps
+* {@link IOStats} of the reads, seeks and writes of the files it opens and
+* creates. Use it to find out which files an index spends its I/O on, for
+* example to size the page cache or to tune buffer sizes:
+*
+* <pre>
+* FSDirectory* fsdir = FSDirectory::getDirectory(path);
+* StatsDirectory* dir = _CLNEW StatsDirectory(fsdir);
+* IndexReader* reader = IndexReader::open(dir);
+* ...
+* IOStats::Snapshot snapshot;
+* dir->getStats()->snapshot(snapshot);
+* </pre>
+*
+* <p>Closing a StatsDirectory does not close the wrapped directory.</p>
+*
+* <p>The inputs keep their own buffer and read through the unbuffered path
+* of the underlying inputs, so wrapping does not add a copy for buffered
+* inputs. The outputs are buffered and pass full buffers on; the fast copy
+* paths of the underlying outputs are not used.</p>
+*/
+class CLUCENE_EXPORT StatsDirectory: public Directory{
+	Directory* delegate;
+	IOStats* stats;
+protected:
+	bool doDeleteFile(const char* name);
+public:
+	/** @memory a reference to delegate is held until this directory is deleted */
+	StatsDirectory(Directory* delegate);
+	virtual ~StatsDirectory();
+
+	/** The counters of this directory */
+	IOStats* getStats();
+	/** The wrapped directory */
+	Directory* getDelegate();
+
+	/**
+	* Wraps an input of a file named name so that it counts for this
+	* directory. Used by CompoundFileReader for the files inside a compound
+	* file, which it reads from the unwrapped compound file.
+	* @memory input is owned by the returned input
+	*/
+	IndexInput* wrapInput(const char* name, IndexInput* input, int32_t bufferSize = -1);
+
+	bool list(std::vector<std::string>* names) const;
+	bool fileExists(const char* name) const;
+	int64_t fileModified(const char* name) const;
+	int64_t fileLength(const char* name) const;
+	bool openInput(const char* name, IndexInput*& ret, CLuceneError& error, int32_t bufferSize = -1);
+	void touchFile(const char* name);
+	void renameFile(const char* from, const char* to);
+	IndexOutput* createOutput(const char* name);
+	LuceneLock* makeLock(const char* name);
+	void clearLock(const char* name);
+	void close();
+	std::string toString() const;
+	std::string getLockID();
+
+	const char* getObjectName() const;
+	static const char* getClassName();
+};
+
+CL_NS_END
+#endif
@@ -26,6 +26,7 @@ public:
   inline uint8_t readByte();
   int32_t readVInt();
   void readBytes(uint8_t* b, const int32_t len);
+  void readChars(TCHAR* buffer, const int32_t start, const int32_t len);
   void close();
   int64_t getFilePointer() const;
   void seek(const int64_t pos);
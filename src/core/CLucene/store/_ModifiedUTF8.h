@@ -0,0 +1,116 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_store_ModifiedUTF8_
+#define _lucene_store_ModifiedUTF8_
+
+CL_NS_DEF(store)
+
+/**
+* Bulk conversion between TCHAR strings and the modified UTF-8 of the index
+* files (1 to 3 bytes per character, 0 written as 2 bytes), working on a
+* whole buffer at a time instead of a virtual readByte()/writeByte() call per
+* byte. Runs of ASCII are checked 8 bytes at a time.
+*/
+class ModifiedUTF8{
+public:
+	/**
+	* Decodes characters from [in,inEnd) into [out,outEnd) until either the
+	* output is full or the next character is not complete in the input.
+	* @return the position after the last byte decoded; out is advanced past
+	* the last character written
+	*/
+	static inline const uint8_t* decode(const uint8_t* in, const uint8_t* inEnd, TCHAR*& out, const TCHAR* outEnd){
+		const uint64_t highBits = (uint64_t)_ILONGLONG(0x8080808080808080);
+		while ( out < outEnd ){
+			while ( outEnd - out >= 8 && inEnd - in >= 8 ){
+				uint64_t w;
+				memcpy(&w, in, 8);
+				if ( (w & highBits) != 0 )
+					break;
+				out[0] = in[0]; out[1] = in[1]; out[2] = in[2]; out[3] = in[3];
+				out[4] = in[4]; out[5] = in[5]; out[6] = in[6]; out[7] = in[7];
+				in += 8;
+				out += 8;
+			}
+			if ( out >= outEnd || in >= inEnd )
+				break;
+
+			const uint8_t b = *in;
+			if ( (b & 0x80) == 0 ){
+				*out++ = b;
+				in++;
+			}else if ( (b & 0xE0) != 0xE0 ){
+				if ( inEnd - in < 2 )
+					break;
+				*out++ = ((b & 0x1F) << 6) | (in[1] & 0x3F);
+				in += 2;
+			}else{
+				if ( inEnd - in < 3 )
+					break;
+				*out++ = ((b & 0x0F) << 12) | ((in[1] & 0x3F) << 6) | (in[2] & 0x3F);
+				in += 3;
+			}
+		}
+		return in;
+	}
+
+	/**
+	* Encodes characters from [in,inEnd) into [out,outEnd) while there is
+	* room for the longest (3 byte) encoding.
+	* @return the position after the last character encoded; out is advanced
+	* past the last byte written
+	*/
+	static inline const TCHAR* encode(const TCHAR* in, const TCHAR* inEnd, uint8_t*& out, const uint8_t* outEnd){
+		while ( in < inEnd && outEnd - out >= 3 ){
+			const int32_t code = (int32_t)*in++;
+			if ( code >= 0x01 && code <= 0x7F ){
+				*out++ = (uint8_t)code;
+			}else if ( ((code >= 0x80) && (code <= 0x7FF)) || code == 0 ){
+				*out++ = (uint8_t)(0xC0 | (code >> 6));
+				*out++ = (uint8_t)(0x80 | (code & 0x3F));
+			}else{
+				*out++ = (uint8_t)(0xE0 | (((uint32_t)code) >> 12)); //unsigned shift
+				*out++ = (uint8_t)(0x80 | ((code >> 6) & 0x3F));
+				*out++ = (uint8_t)(0x80 | (code & 0x3F));
+			}
+		}
+		return in;
+	}
+
+	/**
+	* Compares len characters of text with the characters encoded in
+	* [in,inEnd), in the order of _tcscmp.
+	* @return a negative number, 0 or a positive number if text is less than,
+	* equal to or greater than the encoded characters
+	*/
+	static inline int32_t compare(const TCHAR* text, size_t len, const uint8_t* in, const uint8_t* inEnd){
+		const TCHAR* textEnd = text + len;
+		while ( text < textEnd && in < inEnd ){
+			int32_t c;
+			const uint8_t b = *in;
+			if ( (b & 0x80) == 0 ){
+				c = b;
+				in++;
+			}else if ( (b & 0xE0) != 0xE0 ){
+				c = ((b & 0x1F) << 6) | (in[1] & 0x3F);
+				in += 2;
+			}else{
+				c = ((b & 0x0F) << 12) | ((in[1] & 0x3F) << 6) | (in[2] & 0x3F);
+				in += 3;
+			}
+			const int32_t t = (int32_t)*text++;
+			if ( t != c )
+				return t < c ? -1 : 1;
+		}
+		if ( text < textEnd )
+			return 1;
+		return in < inEnd ? -1 : 0;
+	}
+};
+
+CL_NS_END
+#endif
@@ -0,0 +1,79 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_store_RateLimitedIndexOutput_
+#define _lucene_store_RateLimitedIndexOutput_
+
+#include "Directory.h"
+#include "IndexOutput.h"
+
+CL_NS_DEF(store)
+
+class RateLimiter;
+
+/**
+* An IndexOutput that reports the bytes written to it to a RateLimiter.
+* The bytes are passed on to the wrapped output as they are written;
+* the limiter is called for every CHUNK_SIZE bytes so that it is not
+* locked for each byte.
+*/
+class RateLimitedIndexOutput: public IndexOutput{
+	IndexOutput* delegate;
+	RateLimiter* limiter;
+	int32_t pending;	// bytes not yet reported to the limiter
+
+	void reportPending();
+public:
+	LUCENE_STATIC_CONSTANT(int32_t, CHUNK_SIZE=65536);
+
+	/** @memory delegate is owned by this output */
+	RateLimitedIndexOutput(IndexOutput* delegate, RateLimiter* limiter);
+	virtual ~RateLimitedIndexOutput();
+
+	void writeByte(const uint8_t b);
+	void writeBytes(const uint8_t* b, const int32_t length);
+	void copyBytes(IndexInput* input, int64_t numBytes);
+	void close();
+	int64_t getFilePointer() const;
+	void seek(const int64_t pos);
+	int64_t length() const;
+	void flush();
+};
+
+/**
+* A Directory that delegates everything to another Directory, but wraps
+* the outputs it creates in a RateLimitedIndexOutput.
+* Used by SegmentMerger for the files of the merged segment.
+*/
+class RateLimitedDirectory: public Directory{
+	Directory* delegate;
+	RateLimiter* limiter;
+protected:
+	bool doDeleteFile(const char* name);
+public:
+	RateLimitedDirectory(Directory* delegate, RateLimiter* limiter);
+	virtual ~RateLimitedDirectory();
+
+	bool list(std::vector<std::string>* names) const;
+	bool fileExists(const char* name) const;
+	int64_t fileModified(const char* name) const;
+	int64_t fileLength(const char* name) const;
+	bool openInput(const char* name, IndexInput*& ret, CLuceneError& error, int32_t bufferSize = -1);
+	void touchFile(const char* name);
+	void renameFile(const char* from, const char* to);
+	IndexOutput* createOutput(const char* name);
+	LuceneLock* makeLock(const char* name);
+	void clearLock(const char* name);
+	void close();
+	std::string toString() const;
+	std::string getLockID();
+
+	const char* getObjectName() const;
+	static const char* getClassName();
+};
+
+CL_NS_END
+#endif
@@ -0,0 +1,66 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_store_intl_StatsDirectory_
+#define _lucene_store_intl_StatsDirectory_
+
+#include "IndexInput.h"
+#include "IndexOutput.h"
+#include "StatsDirectory.h"
+
+CL_NS_DEF(store)
+
+/**
+* An input of a StatsDirectory. Reads from the wrapped input through its
+* unbuffered path, one buffer at a time, and counts each read and seek.
+*/
+class StatsIndexInput: public BufferedIndexInput{
+	IndexInput* delegate;
+	IOStats* stats;
+	IOStats::Counters* counters;
+
+	StatsIndexInput(const StatsIndexInput& clone);
+protected:
+	void readInternal(uint8_t* b, const int32_t len);
+	void seekInternal(const int64_t pos);
+public:
+	/** @memory delegate is owned by this input */
+	StatsIndexInput(IndexInput* delegate, IOStats* stats, IOStats::Counters* counters, int32_t bufferSize = -1);
+	virtual ~StatsIndexInput();
+
+	IndexInput* clone() const;
+	void seek(const int64_t pos);
+	void close();
+	int64_t length() const;
+
+	const char* getDirectoryType() const;
+	const char* getObjectName() const;
+	static const char* getClassName();
+};
+
+/**
+* An output of a StatsDirectory. Passes its buffer on to the wrapped output
+* when it is full, and counts each write.
+*/
+class StatsIndexOutput: public BufferedIndexOutput{
+	IndexOutput* delegate;
+	IOStats* stats;
+	IOStats::Counters* counters;
+	bool closed;
+protected:
+	void flushBuffer(const uint8_t* b, const int32_t len);
+public:
+	/** @memory delegate is owned by this output */
+	StatsIndexOutput(IndexOutput* delegate, IOStats* stats, IOStats::Counters* counters);
+	virtual ~StatsIndexOutput();
+
+	void close();
+	void seek(const int64_t pos);
+	int64_t length() const;
+};
+
+CL_NS_END
+#endif
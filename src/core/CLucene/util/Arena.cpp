@@ -0,0 +1,155 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "Arena.h"
+#include "CLucene/config/_threads.h"
+
+CL_NS_DEF(util)
+
+// Every allocation is preceded by a header holding its arena, or NULL if it
+// came from the heap. The header keeps the objects 16 byte aligned.
+union AllocationHeader{
+	Arena* arena;
+	double align[2];
+};
+#define HEADER_SIZE sizeof(AllocationHeader)
+
+struct Arena::Block{
+	Block* next;
+};
+#define BLOCK_HEADER_SIZE HEADER_SIZE
+
+// The current arena of each thread
+#if defined(_CL_DISABLE_MULTITHREADING)
+	static Arena* currentArena = NULL;
+	#define GET_CURRENT_ARENA() currentArena
+	#define SET_CURRENT_ARENA(a) currentArena = (a)
+#elif defined(_CL_HAVE_WIN32_THREADS)
+	#ifndef _WINBASE_
+	extern "C"{
+		__declspec(dllimport) _cl_dword_t __stdcall TlsAlloc();
+		__declspec(dllimport) void* __stdcall TlsGetValue(_cl_dword_t);
+		__declspec(dllimport) bool __stdcall TlsSetValue(_cl_dword_t, void*);
+	}
+	#endif
+	static _cl_dword_t arenaKey = TlsAlloc();
+	#define GET_CURRENT_ARENA() ((Arena*)TlsGetValue(arenaKey))
+	#define SET_CURRENT_ARENA(a) TlsSetValue(arenaKey, (a))
+#elif defined(_CL_HAVE_PTHREAD)
+	static pthread_key_t arenaKey;
+	static pthread_once_t arenaKeyOnce = PTHREAD_ONCE_INIT;
+	static void makeArenaKey(){
+		pthread_key_create(&arenaKey, NULL);
+	}
+	#define GET_CURRENT_ARENA() ((Arena*)pthread_getspecific(arenaKey))
+	#define SET_CURRENT_ARENA(a) pthread_setspecific(arenaKey, (a))
+#endif
+
+// Number of arenas current in any thread, so that allocations don't look
+// up the current arena when no thread uses one
+static _LUCENE_ATOMIC_INT activeArenas;
+
+
+Arena::Arena():
+	blocks(NULL),
+	blockPos(NULL),
+	blockEnd(NULL),
+	previous(NULL),
+	objectCount(0),
+	blockCount(0)
+{
+	_LUCENE_ATOMIC_INT_SET(refs, 1);
+}
+Arena::~Arena(){
+	while ( blocks != NULL ){
+		Block* next = blocks->next;
+		free(blocks);
+		blocks = next;
+	}
+}
+
+Arena* Arena::begin(){
+#if defined(_CL_HAVE_PTHREAD) && !defined(_CL_DISABLE_MULTITHREADING)
+	pthread_once(&arenaKeyOnce, makeArenaKey);
+#endif
+	Arena* ret = _CLNEW Arena();
+	ret->previous = current();
+	SET_CURRENT_ARENA(ret);
+	_LUCENE_ATOMIC_INC(&activeArenas);
+	return ret;
+}
+
+void Arena::end(){
+	CND_PRECONDITION(current() == this, "arena is not the current arena");
+	SET_CURRENT_ARENA(previous);
+	_LUCENE_ATOMIC_DEC(&activeArenas);
+	decRef();
+}
+
+Arena* Arena::current(){
+	if ( _LUCENE_ATOMIC_INT_GET(activeArenas) == 0 )
+		return NULL;
+	return GET_CURRENT_ARENA();
+}
+
+int32_t Arena::getObjectCount() const{
+	return objectCount;
+}
+int32_t Arena::getBlockCount() const{
+	return blockCount;
+}
+
+void* Arena::alloc(size_t size){
+	// round up to keep the next object aligned
+	size = (size + HEADER_SIZE + HEADER_SIZE - 1) & ~(HEADER_SIZE - 1);
+	if ( blockPos == NULL || (size_t)(blockEnd - blockPos) < size ){
+		Block* block = (Block*)malloc(BLOCK_SIZE);
+		if ( block == NULL )
+			_CLTHROWA(CL_ERR_OutOfMemory, "Arena::alloc");
+		block->next = blocks;
+		blocks = block;
+		blockPos = (uint8_t*)block + BLOCK_HEADER_SIZE;
+		blockEnd = (uint8_t*)block + BLOCK_SIZE;
+		blockCount++;
+	}
+	AllocationHeader* header = (AllocationHeader*)blockPos;
+	header->arena = this;
+	blockPos += size;
+	objectCount++;
+	_LUCENE_ATOMIC_INC(&refs);
+	return (uint8_t*)header + HEADER_SIZE;
+}
+
+void Arena::decRef(){
+	if ( _LUCENE_ATOMIC_DEC(&refs) == 0 )
+		delete this;
+}
+
+void* Arena::allocate(size_t size){
+	Arena* arena = current();
+	// objects that don't fit comfortably in a block come from the heap
+	if ( arena != NULL && size <= BLOCK_SIZE / 4 )
+		return arena->alloc(size);
+
+	AllocationHeader* header = (AllocationHeader*)malloc(HEADER_SIZE + size);
+	if ( header == NULL )
+		_CLTHROWA(CL_ERR_OutOfMemory, "Arena::allocate");
+	header->arena = NULL;
+	return (uint8_t*)header + HEADER_SIZE;
+}
+
+void Arena::deallocate(void* p){
+	if ( p == NULL )
+		return;
+	AllocationHeader* header = (AllocationHeader*)((uint8_t*)p - HEADER_SIZE);
+	if ( header->arena != NULL )
+		header->arena->decRef();
+	else
+		free(header);
+}
+
+CL_NS_END
@@ -0,0 +1,94 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_util_Arena_
+#define _lucene_util_Arena_
+
+#include "CLucene/LuceneThreads.h"
+
+CL_NS_DEF(util)
+
+/**
+* Expert: a bump allocator for the many small, short lived objects of a
+* search (weights, scorers, term docs, phrase positions).
+*
+* <p>While an arena is current in a thread (between {@link #begin} and
+* {@link #end}), the objects of the classes that declare
+* LUCENE_ARENA_ALLOCATED are carved out of the arena's blocks instead of
+* being allocated one by one from the heap. Deleting such an object runs its
+* destructor as usual but does not free its memory; the blocks of the arena
+* are freed at once when the arena has ended and all of its objects have been
+* deleted. An object may therefore outlive the search that created it, and
+* may be deleted by another thread.</p>
+*
+* <p>Outside of an arena, the objects come from the heap as before.</p>
+*
+* <p>The classes only allocate from arenas if CLucene was compiled with
+* LUCENE_ENABLE_ARENA (see CLConfig.h), since their allocations would
+* otherwise all pay for the check and the header. Without it, arenas can be
+* begun and ended but nothing is allocated from them.</p>
+* @see CL_NS(search)::IndexSearcher#setUseArena
+*/
+class CLUCENE_EXPORT Arena{
+	struct Block;
+	Block* blocks;
+	uint8_t* blockPos;		// next free byte of the current block
+	uint8_t* blockEnd;		// end of the current block
+	_LUCENE_ATOMIC_INT refs;	// live objects, plus one until end() is called
+	Arena* previous;		// the arena that was current when this one began
+	int32_t objectCount;
+	int32_t blockCount;
+
+	Arena();
+	~Arena();
+	void* alloc(size_t size);
+	void decRef();
+public:
+	/** Size of the blocks the objects are carved out of */
+	LUCENE_STATIC_CONSTANT(size_t, BLOCK_SIZE=8192);
+
+	/**
+	* Creates an arena and makes it current in the calling thread. Arenas
+	* nest: the previous arena is current again after end().
+	*/
+	static Arena* begin();
+
+	/**
+	* Stops allocating from this arena; it must be the current arena of the
+	* calling thread. This arena may not be used after this call.
+	*/
+	void end();
+
+	/** The arena current in the calling thread, or NULL */
+	static Arena* current();
+
+	/** Number of objects allocated from this arena */
+	int32_t getObjectCount() const;
+	/** Number of blocks this arena allocated from the heap */
+	int32_t getBlockCount() const;
+
+	/** Allocates size bytes, from the current arena if there is one */
+	static void* allocate(size_t size);
+	/** Frees memory returned by allocate() */
+	static void deallocate(void* p);
+};
+
+CL_NS_END
+
+/**
+* Declares the allocation operators of a class so that its objects are
+* allocated from the current CL_NS(util)::Arena, if any. Expands to nothing
+* unless LUCENE_ENABLE_ARENA is defined.
+*/
+#ifdef LUCENE_ENABLE_ARENA
+	#define LUCENE_ARENA_ALLOCATED \
+		static void* operator new(size_t size){ return CL_NS(util)::Arena::allocate(size); } \
+		static void operator delete(void* p){ CL_NS(util)::Arena::deallocate(p); }
+#else
+	#define LUCENE_ARENA_ALLOCATED
+#endif
+
+#endif
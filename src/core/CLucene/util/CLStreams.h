@@ -164,6 +164,12 @@ class CLUCENE_EXPORT FilteredBufferedReader: public BufferedReader{
 public:
 	FilteredBufferedReader(Reader* reader, bool deleteReader);
 	virtual ~FilteredBufferedReader();
+
+	/**
+	* Reads from reader from now on, keeping the buffer. The previous reader
+	* is deleted if this reader was told to delete it.
+	*/
+	void setInput(Reader* reader);
 	
 	int32_t read(const TCHAR*& start, int32_t min, int32_t max);
 	int64_t position();
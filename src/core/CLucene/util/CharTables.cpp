@@ -0,0 +1,181 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "CharTables.h"
+#include "CLucene/LuceneThreads.h"
+
+CL_NS_DEF(util)
+
+#if defined(LUCENE_USE_INTERNAL_CHAR_FUNCTIONS) && !defined(_ASCII)
+	// the internal functions do not depend on the locale
+	const uint32_t CharTables::classLimit = 0x10000;
+	const uint32_t CharTables::caseLimit = 0x10000;
+#else
+	// the functions of the platform only agree on the classes of ASCII in every
+	// locale; the lower case of I is not i in a turkish locale
+	const uint32_t CharTables::classLimit = 0x80;
+	const uint32_t CharTables::caseLimit = 0;
+#endif
+
+const CharTables::Block* CharTables::blocks[256];
+
+STATIC_DEFINE_MUTEX(BLOCKS_LOCK)
+// incremented between filling a block and publishing it, for the memory barrier
+static _LUCENE_ATOMIC_INT blockCount;
+
+uint8_t CharTables::classOfChar(const TCHAR c){
+	uint8_t ret = 0;
+	if ( _istalpha(c) ) ret |= LETTER;
+	if ( _istdigit(c) ) ret |= DIGIT;
+	if ( _istalnum(c) ) ret |= ALNUM;
+	if ( _istspace(c) ) ret |= SPACE;
+	return ret;
+}
+TCHAR CharTables::toLowerChar(const TCHAR c){
+	return _totlower(c);
+}
+TCHAR CharTables::caseFoldChar(const TCHAR c){
+	TCHAR buf[2];
+	buf[0] = c;
+	buf[1] = 0;
+	stringCaseFold(buf);
+	return buf[0];
+}
+
+const CharTables::Block* CharTables::getBlock(const TCHAR c, const uint32_t limit){
+	const uint32_t u = static_cast<uint32_t>(c);
+	if ( u >= limit )
+		return NULL;
+	const int32_t i = u >> BLOCK_SHIFT;
+
+	SCOPED_LOCK_MUTEX(BLOCKS_LOCK);
+	if ( blocks[i] == NULL ){
+		Block* b = _CLNEW Block;
+		for ( int32_t j=0;j<BLOCK_SIZE;j++ ){
+			const TCHAR ch = static_cast<TCHAR>((i << BLOCK_SHIFT) | j);
+			b->classes[j] = classOfChar(ch);
+			b->lower[j] = static_cast<int32_t>(toLowerChar(ch)) - ch;
+			b->fold[j] = static_cast<int32_t>(caseFoldChar(ch)) - ch;
+		}
+		// readers do not lock, so the block must be filled before it is seen
+		_LUCENE_ATOMIC_INC(&blockCount);
+		blocks[i] = b;
+	}
+	return blocks[i];
+}
+
+uint8_t CharTables::classOfSlow(const TCHAR c){
+	const Block* b = getBlock(c, classLimit);
+	if ( b != NULL )
+		return b->classes[static_cast<uint32_t>(c) & (BLOCK_SIZE-1)];
+	return classOfChar(c);
+}
+TCHAR CharTables::toLowerSlow(const TCHAR c){
+	const Block* b = getBlock(c, caseLimit);
+	if ( b != NULL )
+		return static_cast<TCHAR>(c + b->lower[static_cast<uint32_t>(c) & (BLOCK_SIZE-1)]);
+	return toLowerChar(c);
+}
+TCHAR CharTables::caseFoldSlow(const TCHAR c){
+	const Block* b = getBlock(c, caseLimit);
+	if ( b != NULL )
+		return static_cast<TCHAR>(c + b->fold[static_cast<uint32_t>(c) & (BLOCK_SIZE-1)]);
+	return caseFoldChar(c);
+}
+
+void CharTables::_shutdown(){
+	SCOPED_LOCK_MUTEX(BLOCKS_LOCK);
+	for ( int32_t i=0;i<256;i++ ){
+		Block* b = const_cast<Block*>(blocks[i]);
+		_CLDELETE(b);
+		blocks[i] = NULL;
+	}
+}
+
+void CharTables::toLower(TCHAR* buffer, int32_t len){
+	TCHAR* end = buffer + len;
+	for ( ;buffer<end;buffer++ )
+		*buffer = toLower(*buffer);
+}
+
+void CharTables::caseFold(TCHAR* buffer, int32_t len){
+	TCHAR* end = buffer + len;
+	for ( ;buffer<end;buffer++ )
+		*buffer = caseFold(*buffer);
+}
+
+
+// the replacements of the characters 0xC0 to 0xFF
+static const TCHAR* const latin1Foldings[64] = {
+	_T("A"), _T("A"), _T("A"), _T("A"), _T("A"), _T("A"), _T("AE"), _T("C"),	// 0xC0
+	_T("E"), _T("E"), _T("E"), _T("E"), _T("I"), _T("I"), _T("I"), _T("I"),	// 0xC8
+	_T("D"), _T("N"), _T("O"), _T("O"), _T("O"), _T("O"), _T("O"), NULL,		// 0xD0
+	_T("O"), _T("U"), _T("U"), _T("U"), _T("U"), _T("Y"), _T("TH"), _T("ss"),	// 0xD8
+	_T("a"), _T("a"), _T("a"), _T("a"), _T("a"), _T("a"), _T("ae"), _T("c"),	// 0xE0
+	_T("e"), _T("e"), _T("e"), _T("e"), _T("i"), _T("i"), _T("i"), _T("i"),	// 0xE8
+	_T("d"), _T("n"), _T("o"), _T("o"), _T("o"), _T("o"), _T("o"), NULL,		// 0xF0
+	_T("o"), _T("u"), _T("u"), _T("u"), _T("u"), _T("y"), _T("th"), _T("y")	// 0xF8
+};
+
+const TCHAR* CharTables::accentFolding(const TCHAR c){
+#ifdef _UCS2
+	const uint32_t u = static_cast<uint32_t>(c);
+#else
+	const uint32_t u = static_cast<unsigned char>(c);
+#endif
+	if ( u < 0xC0 )
+		return NULL;
+	if ( u <= 0xFF )
+		return latin1Foldings[u - 0xC0];
+#ifdef _UCS2
+	switch ( u ){
+		case 0x152: return _T("OE");
+		case 0x153: return _T("oe");
+		case 0x178: return _T("Y");
+	}
+#endif
+	return NULL;
+}
+
+int32_t CharTables::foldedAccentsLength(const TCHAR* buffer, int32_t len){
+	int32_t ret = len;
+	bool folded = false;
+	for ( int32_t i=0;i<len;i++ ){
+		const TCHAR* f = accentFolding(buffer[i]);
+		if ( f != NULL ){
+			folded = true;
+			if ( f[1] != 0 )
+				ret++;
+		}
+	}
+	return folded ? ret : -1;
+}
+
+void CharTables::foldAccents(TCHAR* buffer, int32_t len, int32_t foldedLen){
+	// replacements are never shorter than the character they replace, so
+	// the buffer is folded from its end towards its start
+	int32_t to = foldedLen;
+	for ( int32_t from = len-1; from >= 0 && to > from; from-- ){
+		const TCHAR* f = accentFolding(buffer[from]);
+		if ( f == NULL ){
+			buffer[--to] = buffer[from];
+		}else if ( f[1] == 0 ){
+			buffer[--to] = f[0];
+		}else{
+			buffer[--to] = f[1];
+			buffer[--to] = f[0];
+		}
+	}
+	// the characters before the last expansion are folded one to one
+	for ( int32_t i = to-1; i >= 0; i-- ){
+		const TCHAR* f = accentFolding(buffer[i]);
+		if ( f != NULL )
+			buffer[i] = f[0];
+	}
+}
+
+CL_NS_END
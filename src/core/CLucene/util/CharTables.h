@@ -0,0 +1,136 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_util_CharTables_
+#define _lucene_util_CharTables_
+
+CL_NS_DEF(util)
+
+/**
+* Lookup tables for the character functions of the analyzers: letter, digit
+* and space classification, lower casing, case folding and the folding of
+* accented ISO Latin 1 characters.
+*
+* <p>The tables give the same results as the <code>_ist*</code>,
+* <code>_totlower</code> and <code>stringCaseFold</code> functions of the
+* build. They are two levels deep: the high byte of a character selects a
+* block of 256 characters, which is filled with those functions the first
+* time one of its characters is looked up. With the internal character
+* functions the blocks cover the basic multilingual plane. The functions of
+* the platform may depend on the locale, so then the classes only cover
+* ASCII and the cases are not kept in tables. Other characters are passed on
+* to the functions.</p>
+*
+* <p>The functions that take a buffer work in place, so that a filter can
+* apply them to {@link CL_NS(analysis)::Token#termBuffer} directly.</p>
+*/
+class CLUCENE_EXPORT CharTables{
+public:
+	/** Character classes, as returned by {@link #classOf} */
+	enum{
+		LETTER = 1,	///< _istalpha
+		DIGIT = 2,	///< _istdigit
+		ALNUM = 4,	///< _istalnum
+		SPACE = 8	///< _istspace
+	};
+
+	LUCENE_STATIC_CONSTANT(int32_t, BLOCK_SHIFT=8);
+	LUCENE_STATIC_CONSTANT(int32_t, BLOCK_SIZE=256);
+
+	/** The classes, lower cases and case foldings of a block of characters */
+	struct Block{
+		uint8_t classes[BLOCK_SIZE];
+		int32_t lower[BLOCK_SIZE];	// added to the character
+		int32_t fold[BLOCK_SIZE];	// added to the character
+	};
+
+	/** The classes of c, a combination of LETTER, DIGIT, ALNUM and SPACE */
+	static inline uint8_t classOf(const TCHAR c){
+		const uint32_t u = static_cast<uint32_t>(c);
+		if ( u < classLimit ){
+			const Block* b = blocks[u >> BLOCK_SHIFT];
+			if ( b != NULL )
+				return b->classes[u & (BLOCK_SIZE-1)];
+		}
+		return classOfSlow(c);
+	}
+	static inline bool isLetter(const TCHAR c){ return (classOf(c) & LETTER) != 0; }
+	static inline bool isDigit(const TCHAR c){ return (classOf(c) & DIGIT) != 0; }
+	static inline bool isAlnum(const TCHAR c){ return (classOf(c) & ALNUM) != 0; }
+	static inline bool isSpace(const TCHAR c){ return (classOf(c) & SPACE) != 0; }
+
+	/** c in lower case, as _totlower returns it */
+	static inline TCHAR toLower(const TCHAR c){
+		const uint32_t u = static_cast<uint32_t>(c);
+		if ( u < caseLimit ){
+			const Block* b = blocks[u >> BLOCK_SHIFT];
+			if ( b != NULL )
+				return static_cast<TCHAR>(c + b->lower[u & (BLOCK_SIZE-1)]);
+		}
+		return toLowerSlow(c);
+	}
+
+	/** c case folded, as stringCaseFold folds it */
+	static inline TCHAR caseFold(const TCHAR c){
+		const uint32_t u = static_cast<uint32_t>(c);
+		if ( u < caseLimit ){
+			const Block* b = blocks[u >> BLOCK_SHIFT];
+			if ( b != NULL )
+				return static_cast<TCHAR>(c + b->fold[u & (BLOCK_SIZE-1)]);
+		}
+		return caseFoldSlow(c);
+	}
+
+	/** Converts the first len characters of buffer to lower case */
+	static void toLower(TCHAR* buffer, int32_t len);
+
+	/** Case folds the first len characters of buffer */
+	static void caseFold(TCHAR* buffer, int32_t len);
+
+	/**
+	* The unaccented replacement of c, one or two characters, or NULL if c
+	* is not an accented ISO Latin 1 character (or one of the ligatures
+	* &#338;, &#339; and &#376; of the unicode builds)
+	*/
+	static const TCHAR* accentFolding(const TCHAR c);
+
+	/**
+	* The length of the first len characters of buffer once their accents
+	* are folded, or -1 if none of them is accented
+	*/
+	static int32_t foldedAccentsLength(const TCHAR* buffer, int32_t len);
+
+	/**
+	* Replaces the accented characters of the first len characters of
+	* buffer by their unaccented replacements. foldedLen is the length
+	* returned by {@link #foldedAccentsLength}; buffer must have room for
+	* that many characters.
+	*/
+	static void foldAccents(TCHAR* buffer, int32_t len, int32_t foldedLen);
+
+private:
+	// the characters below the limits are looked up in the blocks
+	static const uint32_t classLimit;
+	static const uint32_t caseLimit;
+	// the blocks by the high byte of their characters, NULL until they are filled
+	static const Block* blocks[256];
+
+	// fills the block of c if it is below limit and returns it, or returns NULL
+	static const Block* getBlock(const TCHAR c, const uint32_t limit);
+
+	static uint8_t classOfSlow(const TCHAR c);
+	static TCHAR toLowerSlow(const TCHAR c);
+	static TCHAR caseFoldSlow(const TCHAR c);
+	static uint8_t classOfChar(const TCHAR c);
+	static TCHAR toLowerChar(const TCHAR c);
+	static TCHAR caseFoldChar(const TCHAR c);
+public:
+	/** Cleanup static data */
+	static CLUCENE_LOCAL void _shutdown();
+};
+
+CL_NS_END
+#endif
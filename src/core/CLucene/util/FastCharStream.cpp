@@ -14,9 +14,10 @@ CL_NS_DEF(util)
 const int32_t FastCharStream::maxRewindSize = LUCENE_MAX_WORD_LEN*2;
 
   FastCharStream::FastCharStream(BufferedReader* reader):
-    pos(0),
-    rewindPos(0),
-	resetPos(0),
+    window(NULL),
+    windowLen(0),
+    windowPos(0),
+    counted(0),
 	col(1),
 	line(1),
 	input(reader)
@@ -28,82 +29,71 @@ const int32_t FastCharStream::maxRewindSize = LUCENE_MAX_WORD_LEN*2;
 
   void FastCharStream::reset()
   {
-      pos = 0;
-      rewindPos = 0;
-      resetPos = 0;
+      window = NULL;
+      windowLen = 0;
+      windowPos = 0;
+      counted = 0;
       col = 1;
       line = 1;
-      input->setMinBufSize(maxRewindSize);	
+      input->setMinBufSize(maxRewindSize);
   }
 
-  void FastCharStream::readChar(TCHAR &c) {
+  int FastCharStream::refill()
+  {
+    if (input == 0 ) // end of file
+    {
+      _CLTHROWA(CL_ERR_IO,"warning : FileReader.GetNext : Read TCHAR over EOS.");
+    }
+	countPosition();
 	try{
-		int32_t r = input->read();
-		if ( r == -1 )
+		// go back over the characters that we keep. They are still in the buffer
+		// of the reader, because they were part of the last read
+		int32_t keep = cl_min(windowLen, maxRewindSize);
+		if ( keep > 0 ){
+			int64_t pos = input->position() - keep;
+			if ( input->reset(pos) != pos )
+				keep = 0;
+		}
+
+		int32_t r = input->read(window, keep + 1, LUCENE_INT32_MAX_SHOULDBE);
+		if ( r <= keep ){ // eof
+			window = NULL;
+			windowLen = windowPos = counted = 0;
 			input = NULL;
-		c = r;
+			return -1;
+		}
+		windowLen = r;
+		windowPos = counted = keep;
 	}catch(CLuceneError& err){
 		if ( err.number() == CL_ERR_IO )
 			input = 0;
 		throw err;
 	}
+	return window[windowPos++];
   }
-  int FastCharStream::GetNext()
-  {
-    if (input == 0 ) // end of file
-    {
-      _CLTHROWA(CL_ERR_IO,"warning : FileReader.GetNext : Read TCHAR over EOS.");
-    }
-    // this is rather inefficient
-    // implementing the functions from the java version of
-    // charstream will be much more efficient.
-	++pos;
-    TCHAR ch;
-    readChar(ch);
 
-    if (input == NULL) { // eof
-        return -1;
-    }
-    if (rewindPos == 0) {
-        col += 1;
-        if(ch == '\n') {
-            line++;
-            col = 1;
-        }
-    } else {
-        rewindPos--;
-    }
-    return ch;
+  void FastCharStream::unGetFailed(){
+    _CLTHROWA(CL_ERR_IO,"error : No character can be UnGet");
   }
 
-  void FastCharStream::UnGet(){
-//      printf("UnGet \n");
-    if (input == 0) 
-		return;
-    if ( pos == 0 ) {
-      _CLTHROWA(CL_ERR_IO,"error : No character can be UnGet");
+  void FastCharStream::countPosition() {
+    // characters that were UnGet are counted when they are read again
+    for ( ;counted < windowPos;counted++ ){
+      col += 1;
+      if ( window[counted] == '\n' ) {
+        line++;
+        col = 1;
+      }
     }
-    rewindPos++;
-
-	input->reset(pos-1);
-    pos--;
-  }
-
-  int FastCharStream::Peek() {
-    int c = GetNext();
-    UnGet();
-    return c;
-  }
-
-  bool FastCharStream::Eos() const {
-	return input==NULL;
   }
 
-  int32_t FastCharStream::Column() const {
+  int32_t FastCharStream::Column() {
+	countPosition();
 	return col;
   }
 
-  int32_t FastCharStream::Line() const {
+  int32_t FastCharStream::Line() {
+	countPosition();
 	return line;
   }
 CL_NS_END
@@ -0,0 +1,66 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "_ProfileHook.h"
+#include "CLucene/config/_threads.h"
+
+CL_NS_DEF(util)
+
+// The current hook of each thread
+#if defined(_CL_DISABLE_MULTITHREADING)
+	static ProfileHook* currentHook = NULL;
+	#define GET_CURRENT_HOOK() currentHook
+	#define SET_CURRENT_HOOK(h) currentHook = (h)
+#elif defined(_CL_HAVE_WIN32_THREADS)
+	#ifndef _WINBASE_
+	extern "C"{
+		__declspec(dllimport) _cl_dword_t __stdcall TlsAlloc();
+		__declspec(dllimport) void* __stdcall TlsGetValue(_cl_dword_t);
+		__declspec(dllimport) bool __stdcall TlsSetValue(_cl_dword_t, void*);
+	}
+	#endif
+	static _cl_dword_t hookKey = TlsAlloc();
+	#define GET_CURRENT_HOOK() ((ProfileHook*)TlsGetValue(hookKey))
+	#define SET_CURRENT_HOOK(h) TlsSetValue(hookKey, (h))
+#elif defined(_CL_HAVE_PTHREAD)
+	static pthread_key_t hookKey;
+	static pthread_once_t hookKeyOnce = PTHREAD_ONCE_INIT;
+	static void makeHookKey(){
+		pthread_key_create(&hookKey, NULL);
+	}
+	#define GET_CURRENT_HOOK() ((ProfileHook*)pthread_getspecific(hookKey))
+	#define SET_CURRENT_HOOK(h) pthread_setspecific(hookKey, (h))
+#endif
+
+// Number of hooks current in any thread, so that the index and store code
+// doesn't look up the current hook when nothing is profiled
+static _LUCENE_ATOMIC_INT activeHooks;
+
+
+ProfileHook::~ProfileHook(){
+}
+
+ProfileHook* ProfileHook::current(){
+	if ( _LUCENE_ATOMIC_INT_GET(activeHooks) == 0 )
+		return NULL;
+	return GET_CURRENT_HOOK();
+}
+
+ProfileHook* ProfileHook::setCurrent(ProfileHook* hook){
+#if defined(_CL_HAVE_PTHREAD) && !defined(_CL_DISABLE_MULTITHREADING)
+	pthread_once(&hookKeyOnce, makeHookKey);
+#endif
+	ProfileHook* previous = current();
+	if ( hook != NULL && previous == NULL )
+		_LUCENE_ATOMIC_INC(&activeHooks);
+	else if ( hook == NULL && previous != NULL )
+		_LUCENE_ATOMIC_DEC(&activeHooks);
+	SET_CURRENT_HOOK(hook);
+	return previous;
+}
+
+CL_NS_END
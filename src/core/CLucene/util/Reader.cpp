@@ -49,8 +49,9 @@ void StringReader::init ( const TCHAR* _value, const int32_t _length, bool copyD
             this->buffer_size = length;
         }
         else if ( length > this->buffer_size || length < (this->buffer_size/2) )
-        { //expand, or shrink
-            tmp = (TCHAR*)realloc(tmp, sizeof(TCHAR) * (length+1));
+        { //expand, or shrink. the buffer is an array, so it cannot be realloc'ed
+            _CLDELETE_LARRAY(tmp);
+            tmp = _CL_NEWARRAY(TCHAR, length+1);
             this->buffer_size = length;
         }
 
@@ -461,6 +462,12 @@ public:
 		void _setMinBufSize(int32_t min){
 			this->setMinBufSize(min);
 		}
+		void setInput(Reader* input){
+			if ( deleteInput && input != this->input )
+				_CLDELETE(this->input);
+			this->input = input;
+			resetBuffer();
+		}
 	};
 	JStreamsFilteredBuffer* jsbuffer;
 
@@ -477,6 +484,9 @@ FilteredBufferedReader::FilteredBufferedReader(Reader* reader, bool deleteReader
 FilteredBufferedReader::~FilteredBufferedReader(){
 	delete _internal;
 }
+void FilteredBufferedReader::setInput(Reader* reader){
+	_internal->jsbuffer->setInput(reader);
+}
 int32_t FilteredBufferedReader::read(const TCHAR*& start, int32_t min, int32_t max){
 	return _internal->jsbuffer->read(start,min,max);
 }
@@ -12,17 +12,30 @@ CL_CLASS_DEF(util,BufferedReader)
 
 CL_NS_DEF(util)
 
-	/** Ported implementation of the FastCharStream class. */
+	/**
+	* Ported implementation of the FastCharStream class.
+	*
+	* Characters are read from a window into the buffer of the reader, so
+	* that GetNext() and UnGet() only go to the reader when the window is
+	* used up. The last characters of a window are kept in the next one, so
+	* that they can still be UnGet.
+	*/
 	class FastCharStream
 	{
 		static const int32_t maxRewindSize;
-		int32_t pos;
-		int32_t rewindPos;
-		int64_t resetPos;
+		const TCHAR* window;
+		int32_t windowLen;
+		int32_t windowPos;	// the next character of the window
+		int32_t counted;	// the characters of the window that are counted in col and line
 		int32_t col;
 		int32_t line;
-		// read character from stream throws an exception on error
-		void readChar(TCHAR &);	
+
+		// reads the next window and returns its first new character, or -1
+		int refill();
+		// counts the characters read since the last count in col and line
+		void countPosition();
+		// throws the error of an UnGet before the first character
+		void unGetFailed();
 	public:
 		BufferedReader* input;
 
@@ -31,24 +44,54 @@ CL_NS_DEF(util)
 		virtual ~FastCharStream();
 
         void reset();
-		
-		/// Returns the next TCHAR from the stream.
-		int GetNext();
 
-		void UnGet();
-		
+		/// Returns the next TCHAR from the stream, or -1 at the end of the stream.
+		inline int GetNext(){
+			if ( windowPos < windowLen )
+				return window[windowPos++];
+			return refill();
+		}
+
+		inline void UnGet(){
+			if ( input == 0 )
+				return;
+			if ( windowPos == 0 )
+				unGetFailed();
+			windowPos--;
+		}
+
 		/// Returns the current top TCHAR from the input stream without removing it.
-		int Peek();
-		
-		
+		inline int Peek(){
+			int c = GetNext();
+			UnGet();
+			return c;
+		}
+
+
 		/// Returns <b>True</b> if the end of stream was reached.
-		bool Eos() const;
+		inline bool Eos() const{
+			return input == NULL;
+		}
+
+		/**
+		* The characters that can be read without going to the reader, starting
+		* with the one GetNext() would return. Read them with {@link #Skip}.
+		*/
+		inline const TCHAR* Available(int32_t& count) const{
+			count = windowLen - windowPos;
+			return window + windowPos;
+		}
+
+		/// Skips count characters returned by Available()
+		inline void Skip(int32_t count){
+			windowPos += count;
+		}
 
 		/// Gets the current column.
-		int32_t Column() const;
+		int32_t Column();
 
 		/// Gets the current line.
-		int32_t Line() const;
+		int32_t Line();
 	};
 CL_NS_END
 #endif
@@ -0,0 +1,48 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_util_ProfileHook_
+#define _lucene_util_ProfileHook_
+
+CL_NS_DEF(util)
+
+/**
+* Receives the term dictionary lookups and the bytes read by the calling
+* thread, while it is current. The index and store code reports to the
+* current hook, so that they don't depend on the profiler that implements it
+* (see search/QueryProfile).
+*/
+class ProfileHook{
+public:
+	virtual ~ProfileHook();
+
+	/** Records a term dictionary lookup that took the given time */
+	virtual void termLookup(int64_t micros) = 0;
+	/** Records bytes read from an index input */
+	virtual void bytesRead(int64_t bytes) = 0;
+
+	/**
+	* The hook current in the calling thread, or NULL. While no thread has a
+	* hook, this is a single check.
+	*/
+	static ProfileHook* current();
+
+	/**
+	* Makes hook current in the calling thread, or clears the current hook if
+	* hook is NULL. Returns the hook that was current before.
+	*/
+	static ProfileHook* setCurrent(ProfileHook* hook);
+
+	/** Records bytes read with the current hook, if there is one */
+	static void recordBytesRead(int64_t bytes){
+		ProfileHook* hook = current();
+		if ( hook != NULL )
+			hook->bytesRead(bytes);
+	}
+};
+
+CL_NS_END
+#endif
@@ -32,6 +32,8 @@
 #cmakedefine _CL_HAVE_FUNCTION_PRINTF  1 
 #cmakedefine _CL_HAVE_FUNCTION_SNPRINTF  1 
 #cmakedefine _CL_HAVE_FUNCTION_MMAP  1 
+#cmakedefine _CL_HAVE_FUNCTION_COPY_FILE_RANGE  1
+#cmakedefine _CL_HAVE_FUNCTION_SENDFILE  1
 #cmakedefine _CL_HAVE_FUNCTION_STRLWR 1
 #cmakedefine _CL_HAVE_FUNCTION_STRTOLL 1
 #cmakedefine _CL_HAVE_FUNCTION_STRUPR 1
@@ -155,6 +155,22 @@ uint64_t Misc::currentTimeMillis() {
 #endif
 }
 
+int64_t Misc::currentTimeMicros() {
+#ifndef _CL_HAVE_FUNCTION_GETTIMEOFDAY
+    struct _timeb tstruct;
+    _ftime(&tstruct);
+
+    return ((((int64_t) tstruct.time) * 1000) + tstruct.millitm) * 1000;
+#else
+    struct timeval tstruct;
+    if (gettimeofday(&tstruct, NULL) < 0) {
+			return 0;
+    }
+
+    return (((int64_t) tstruct.tv_sec) * 1000000) + tstruct.tv_usec;
+#endif
+}
+
 //static
 const TCHAR* Misc::replace_all( const TCHAR* val, const TCHAR* srch, const TCHAR* repl )
 {
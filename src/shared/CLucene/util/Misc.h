@@ -16,6 +16,9 @@ CL_NS_DEF(util)
     static void zerr(int ret, std::string& err);
   public:
     static uint64_t currentTimeMillis();
+    /** Microseconds since the epoch, for timing short operations.
+    * Only as precise as the platform's clock: milliseconds without gettimeofday. */
+    static int64_t currentTimeMicros();
     static const TCHAR* replace_all( const TCHAR* val, const TCHAR* srch, const TCHAR* repl );
     static bool dir_Exists(const char* path);
     static int64_t file_Size(const char* path);
@@ -6,6 +6,48 @@
 ------------------------------------------------------------------------------*/
 #include "test.h"
 #include "CLucene/analysis/standard/StandardTokenizer.h"
+#include "CLucene/util/CharTables.h"
+// the character functions the library is built with
+#include "CLucene/config/repl_wctype.h"
+#include <new>
+#include <stdlib.h>
+
+// Counts the allocations made while countAllocations is set, so that tests
+// can check that a code path does not allocate. The replaced global operators
+// also serve the allocations of a shared library on ELF and Mach-O, but not of
+// a Windows DLL, which keeps the operators it was linked with: there they are
+// only replaced in the monolithic test programs, which compile the library
+// into the test program.
+#if !(defined(_WIN32) || defined(_WIN64)) || defined(MAKE_CLUCENE_CORE_LIB)
+#define _TEST_COUNT_ALLOCATIONS
+
+static bool countAllocations = false;
+static int32_t allocations = 0;
+
+#if __cplusplus < 201103L
+  #define _TEST_THROW_BAD_ALLOC throw(std::bad_alloc)
+  #define _TEST_NOTHROW throw()
+#else
+  #define _TEST_THROW_BAD_ALLOC
+  #define _TEST_NOTHROW noexcept
+#endif
+
+static void* countedAlloc(size_t size){
+	if ( countAllocations )
+		allocations++;
+	void* ret = malloc(size == 0 ? 1 : size);
+	if ( ret == NULL )
+		throw std::bad_alloc();
+	return ret;
+}
+void* operator new(size_t size) _TEST_THROW_BAD_ALLOC { return countedAlloc(size); }
+void* operator new[](size_t size) _TEST_THROW_BAD_ALLOC { return countedAlloc(size); }
+void operator delete(void* p) _TEST_NOTHROW { free(p); }
+void operator delete[](void* p) _TEST_NOTHROW { free(p); }
+// the sized forms, which code compiled as C++14 calls
+void operator delete(void* p, size_t) _TEST_NOTHROW { free(p); }
+void operator delete[](void* p, size_t) _TEST_NOTHROW { free(p); }
+#endif
 
 // Ported from Java Lucene tests
 
@@ -135,6 +177,61 @@
     _CLLDELETE(a);
   }
 
+  void testStopWordSet(CuTest *tc){
+    const TCHAR* words[] = { _T("the"), _T("And"), _T("a"), _T("the"), _T("AND"), NULL };
+    StopWordSet* set = _CLNEW StopWordSet(words);
+    CLUCENE_ASSERT(set->size() == 4);
+    CLUCENE_ASSERT(set->contains(_T("the")));
+    CLUCENE_ASSERT(set->contains(_T("theory"), 3));
+    CLUCENE_ASSERT(!set->contains(_T("theory")));
+    CLUCENE_ASSERT(!set->contains(_T("th")));
+    CLUCENE_ASSERT(!set->contains(_T("and")));
+    CLUCENE_ASSERT(!set->contains(_T("")));
+    _CLDECDELETE(set);
+
+    set = _CLNEW StopWordSet(words, true);
+    CLUCENE_ASSERT(set->size() == 3);
+    CLUCENE_ASSERT(set->contains(_T("and")));
+    CLUCENE_ASSERT(!set->contains(_T("And")));
+
+    // a set of many words, one of which is empty
+    CLTCSetList list(true);
+    TCHAR buf[20];
+    for ( int32_t i=0;i<1000;i++ ){
+      _sntprintf(buf, 20, _T("w%d"), i);
+      list.insert(STRDUP_TtoT(buf));
+    }
+    list.insert(STRDUP_TtoT(_T("")));
+    StopWordSet* many = _CLNEW StopWordSet(&list);
+    CLUCENE_ASSERT(many->size() == 1001);
+    for ( int32_t i=0;i<1000;i++ ){
+      _sntprintf(buf, 20, _T("w%d"), i);
+      CLUCENE_ASSERT(many->contains(buf));
+      _sntprintf(buf, 20, _T("x%d"), i);
+      CLUCENE_ASSERT(!many->contains(buf));
+    }
+    CLUCENE_ASSERT(many->contains(_T("")));
+    _CLDECDELETE(many);
+
+    // shared by analyzers and filters, which fold the tokens
+    Analyzer* a1 = _CLNEW StopAnalyzer(set);
+    Analyzer* a2 = _CLNEW StandardAnalyzer(set);
+    assertAnalyzesTo(tc,a1, _T("foo AND bar The"), _T("foo;bar;"));
+    assertAnalyzesTo(tc,a2, _T("foo AND bar The"), _T("foo;bar;"));
+    _CLLDELETE(a1);
+    StringReader reader(_T("foo AND bar The"));
+    WhitespaceTokenizer ws(&reader);
+    StopFilter filter(&ws, false, set, true);
+    CL_NS(analysis)::Token t;
+    CLUCENE_ASSERT(filter.next(&t) != NULL);
+    CuAssertStrEquals(tc, _T("token"), _T("foo"), t.termBuffer());
+    CLUCENE_ASSERT(filter.next(&t) != NULL);
+    CuAssertStrEquals(tc, _T("token"), _T("bar"), t.termBuffer());
+    CLUCENE_ASSERT(filter.next(&t) == NULL);
+    _CLLDELETE(a2);
+    _CLDECDELETE(set);
+  }
+
   class BuffTokenFilter : public TokenFilter {
   public:
       std::list<Token*>* lst;
@@ -323,6 +420,111 @@
        _CLDELETE(a);
    }
 
+  // A reader that is not buffered, and returns a few characters per read
+  class TrickleReader: public Reader{
+      const TCHAR* value;
+      int32_t length;
+      int32_t pos;
+  public:
+      TrickleReader(const TCHAR* value):value(value),length(_tcslen(value)),pos(0){}
+      int32_t read(const TCHAR*& start, int32_t /*min*/, int32_t max){
+          if ( pos == length )
+              return -1;
+          int32_t n = 1 + pos % 3;
+          if ( max > 0 && n > max )
+              n = max;
+          if ( n > length - pos )
+              n = length - pos;
+          start = value + pos;
+          pos += n;
+          return n;
+      }
+      int64_t skip(int64_t ntoskip){
+          int64_t n = length - pos;
+          if ( ntoskip < n )
+              n = ntoskip;
+          pos += (int32_t)n;
+          return n;
+      }
+      int64_t position(){ return pos; }
+      size_t size(){ return length; }
+  };
+
+  // The tokens, types and offsets must not depend on how the reader buffers the text
+  void testStandardTokenizerBuffering(CuTest *tc){
+      const TCHAR* text = _T("The U.S.A. and AT&T, O'Reilly 1.5 -3 192.168.0.1 ")
+          _T("foo@example.com wi-fi www.example.com x-1 1..2 3.14.15 a. b- _under_score word.--next end");
+      const TCHAR* expected[] = {
+          _T("The"), _T("<ALPHANUM>"), _T("U.S.A."), _T("<ACRONYM>"), _T("and"), _T("<ALPHANUM>"),
+          _T("AT&T"), _T("<COMPANY>"), _T("O'Reilly"), _T("<APOSTROPHE>"), _T("1.5"), _T("<NUM>"),
+          _T("-3"), _T("<NUM>"), _T("192.168.0.1"), _T("<HOST>"),
+          _T("foo@example.com"), _T("<EMAIL>"), _T("wi"), _T("<ALPHANUM>"), _T("fi"), _T("<ALPHANUM>"),
+          NULL
+      };
+
+      StringReader stringReader(text);
+      StandardTokenizer buffered(&stringReader);
+      TrickleReader trickleReader(text);
+      StandardTokenizer trickled(_CLNEW StringReader(_T("")), true);
+      trickled.reset(&trickleReader);
+
+      Token t1, t2;
+      int32_t i = 0;
+      while ( buffered.next(&t1) != NULL ){
+          CLUCENE_ASSERT(trickled.next(&t2) != NULL);
+          CuAssertStrEquals(tc, _T("term"), t1.termBuffer(), t2.termBuffer());
+          CuAssertStrEquals(tc, _T("type"), t1.type(), t2.type());
+          CuAssertIntEquals(tc, _T("start offset"), t1.startOffset(), t2.startOffset());
+          CuAssertIntEquals(tc, _T("end offset"), t1.endOffset(), t2.endOffset());
+          CuAssertIntEquals(tc, _T("term length"), _tcslen(t1.termBuffer()), t1.termLength());
+
+          if ( expected[i] != NULL ){
+              CuAssertStrEquals(tc, _T("expected term"), expected[i], t1.termBuffer());
+              CuAssertStrEquals(tc, _T("expected type"), expected[i+1], t1.type());
+              CLUCENE_ASSERT(_tcsncmp(text + t1.startOffset(), t1.termBuffer(), t1.termLength()) == 0);
+              i += 2;
+          }
+      }
+      CLUCENE_ASSERT(expected[i] == NULL);
+      CLUCENE_ASSERT(trickled.next(&t2) == NULL);
+  }
+
+  void testCharTables(CuTest *tc){
+	#ifdef _UCS2
+	  // the tables and the slow path past them
+	  const int32_t last = 0x20000;
+	#else
+	  const int32_t last = 0xFF;
+	#endif
+	  for ( int32_t i=0;i<=last;i++ ){
+		  const TCHAR c = (TCHAR)i;
+		  TCHAR folded[2] = { c, 0 };
+		  stringCaseFold(folded);
+		  CLUCENE_ASSERT(CharTables::isLetter(c) == (_istalpha(c) != 0));
+		  CLUCENE_ASSERT(CharTables::isDigit(c) == (_istdigit(c) != 0));
+		  CLUCENE_ASSERT(CharTables::isAlnum(c) == (_istalnum(c) != 0));
+		  CLUCENE_ASSERT(CharTables::isSpace(c) == (_istspace(c) != 0));
+		  CLUCENE_ASSERT(CharTables::toLower(c) == (TCHAR)_totlower(c));
+		  CLUCENE_ASSERT(CharTables::caseFold(c) == folded[0]);
+	  }
+
+	  TCHAR buf[20];
+	  _tcscpy(buf, _T("MiXeD CaSe 123"));
+	  CharTables::toLower(buf, 5);
+	  CuAssertStrEquals(tc, _T("toLower"), _T("mixed CaSe 123"), buf);
+	  CharTables::caseFold(buf, (int32_t)_tcslen(buf));
+	  CuAssertStrEquals(tc, _T("caseFold"), _T("mixed case 123"), buf);
+
+	  // expansions on both ends of the buffer, folded in place
+	  _tcscpy(buf, _T("\xc6t\xe9\xdf"));
+	  CLUCENE_ASSERT(CharTables::foldedAccentsLength(_T("plain"), 5) == -1);
+	  int32_t len = CharTables::foldedAccentsLength(buf, 4);
+	  CLUCENE_ASSERT(len == 6);
+	  CharTables::foldAccents(buf, 4, len);
+	  buf[len] = 0;
+	  CuAssertStrEquals(tc, _T("foldAccents"), _T("AEtess"), buf);
+  }
+
   void testISOLatin1AccentFilter(CuTest *tc){
 	  TCHAR str[200];
 	  _tcscpy(str, _T("Des mot cl\xe9s \xc0 LA CHA\xceNE \xc0 \xc1 \xc2 ") //Des mot cl?s ? LA CHA?NE ? ? ? 
@@ -422,6 +624,27 @@
 	
 	
 	CLUCENE_ASSERT(filter.next(&token)==NULL);
+
+	// a term that doubles in length, which a fixed token buffer cuts
+	TCHAR longTerm[201];
+	TCHAR expected[401];
+	for ( int32_t i=0;i<200;i++ ){
+		longTerm[i] = 0xe6;
+		expected[i*2] = _T('a');
+		expected[i*2+1] = _T('e');
+	}
+	longTerm[200] = 0;
+#ifdef LUCENE_TOKEN_WORD_LENGTH
+	expected[LUCENE_TOKEN_WORD_LENGTH < 400 ? LUCENE_TOKEN_WORD_LENGTH : 400] = 0;
+#else
+	expected[400] = 0;
+#endif
+	StringReader longReader(longTerm);
+	WhitespaceTokenizer longWs(&longReader);
+	ISOLatin1AccentFilter longFilter(&longWs,false);
+	CLUCENE_ASSERT(longFilter.next(&token) != NULL);
+	CuAssertStrEquals(tc, _T("long token"), expected, token.termBuffer());
+	CLUCENE_ASSERT(longFilter.next(&token)==NULL);
   }
 
   void testWordlistLoader(CuTest *tc){
@@ -485,6 +708,76 @@
       _CLLDELETE(reader);
   }
 
+  // Counts the tokens of text, with reader reset to text first
+  int32_t countReusableTokens(Analyzer* a, const TCHAR* field, StringReader* reader, const TCHAR* text, Token* t){
+      reader->init(text, _tcslen(text), false);
+      TokenStream* ts = a->reusableTokenStream(field, reader);
+      int32_t count = 0;
+      while ( ts->next(t) != NULL )
+          count++;
+      return count;
+  }
+  int32_t countTokens(Analyzer* a, const TCHAR* field, const TCHAR* text){
+      StringReader reader(text);
+      TokenStream* ts = a->tokenStream(field, &reader);
+      Token t;
+      int32_t count = 0;
+      while ( ts->next(&t) != NULL )
+          count++;
+      ts->close();
+      _CLDELETE(ts);
+      return count;
+  }
+
+  // Once the streams of an analyzer and the token have grown to fit the text,
+  // reusing them must not allocate anything per field or per token. The
+  // allocations are only counted by the monolithic test programs.
+  void testReusableTokenStreamAllocations(CuTest *tc){
+      const TCHAR* text1 = _T("The quick brown fox, jumped over the lazy dogs. AT&T and I.B.M. sell www.example.com to foo@example.com for 1.5 dollars!");
+      const TCHAR* text2 = _T("A second, somewhat longer field value with other words: supercalifragilisticexpialidocious, and then a few short ones; it is of no use.");
+
+      StandardAnalyzer standard;
+      WhitespaceAnalyzer whitespace;
+      SimpleAnalyzer simple;
+      StopAnalyzer stop;
+      KeywordAnalyzer keyword;
+      PerFieldAnalyzerWrapper perField(_CLNEW SimpleAnalyzer());
+      perField.addAnalyzer(_T("id"), _CLNEW KeywordAnalyzer());
+
+      Analyzer* analyzers[] = { &standard, &whitespace, &simple, &stop, &keyword, &perField, &perField };
+      const TCHAR* fields[] = { _T("dummy"), _T("dummy"), _T("dummy"), _T("dummy"), _T("dummy"), _T("dummy"), _T("id") };
+      const int32_t analyzerCount = sizeof(analyzers) / sizeof(Analyzer*);
+
+      StringReader reader(_T(""), 0, false);
+      Token t;
+      for ( int32_t i=0;i<analyzerCount;i++ ){
+          int32_t expected1 = countTokens(analyzers[i], fields[i], text1);
+          int32_t expected2 = countTokens(analyzers[i], fields[i], text2);
+          CLUCENE_ASSERT(expected1 > 0 && expected2 > 0);
+
+          // warm up: creates the streams and grows the token buffers
+          CLUCENE_ASSERT(countReusableTokens(analyzers[i], fields[i], &reader, text1, &t) == expected1);
+          CLUCENE_ASSERT(countReusableTokens(analyzers[i], fields[i], &reader, text2, &t) == expected2);
+
+#ifdef _TEST_COUNT_ALLOCATIONS
+          allocations = 0;
+          countAllocations = true;
+#endif
+          int32_t count1 = countReusableTokens(analyzers[i], fields[i], &reader, text1, &t);
+          int32_t count2 = countReusableTokens(analyzers[i], fields[i], &reader, text2, &t);
+#ifdef _TEST_COUNT_ALLOCATIONS
+          countAllocations = false;
+#endif
+
+          CLUCENE_ASSERT(count1 == expected1);
+          CLUCENE_ASSERT(count2 == expected2);
+#ifdef _TEST_COUNT_ALLOCATIONS
+          if ( allocations != 0 )
+              CuFail(tc, _T("reusable token stream %d allocated %d times"), i, allocations);
+#endif
+      }
+  }
+
 CuSuite *testanalyzers(void)
 {
 	CuSuite *suite = CuSuiteNew(_T("CLucene Analyzers Test"));
@@ -493,8 +786,10 @@ CuSuite *testanalyzers(void)
     SUITE_ADD_TEST(suite, testSimpleAnalyzer);
     SUITE_ADD_TEST(suite, testNull);
     SUITE_ADD_TEST(suite, testStop);
+    SUITE_ADD_TEST(suite, testStopWordSet);
     SUITE_ADD_TEST(suite, testKeywordTokenizer);
     SUITE_ADD_TEST(suite, testStandardAnalyzer);
+    SUITE_ADD_TEST(suite, testStandardTokenizerBuffering);
     //SUITE_ADD_TEST(suite, testPayloadCopy); // <- TODO: Finish Payload and remove asserts before enabling this test
 
     // Ported from TestPerFieldAnalzyerWrapper.java + 1 test of our own
@@ -507,9 +802,11 @@ CuSuite *testanalyzers(void)
 
     // Ported from TestISOLatin1AccentFilter.java
     SUITE_ADD_TEST(suite, testISOLatin1AccentFilter);
+    SUITE_ADD_TEST(suite, testCharTables);
 
     SUITE_ADD_TEST(suite, testWordlistLoader);
     SUITE_ADD_TEST(suite, testEmptyStopList);
+    SUITE_ADD_TEST(suite, testReusableTokenStreamAllocations);
     
     // TODO: Remove testStandardAnalyzer and port TestStandardAnalyzer.java as a whole
 
@@ -298,11 +298,135 @@ void testMultiReaderReopen(CuTest *tc){
   //_CLDELETE(index2B);
 }
 
+/** Looks up terms through the index terms, which are held UTF-8 encoded */
+void testTermIndexLookup(CuTest *tc){
+  RAMDirectory dir;
+  WhitespaceAnalyzer a;
+  IndexWriter* writer = _CLNEW IndexWriter(&dir, &a, true);
+  writer->setTermIndexInterval(4);
+
+  const int32_t count = 200;
+  TCHAR text[20];
+  for ( int32_t i=0;i<count;i++ ){
+    Document doc;
+    _sntprintf(text, 20, _T("t%d"), i);
+#ifdef _UCS2
+    if ( i % 3 == 1 ) text[0] = 0xE9;     // 2 bytes
+    if ( i % 3 == 2 ) text[0] = 0x4E2D;   // 3 bytes
+#endif
+    doc.add(*_CLNEW Field(_T("a"), text, Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+    doc.add(*_CLNEW Field(_T("b"), text, Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+    writer->addDocument(&doc);
+  }
+  writer->close();
+  _CLLDELETE(writer);
+
+  IndexReader* reader = IndexReader::open(&dir);
+  for ( int32_t i=count-1;i>=0;i-- ){
+    _sntprintf(text, 20, _T("t%d"), i);
+#ifdef _UCS2
+    if ( i % 3 == 1 ) text[0] = 0xE9;
+    if ( i % 3 == 2 ) text[0] = 0x4E2D;
+#endif
+    Term* t = _CLNEW Term(i % 2 == 0 ? _T("a") : _T("b"), text);
+    CuAssertIntEquals(tc, _T("docFreq"), 1, reader->docFreq(t));
+    TermEnum* te = reader->terms(t);
+    CLUCENE_ASSERT( te->term(false)->equals(t) );
+    _CLDELETE(te);
+    _CLDECDELETE(t);
+
+    // a missing term is positioned at the next term
+    _tcscat(text, _T("!"));
+    t = _CLNEW Term(_T("a"), text);
+    CuAssertIntEquals(tc, _T("docFreq of missing term"), 0, reader->docFreq(t));
+    te = reader->terms(t);
+    CLUCENE_ASSERT( te->term(false) == NULL || te->term(false)->compareTo(t) > 0 );
+    _CLDELETE(te);
+    _CLDECDELETE(t);
+  }
+  Term* t = _CLNEW Term(_T("c"), _T("t1"));
+  CuAssertIntEquals(tc, _T("docFreq of missing field"), 0, reader->docFreq(t));
+  _CLDECDELETE(t);
+  reader->close();
+  _CLLDELETE(reader);
+}
+
+void testTermDocsReuse(CuTest *tc){
+  RAMDirectory dir;
+  WhitespaceAnalyzer a;
+  IndexWriter* writer = _CLNEW IndexWriter(&dir, &a, true);
+
+  const int32_t count = 300;
+  TCHAR text[40];
+  for ( int32_t i=0;i<count;i++ ){
+    Document doc;
+    _sntprintf(text, 40, _T("all %s all"), i % 2 == 0 ? _T("even") : _T("odd"));
+    doc.add(*_CLNEW Field(_T("a"), text, Field::STORE_NO | Field::INDEX_TOKENIZED));
+    writer->addDocument(&doc);
+  }
+  writer->optimize();
+  writer->close();
+  _CLLDELETE(writer);
+
+  IndexReader* reader = IndexReader::open(&dir);
+  Term* all = _CLNEW Term(_T("a"), _T("all"));
+  Term* even = _CLNEW Term(_T("a"), _T("even"));
+  Term* odd = _CLNEW Term(_T("a"), _T("odd"));
+
+  // the enumerators closed in one round are reused by the next ones
+  for ( int32_t round=0;round<3;round++ ){
+    TermPositions* tp = reader->termPositions(all);
+    CLUCENE_ASSERT( tp->skipTo(count / 2 + 1) );
+    CuAssertIntEquals(tc, _T("skipTo"), count / 2 + 1, tp->doc());
+    CuAssertIntEquals(tc, _T("freq"), 2, tp->freq());
+    CuAssertIntEquals(tc, _T("first position"), 0, tp->nextPosition());
+    CuAssertIntEquals(tc, _T("second position"), 2, tp->nextPosition());
+    tp->close();
+    _CLLDELETE(tp);
+
+    // two enumerators of the segment in use at once
+    TermDocs* evenDocs = reader->termDocs(even);
+    TermDocs* oddDocs = reader->termDocs(odd);
+    int32_t n = 0;
+    while ( evenDocs->next() ){
+      CLUCENE_ASSERT( oddDocs->next() );
+      CuAssertIntEquals(tc, _T("even doc"), n * 2, evenDocs->doc());
+      CuAssertIntEquals(tc, _T("odd doc"), n * 2 + 1, oddDocs->doc());
+      n++;
+    }
+    CLUCENE_ASSERT( !oddDocs->next() );
+    CuAssertIntEquals(tc, _T("even docs"), count / 2, n);
+    evenDocs->close();
+    _CLLDELETE(evenDocs);
+
+    oddDocs->seek(all);
+    CLUCENE_ASSERT( oddDocs->skipTo(count - 1) );
+    CuAssertIntEquals(tc, _T("skipTo last"), count - 1, oddDocs->doc());
+    CLUCENE_ASSERT( !oddDocs->next() );
+    oddDocs->close();
+    _CLLDELETE(oddDocs);
+  }
+
+  // an enumerator may be deleted after its reader
+  TermPositions* tp = reader->termPositions(all);
+  CLUCENE_ASSERT( tp->next() );
+  CuAssertIntEquals(tc, _T("position"), 0, tp->nextPosition());
+  reader->close();
+  _CLLDELETE(reader);
+  _CLLDELETE(tp);
+
+  _CLDECDELETE(all);
+  _CLDECDELETE(even);
+  _CLDECDELETE(odd);
+}
+
 CuSuite *testindexreader(void)
 {
 	CuSuite *suite = CuSuiteNew(_T("CLucene IndexReader Test"));
   SUITE_ADD_TEST(suite, testIndexReaderReopen);
   SUITE_ADD_TEST(suite, testMultiReaderReopen);
+  SUITE_ADD_TEST(suite, testTermIndexLookup);
+  SUITE_ADD_TEST(suite, testTermDocsReuse);
 
   return suite;
 }
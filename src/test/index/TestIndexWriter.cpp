@@ -6,7 +6,13 @@
 ------------------------------------------------------------------------------*/
 #include "test.h"
 #include <CLucene/search/MatchAllDocsQuery.h>
+#include <CLucene/store/RateLimiter.h>
+#include <CLucene/index/MergeScheduler.h>
+#include <CLucene/index/MergePolicy.h>
+#include <CLucene/index/BatchIndexer.h>
+#include <CLucene/store/StatsDirectory.h>
 #include <stdio.h>
+#include <sstream>
 
 //checks if a merged index finds phrases correctly
 void testIWmergePhraseSegments(CuTest *tc){
@@ -689,6 +695,443 @@ void testOptimizeDelete(CuTest* tc) {
     _CLLDELETE( dir );
 }
 
+void testMergeRateLimiter(CuTest* tc) {
+    RAMDirectory dir;
+    SimpleAnalyzer a;
+    RateLimiter limiter;   // no limit, only counts
+
+    IndexWriter* writer = _CLNEW IndexWriter( &dir, &a, true );
+    writer->setMaxBufferedDocs(10);
+    writer->setMergeFactor(3);
+    writer->setMergeRateLimiter(&limiter);
+    writer->setMergeScheduler(_CLNEW SmallestFirstMergeScheduler());
+    CLUCENE_ASSERT( writer->getMergeRateLimiter() == &limiter );
+
+    TCHAR buf[20];
+    for ( int32_t i=0;i<200;i++ ){
+        Document doc;
+        _itot(i % 7, buf, 10);
+        doc.add ( *_CLNEW Field(_T("mod"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED) );
+        doc.add ( *_CLNEW Field(_T("text"), _T("some text to merge"), Field::STORE_YES | Field::TERMVECTOR_YES | Field::INDEX_TOKENIZED) );
+        writer->addDocument(&doc);
+    }
+    writer->optimize();
+    writer->close();
+    _CLLDELETE( writer );
+
+    CLUCENE_ASSERT( limiter.getBytes() > 0 );
+    CuAssertIntEquals(tc, _T("stalled without a limit"), 0, (int32_t)limiter.getStalledMillis());
+
+    IndexReader* reader = IndexReader::open(&dir);
+    CuAssertIntEquals(tc, _T("numDocs"), 200, reader->numDocs());
+    Term* t = _CLNEW Term(_T("mod"), _T("3"));
+    CuAssertIntEquals(tc, _T("docFreq"), 29, reader->docFreq(t));
+    _CLDECDELETE(t);
+    reader->close();
+    _CLLDELETE(reader);
+
+    // 512KB at 10MB/s must stall the writer for about 50ms
+    limiter.resetStats();
+    limiter.setMbPerSec(10);
+    limiter.pause(512*1024);
+    CuAssertIntEquals(tc, _T("bytes"), 512*1024, (int32_t)limiter.getBytes());
+    CLUCENE_ASSERT( limiter.getStalledMillis() >= 40 );
+    CuAssertIntEquals(tc, _T("pauses"), 1, (int32_t)limiter.getPauseCount());
+
+    dir.close();
+}
+
+// Runs the pending merges of an index with 3 segments of 10 docs followed by
+// 3 segments of 2 docs, and records the doc counts of the merges in the order
+// the scheduler ran them, as printed to the info stream
+static void runPendingMerges(MergeScheduler* scheduler, std::vector<int32_t>& merged) {
+    RAMDirectory dir;
+    SimpleAnalyzer a;
+
+    IndexWriter* writer = _CLNEW IndexWriter( &dir, &a, true );
+    writer->setMergeFactor(1000);
+    writer->setMaxBufferedDocs(10);
+    for ( int32_t i=0;i<36;i++ ){
+        if ( i == 30 )
+            writer->setMaxBufferedDocs(2);
+        Document doc;
+        doc.add ( *_CLNEW Field(_T("text"), _T("some text to merge"), Field::STORE_YES | Field::INDEX_TOKENIZED) );
+        writer->addDocument(&doc);
+    }
+    writer->close();
+    _CLLDELETE( writer );
+
+    // both merges are registered before the first one runs, the big
+    // one first
+    std::ostringstream info;
+    writer = _CLNEW IndexWriter( &dir, &a, false );
+    writer->setMergeFactor(3);
+    writer->setMergeScheduler(scheduler);
+    writer->setInfoStream(&info);
+    writer->maybeMerge();
+    writer->setInfoStream(NULL);
+    writer->close();
+    _CLLDELETE( writer );
+    dir.close();
+
+    std::istringstream lines(info.str());
+    std::string line;
+    while ( std::getline(lines, line) ){
+        const std::string::size_type pos = line.find("merge: total ");
+        if ( pos != std::string::npos )
+            merged.push_back(atoi(line.c_str() + pos + 13));
+    }
+}
+
+void testSmallestFirstMergeScheduler(CuTest* tc) {
+    std::vector<int32_t> merged;
+    runPendingMerges(_CLNEW SerialMergeScheduler(), merged);
+    CuAssertIntEquals(tc, _T("serial merges"), 2, (int32_t)merged.size());
+    CuAssertIntEquals(tc, _T("first serial merge"), 30, merged[0]);
+    CuAssertIntEquals(tc, _T("second serial merge"), 6, merged[1]);
+
+    merged.clear();
+    runPendingMerges(_CLNEW SmallestFirstMergeScheduler(), merged);
+    CuAssertIntEquals(tc, _T("smallest first merges"), 2, (int32_t)merged.size());
+    CuAssertIntEquals(tc, _T("first smallest first merge"), 6, merged[0]);
+    CuAssertIntEquals(tc, _T("second smallest first merge"), 30, merged[1]);
+}
+
+void testTieredMergePolicy(CuTest* tc) {
+    RAMDirectory dir;
+    SimpleAnalyzer a;
+
+    IndexWriter* writer = _CLNEW IndexWriter( &dir, &a, true );
+    TieredMergePolicy* tmp = _CLNEW TieredMergePolicy();
+    tmp->setMaxMergeAtOnce(3);
+    tmp->setSegmentsPerTier(3);
+    writer->setMergePolicy(tmp);
+    writer->setMaxBufferedDocs(10);
+
+    TCHAR buf[20];
+    for ( int32_t i=0;i<300;i++ ){
+        Document doc;
+        _itot(i % 7, buf, 10);
+        doc.add ( *_CLNEW Field(_T("mod"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED) );
+        _itot(i, buf, 10);
+        doc.add ( *_CLNEW Field(_T("id"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED) );
+        writer->addDocument(&doc);
+        if ( i % 50 == 49 ){
+            Term* t = _CLNEW Term(_T("mod"), _T("3"));
+            writer->deleteDocuments(t);
+            _CLDECDELETE(t);
+        }
+    }
+    writer->flush();
+
+    IndexReader* reader = IndexReader::open(&dir);
+    CuAssertIntEquals(tc, _T("numDocs"), 300 - 43, reader->numDocs());
+    reader->close();
+    _CLLDELETE(reader);
+
+    // the optimized index holds every surviving doc once; the policy merges
+    // segments that are not adjacent, so the order of the docs is not kept
+    writer->optimize();
+    writer->close();
+    _CLLDELETE( writer );
+
+    reader = IndexReader::open(&dir);
+    CuAssertIntEquals(tc, _T("numDocs"), 300 - 43, reader->numDocs());
+    CLUCENE_ASSERT( !reader->hasDeletions() );
+    bool seen[300];
+    for ( int32_t i=0;i<300;i++ )
+        seen[i] = false;
+    for ( int32_t i=0;i<reader->maxDoc();i++ ){
+        Document doc;
+        reader->document(i, doc);
+        int32_t id = _ttoi(doc.get(_T("id")));
+        CLUCENE_ASSERT( id >= 0 && id < 300 );
+        CLUCENE_ASSERT( !seen[id] );
+        seen[id] = true;
+    }
+    for ( int32_t i=0;i<300;i++ )
+        CuAssertTrue(tc, seen[i] == (i % 7 != 3), _T("surviving ids"));
+    reader->close();
+    _CLLDELETE(reader);
+
+    // segments with too many deletes are rewritten by the next merge
+    // once a budget is given
+    writer = _CLNEW IndexWriter( &dir, &a, true );
+    tmp = _CLNEW TieredMergePolicy();
+    tmp->setSegmentsPerTier(50);
+    writer->setMergePolicy(tmp);
+    writer->setMaxBufferedDocs(10);
+    for ( int32_t i=0;i<100;i++ ){
+        Document doc;
+        _itot(i % 7, buf, 10);
+        doc.add ( *_CLNEW Field(_T("mod"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED) );
+        writer->addDocument(&doc);
+    }
+    writer->flush();
+    Term* t = _CLNEW Term(_T("mod"), _T("3"));
+    writer->deleteDocuments(t);
+    _CLDECDELETE(t);
+    writer->flush();
+
+    reader = IndexReader::open(&dir);
+    CLUCENE_ASSERT( reader->hasDeletions() );
+    reader->close();
+    _CLLDELETE(reader);
+
+    tmp->setMaxExpungeDeletesMergeMB(100);
+    writer->maybeMerge();
+    writer->close();
+    _CLLDELETE( writer );
+
+    reader = IndexReader::open(&dir);
+    CuAssertIntEquals(tc, _T("numDocs"), 100 - 14, reader->numDocs());
+    CLUCENE_ASSERT( !reader->hasDeletions() );
+    reader->close();
+    _CLLDELETE(reader);
+
+    dir.close();
+}
+
+void testBatchIndexer(CuTest* tc) {
+    RAMDirectory dir;
+    StandardAnalyzer a;
+    IndexWriter* writer = _CLNEW IndexWriter( &dir, &a, true );
+    // flushes happen while the workers add documents
+    writer->setMaxBufferedDocs(37);
+
+    BatchIndexer* indexer = _CLNEW BatchIndexer(writer, 4, 3);
+    CuAssertIntEquals(tc, _T("threads"), 4, indexer->getNumThreads());
+    TCHAR buf[20];
+    StringBuffer sb;
+    for ( int32_t i=0;i<1000;i++ ){
+        Document* doc = _CLNEW Document();
+        _itot(i, buf, 10);
+        doc->add ( *_CLNEW Field(_T("id"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED) );
+        sb.clear();
+        English::IntToEnglish(i, &sb);
+        doc->add ( *_CLNEW Field(_T("text"), sb.getBuffer(), Field::STORE_YES | Field::INDEX_TOKENIZED
+            | (i % 3 == 0 ? Field::TERMVECTOR_WITH_POSITIONS : Field::TERMVECTOR_NO)) );
+        indexer->addDocument(doc);
+    }
+    for ( int32_t i=0;i<10;i++ ){
+        Document* doc = _CLNEW Document();
+        _itot(i, buf, 10);
+        doc->add ( *_CLNEW Field(_T("id"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED) );
+        doc->add ( *_CLNEW Field(_T("text"), _T("updated"), Field::STORE_YES | Field::INDEX_TOKENIZED) );
+        Term* t = _CLNEW Term(_T("id"), buf);
+        indexer->updateDocument(t, doc);
+        _CLDECDELETE(t);
+    }
+    indexer->finish();
+
+    BatchIndexer::Stats stats = indexer->getStats();
+    CuAssertIntEquals(tc, _T("queued"), 1010, (int32_t)stats.queued);
+    CuAssertIntEquals(tc, _T("indexed"), 1010, (int32_t)stats.indexed);
+    CuAssertIntEquals(tc, _T("failed"), 0, (int32_t)(stats.failed + stats.dropped));
+
+    // no more documents once finished
+    Document* doc = _CLNEW Document();
+    doc->add ( *_CLNEW Field(_T("id"), _T("x"), Field::STORE_YES | Field::INDEX_UNTOKENIZED) );
+    try{
+        indexer->addDocument(doc);
+        CuFail(tc, _T("addDocument after finish did not throw"));
+    }catch(CLuceneError& err){
+        CuAssertIntEquals(tc, _T("error"), CL_ERR_IllegalState, err.number());
+    }
+    _CLDELETE(indexer);
+    writer->close();
+    _CLLDELETE( writer );
+
+    // the docIDs follow the order in which the documents were queued;
+    // merges may have removed the updated documents
+    IndexReader* reader = IndexReader::open(&dir);
+    CuAssertIntEquals(tc, _T("numDocs"), 1000, reader->numDocs());
+    int32_t n = 0;
+    for ( int32_t i=0;i<reader->maxDoc();i++ ){
+        if ( reader->isDeleted(i) )
+            continue;
+        Document d;
+        reader->document(i, d);
+        const int32_t id = n < 990 ? n + 10 : n - 990;
+        CuAssertIntEquals(tc, _T("id"), id, _ttoi(d.get(_T("id"))));
+        if ( n < 990 ){
+            sb.clear();
+            English::IntToEnglish(id, &sb);
+            CuAssertStrEquals(tc, _T("text"), sb.getBuffer(), d.get(_T("text")));
+            TermFreqVector* tfv = reader->getTermFreqVector(i, _T("text"));
+            CLUCENE_ASSERT( (tfv != NULL) == (id % 3 == 0) );
+            _CLDELETE(tfv);
+        }else
+            CuAssertStrEquals(tc, _T("text"), _T("updated"), d.get(_T("text")));
+        n++;
+    }
+    CuAssertIntEquals(tc, _T("docs"), 1000, n);
+    reader->close();
+    _CLLDELETE(reader);
+
+    // the first error stops the indexer
+    writer = _CLNEW IndexWriter( &dir, &a, true );
+    writer->close();
+    indexer = _CLNEW BatchIndexer(writer, 2);
+    bool thrown = false;
+    try{
+        for ( int32_t i=0;i<100;i++ ){
+            doc = _CLNEW Document();
+            doc->add ( *_CLNEW Field(_T("id"), _T("x"), Field::STORE_YES | Field::INDEX_UNTOKENIZED) );
+            indexer->addDocument(doc);
+        }
+        indexer->finish();
+    }catch(CLuceneError& err){
+        CuAssertIntEquals(tc, _T("error"), CL_ERR_AlreadyClosed, err.number());
+        thrown = true;
+    }
+    CLUCENE_ASSERT( thrown );
+    stats = indexer->getStats();
+    CLUCENE_ASSERT( stats.failed > 0 );
+    CLUCENE_ASSERT( stats.indexed == 0 );
+    _CLDELETE(indexer);
+    _CLLDELETE( writer );
+
+    dir.close();
+}
+
+// builds 46 segments and merges them all at once. Without deletions, the
+// writer does not commit until it is closed, so the segments share their doc
+// store and the merge leaves it as it is
+static void buildWideMerge(Directory* dir, int32_t maxFanIn, bool deletions) {
+    WhitespaceAnalyzer a;
+    IndexWriter writer(dir, deletions, &a, true);
+    writer.setMergePolicy(_CLNEW LogDocMergePolicy());
+    writer.setMergeFactor(1000);
+    writer.setMaxBufferedDocs(5);
+    if ( maxFanIn > 0 )
+        writer.setMaxMergeFanIn(maxFanIn);
+
+    TCHAR buf[20];
+    StringBuffer sb;
+    for ( int32_t i=0;i<230;i++ ){
+        Document doc;
+        _itot(i, buf, 10);
+        doc.add ( *_CLNEW Field(_T("id"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED) );
+        _itot(i % 7, buf, 10);
+        doc.add ( *_CLNEW Field(_T("mod"), buf, Field::STORE_NO | Field::INDEX_UNTOKENIZED) );
+        sb.clear();
+        English::IntToEnglish(i, &sb);
+        doc.add ( *_CLNEW Field(_T("text"), sb.getBuffer(), Field::STORE_YES | Field::INDEX_TOKENIZED
+            | (i % 2 == 0 ? Field::TERMVECTOR_WITH_POSITIONS_OFFSETS : Field::TERMVECTOR_NO)) );
+        writer.addDocument(&doc);
+    }
+    if ( deletions ){
+        Term* t = _CLNEW Term(_T("mod"), _T("3"));
+        writer.deleteDocuments(t);
+        _CLDECDELETE(t);
+    }
+    writer.flush();
+    writer.optimize();
+    writer.close();
+}
+
+static void checkMaxMergeFanIn(CuTest* tc, bool deletions) {
+    RAMDirectory expected;
+    buildWideMerge(&expected, 0, deletions);
+
+    RAMDirectory* ram = _CLNEW RAMDirectory();
+    StatsDirectory* dir = _CLNEW StatsDirectory(ram);
+    buildWideMerge(dir, 4, deletions);
+
+    // the 46 flushed segments are merged in passes to 12, 3 and 1
+    IOStats::Snapshot snapshot;
+    dir->getStats()->snapshot(snapshot);
+    CuAssertIntEquals(tc, _T("field infos written"), 46 + 12 + 3 + 1, (int32_t)snapshot["fnm"].creates);
+    // which copy the stored fields only if there are deletions
+    CuAssertIntEquals(tc, _T("stored fields written"), deletions ? 46 + 12 + 3 + 1 : 1, (int32_t)snapshot["fdt"].creates);
+
+    // the temporary segments are gone
+    std::vector<std::string> files1, files2;
+    expected.list(&files1);
+    ram->list(&files2);
+    std::sort(files1.begin(), files1.end());
+    std::sort(files2.begin(), files2.end());
+    CLUCENE_ASSERT( files1 == files2 );
+
+    // and the index is the same
+    IndexReader* reader1 = IndexReader::open(&expected);
+    IndexReader* reader2 = IndexReader::open(ram);
+    CuAssertIntEquals(tc, _T("maxDoc"), reader1->maxDoc(), reader2->maxDoc());
+    CuAssertIntEquals(tc, _T("numDocs"), deletions ? 230 - 33 : 230, reader2->numDocs());
+    for ( int32_t i=0;i<reader1->maxDoc();i++ ){
+        Document d1, d2;
+        reader1->document(i, d1);
+        reader2->document(i, d2);
+        CuAssertStrEquals(tc, _T("id"), d1.get(_T("id")), d2.get(_T("id")));
+        CuAssertStrEquals(tc, _T("text"), d1.get(_T("text")), d2.get(_T("text")));
+        TermFreqVector* v1 = reader1->getTermFreqVector(i, _T("text"));
+        TermFreqVector* v2 = reader2->getTermFreqVector(i, _T("text"));
+        CLUCENE_ASSERT( (v1 == NULL) == (v2 == NULL) );
+        if ( v1 != NULL ){
+            CuAssertIntEquals(tc, _T("vector size"), v1->size(), v2->size());
+            for ( int32_t j=0;j<v1->size();j++ ){
+                CuAssertStrEquals(tc, _T("vector term"), (*v1->getTerms())[j], (*v2->getTerms())[j]);
+                CuAssertIntEquals(tc, _T("vector freq"), (*v1->getTermFrequencies())[j], (*v2->getTermFrequencies())[j]);
+            }
+        }
+        _CLDELETE(v1);
+        _CLDELETE(v2);
+    }
+    uint8_t* norms1 = reader1->norms(_T("text"));
+    uint8_t* norms2 = reader2->norms(_T("text"));
+    CLUCENE_ASSERT( memcmp(norms1, norms2, reader1->maxDoc()) == 0 );
+
+    TermEnum* terms1 = reader1->terms();
+    TermEnum* terms2 = reader2->terms();
+    TermPositions* positions1 = reader1->termPositions();
+    TermPositions* positions2 = reader2->termPositions();
+    int32_t numTerms = 0;
+    while ( terms1->next() ){
+        CLUCENE_ASSERT( terms2->next() );
+        Term* t = terms1->term(false);
+        CLUCENE_ASSERT( t->equals(terms2->term(false)) );
+        CuAssertIntEquals(tc, _T("docFreq"), terms1->docFreq(), terms2->docFreq());
+        positions1->seek(t);
+        positions2->seek(t);
+        while ( positions1->next() ){
+            CLUCENE_ASSERT( positions2->next() );
+            CuAssertIntEquals(tc, _T("doc"), positions1->doc(), positions2->doc());
+            CuAssertIntEquals(tc, _T("freq"), positions1->freq(), positions2->freq());
+            for ( int32_t j=0;j<positions1->freq();j++ )
+                CuAssertIntEquals(tc, _T("position"), positions1->nextPosition(), positions2->nextPosition());
+        }
+        CLUCENE_ASSERT( !positions2->next() );
+        numTerms++;
+    }
+    CLUCENE_ASSERT( !terms2->next() );
+    CLUCENE_ASSERT( numTerms > 230 );
+    positions1->close();
+    positions2->close();
+    _CLDELETE(positions1);
+    _CLDELETE(positions2);
+    terms1->close();
+    terms2->close();
+    _CLDELETE(terms1);
+    _CLDELETE(terms2);
+
+    reader1->close();
+    reader2->close();
+    _CLDELETE(reader1);
+    _CLDELETE(reader2);
+
+    dir->close();
+    _CLDECDELETE(dir);
+    ram->close();
+    _CLDECDELETE(ram);
+    expected.close();
+}
+
+void testMaxMergeFanIn(CuTest* tc) {
+    checkMaxMergeFanIn(tc, true);
+    checkMaxMergeFanIn(tc, false);
+}
+
 CuSuite *testindexwriter(void)
 {
      CuSuite *suite = CuSuiteNew(_T("CLucene IndexWriter Test"));
@@ -707,6 +1150,11 @@ CuSuite *testindexwriter(void)
     SUITE_ADD_TEST(suite, testDeleteDocument);
     SUITE_ADD_TEST(suite, testMergeIndex);
     SUITE_ADD_TEST(suite, testOptimizeDelete);
+    SUITE_ADD_TEST(suite, testMergeRateLimiter);
+    SUITE_ADD_TEST(suite, testSmallestFirstMergeScheduler);
+    SUITE_ADD_TEST(suite, testTieredMergePolicy);
+    SUITE_ADD_TEST(suite, testBatchIndexer);
+    SUITE_ADD_TEST(suite, testMaxMergeFanIn);
 
     return suite;
 }
@@ -492,6 +492,93 @@ CL_NS_USE(util);
     }
   }
 
+  static void appendVectors(StringBuffer& buf, IndexReader* reader, int32_t docNum) {
+    ArrayBase<TermFreqVector*>* vectors = reader->getTermFreqVectors(docNum);
+    if (vectors == NULL) {
+      buf.append(_T("none;"));
+      return;
+    }
+    for (size_t i = 0; i < vectors->length; i++) {
+      TermFreqVector* v = vectors->values[i];
+      buf.append(v->getField());
+      buf.append(_T(":"));
+      const ArrayBase<const TCHAR*>* terms = v->getTerms();
+      const ArrayBase<int32_t>* freqs = v->getTermFrequencies();
+      TermPositionVector* tpv = v->__asTermPositionVector();
+      for (size_t j = 0; j < terms->length; j++) {
+        buf.append(terms->values[j]);
+        buf.appendChar('/');
+        buf.appendInt(freqs->values[j]);
+        const ArrayBase<int32_t>* pos = tpv != NULL ? tpv->getTermPositions(j) : NULL;
+        for (size_t k = 0; pos != NULL && k < pos->length; k++) {
+          buf.appendChar('@');
+          buf.appendInt(pos->values[k]);
+        }
+        const ArrayBase<TermVectorOffsetInfo*>* offs = tpv != NULL ? tpv->getOffsets(j) : NULL;
+        for (size_t k = 0; offs != NULL && k < offs->length; k++) {
+          buf.appendChar('[');
+          buf.appendInt(offs->values[k]->getStartOffset());
+          buf.appendChar(',');
+          buf.appendInt(offs->values[k]->getEndOffset());
+        }
+        buf.appendChar(' ');
+      }
+      buf.appendChar(';');
+    }
+    _CLLDELETE(vectors);
+  }
+
+  /**
+   * Merging segments copies the term vectors as raw bytes, make sure they
+   * survive with deletions and documents without vectors in between
+   */
+  void testMergedVectors(CuTest* tc) {
+    RAMDirectory mergeDir;
+    WhitespaceAnalyzer an;
+    int32_t docId = 0;
+    for (int32_t session = 0; session < 3; session++) {
+      IndexWriter writer(&mergeDir, &an, session == 0);
+      writer.setUseCompoundFile(session != 1);
+      for (int32_t i = 0; i < 25; i++, docId++) {
+        Document doc;
+        TCHAR* text = English::IntToEnglish(docId);
+        if (docId % 4 != 0)
+          doc.add(*_CLNEW Field(_T("pos"), text, Field::STORE_NO | Field::INDEX_TOKENIZED | Field::TERMVECTOR_WITH_POSITIONS_OFFSETS));
+        if (docId % 3 == 0)
+          doc.add(*_CLNEW Field(_T("plain"), text, Field::STORE_NO | Field::INDEX_TOKENIZED | Field::TERMVECTOR_YES));
+        doc.add(*_CLNEW Field(_T("id"), text, Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+        _CLDELETE_LCARRAY(text);
+        writer.addDocument(&doc);
+      }
+      writer.close();
+    }
+
+    IndexReader* reader = IndexReader::open(&mergeDir);
+    for (int32_t i = 0; i < reader->maxDoc(); i += 7)
+      reader->deleteDocument(i);
+    StringBuffer expected;
+    for (int32_t i = 0; i < reader->maxDoc(); i++) {
+      if (!reader->isDeleted(i))
+        appendVectors(expected, reader, i);
+    }
+    reader->close();
+    _CLLDELETE(reader);
+
+    IndexWriter writer(&mergeDir, &an, false);
+    writer.optimize();
+    writer.close();
+
+    reader = IndexReader::open(&mergeDir);
+    StringBuffer actual;
+    for (int32_t i = 0; i < reader->maxDoc(); i++)
+      appendVectors(actual, reader, i);
+    reader->close();
+    _CLLDELETE(reader);
+
+    CuAssertStrEquals(tc, _T("merged vectors"), expected.getBuffer(), actual.getBuffer());
+    mergeDir.close();
+  }
+
 
 CuSuite *testTermVectorsReader(void) {
   CuSuite *suite = CuSuiteNew(_T("CLucene TermVectorsReader Test"));
@@ -504,6 +591,7 @@ CuSuite *testTermVectorsReader(void) {
   SUITE_ADD_TEST(suite, testOffsetReader);
   //SUITE_ADD_TEST(suite, testMapper);
   SUITE_ADD_TEST(suite, testBadParams);
+  SUITE_ADD_TEST(suite, testMergedVectors);
 
   SUITE_ADD_TEST(suite, testTearDown);
 
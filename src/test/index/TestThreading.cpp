@@ -149,12 +149,118 @@ void testFSThreading(CuTest *tc){
   _CLDECDELETE(directory);
 }
 
+/*
+  Several threads reading the norms, deletions and stored documents of
+  one reader while another deletes and undeletes its documents.
+ */
+#define SHARED_READER_DOCS 500
+#define SHARED_READER_THREADS 4
+bool sharedReaderFailed = false;
+volatile bool sharedReaderStop = false;
+_LUCENE_THREAD_FUNC(sharedReaderTest, _reader){
+  IndexReader* reader = (IndexReader*)_reader;
+  try {
+    uint8_t* first = reader->norms(_T("contents"));
+    while ( !sharedReaderStop && !sharedReaderFailed ){
+      uint8_t* norms = reader->norms(_T("contents"));
+      if ( norms != first || norms != reader->norms(_T("contents")) ){
+        fprintf(stderr, "norms were read again\n");
+        sharedReaderFailed = true;
+      }
+      if ( reader->norms(_T("nonorms"))[0] != Similarity::encodeNormWithDefault(1.0f) ){
+        fprintf(stderr, "wrong fake norms\n");
+        sharedReaderFailed = true;
+      }
+      int32_t deleted = 0;
+      for ( int32_t i=0;i<SHARED_READER_DOCS;i++ ){
+        if ( reader->isDeleted(i) ){
+          if ( i % 2 == 0 ){
+            fprintf(stderr, "doc %d deleted\n", i);
+            sharedReaderFailed = true;
+          }
+          deleted++;
+        }
+      }
+      if ( deleted > SHARED_READER_DOCS / 2 ){
+        fprintf(stderr, "%d docs deleted\n", deleted);
+        sharedReaderFailed = true;
+      }
+      TCHAR id[10];
+      for ( int32_t i=0;i<SHARED_READER_DOCS && !sharedReaderFailed;i+=2 ){
+        Document doc;
+        reader->document(i, doc);
+        _i64tot(i, id, 10);
+        if ( doc.get(_T("id")) == NULL || _tcscmp(doc.get(_T("id")), id) != 0 ){
+          fprintf(stderr, "wrong document %d\n", i);
+          sharedReaderFailed = true;
+        }
+      }
+    }
+  } catch (CLuceneError& e) {
+    fprintf(stderr, "err 5: #%d: %s\n", e.number(), e.what());
+    sharedReaderFailed = true;
+  }
+  _LUCENE_THREAD_FUNC_RETURN(0);
+}
+
+void testSharedReaderThreading(CuTest *tc){
+  RAMDirectory directory;
+  SimpleAnalyzer analyzer;
+  IndexWriter* writer = _CLNEW IndexWriter(&directory, &analyzer, true);
+  StringBuffer sb;
+  for ( int32_t i=0;i<SHARED_READER_DOCS;i++ ){
+    Document d;
+    sb.clear();
+    English::IntToEnglish(i, &sb);
+    d.add(*_CLNEW Field(_T("contents"), sb.getBuffer(), Field::STORE_NO | Field::INDEX_TOKENIZED));
+    d.add(*_CLNEW Field(_T("nonorms"), _T("x"), Field::STORE_NO | Field::INDEX_UNTOKENIZED | Field::INDEX_NONORMS));
+    TCHAR id[10];
+    _i64tot(i, id, 10);
+    d.add(*_CLNEW Field(_T("id"), id, Field::STORE_YES | Field::INDEX_NO));
+    writer->addDocument(&d);
+  }
+  writer->optimize();
+  writer->close();
+  _CLLDELETE(writer);
+
+  IndexReader* reader = IndexReader::open(&directory);
+  sharedReaderFailed = false;
+  sharedReaderStop = false;
+  _LUCENE_THREADID_TYPE threads[SHARED_READER_THREADS];
+  for ( int i=0;i<SHARED_READER_THREADS;i++ )
+    threads[i] = _LUCENE_THREAD_CREATE(&sharedReaderTest, reader);
+
+  // delete the odd documents and undelete them all, over and over
+  for ( int32_t round=0;round<20 && !sharedReaderFailed;round++ ){
+    for ( int32_t i=1;i<SHARED_READER_DOCS;i+=2 )
+      reader->deleteDocument(i);
+    reader->undeleteAll();
+  }
+  sharedReaderStop = true;
+  for ( int i=0;i<SHARED_READER_THREADS;i++ )
+    _LUCENE_THREAD_JOIN(threads[i]);
+
+  CuAssert(tc, _T("hit an unexpected result in one of the threads\n"), !sharedReaderFailed);
+
+  // the deletions dropped by undeleteAll are not seen again
+  reader->deleteDocument(0);
+  CuAssertIntEquals(tc, _T("numDocs"), SHARED_READER_DOCS - 1, reader->numDocs());
+  for ( int32_t i=1;i<SHARED_READER_DOCS;i++ )
+    CLUCENE_ASSERT( !reader->isDeleted(i) );
+  reader->undeleteAll();
+  CuAssertIntEquals(tc, _T("numDocs"), SHARED_READER_DOCS, reader->numDocs());
+  CLUCENE_ASSERT( !reader->hasDeletions() );
+  reader->close();
+  _CLLDELETE(reader);
+}
+
 CuSuite *testatomicupdates(void)
 {
   srand ( (unsigned int)Misc::currentTimeMillis() );
   CuSuite *suite = CuSuiteNew(_T("CLucene Atomic Updates Test"));
   SUITE_ADD_TEST(suite, testRAMThreading);
   SUITE_ADD_TEST(suite, testFSThreading);
+  SUITE_ADD_TEST(suite, testSharedReaderThreading);
 
   return suite;
 }
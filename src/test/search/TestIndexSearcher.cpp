@@ -6,6 +6,11 @@
 ------------------------------------------------------------------------------*/
 
 #include "test.h"
+#include "CLucene/search/QueryResultCache.h"
+#include "CLucene/search/QueryFilter.h"
+#include "CLucene/search/Scorer.h"
+#include "CLucene/util/Arena.h"
+#include "CLucene/search/QueryProfile.h"
 
 DEFINE_MUTEX(searchMutex);
 DEFINE_CONDITION(searchCondition);
@@ -109,12 +114,346 @@ void testEndThreadException(CuTest *tc) {
     ram.close();
 }
 
+void testQueryResultCache(CuTest *tc) {
+    RAMDirectory ram;
+    WhitespaceAnalyzer an;
+    IndexWriter* writer = _CLNEW IndexWriter(&ram, &an, true);
+    Document doc;
+    TCHAR num[16];
+    for (int i = 0; i < 100; i++) {
+        TCHAR * tmp = English::IntToEnglish(i);
+        _itot(i, num, 10);
+        doc.add(* _CLNEW Field(_T("content"), tmp, Field::STORE_YES | Field::INDEX_TOKENIZED));
+        doc.add(* _CLNEW Field(_T("num"), num, Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+        writer->addDocument(&doc);
+        doc.clear();
+        _CLDELETE_ARRAY( tmp );
+    }
+    writer->close();
+    _CLLDELETE(writer);
+
+    QueryResultCache cache;
+    IndexReader* reader = IndexReader::open(&ram);
+    IndexSearcher searcher(reader);
+    searcher.setQueryResultCache(&cache);
+
+    Query* query = QueryParser::parse(_T("ninety"), _T("content"), &an);
+    TopDocs* first = searcher._search(query, NULL, NULL, 5);
+    CuAssertIntEquals(tc, _T("first search misses"), 1, (int)cache.getMissCount());
+
+    // an equal but distinct query instance is answered from the cache
+    Query* query2 = QueryParser::parse(_T("ninety"), _T("content"), &an);
+    TopDocs* second = searcher._search(query2, NULL, NULL, 5);
+    CuAssertIntEquals(tc, _T("repeated search hits"), 1, (int)cache.getHitCount());
+    CuAssertIntEquals(tc, _T("totalHits"), first->totalHits, second->totalHits);
+    CuAssertIntEquals(tc, _T("length"), first->scoreDocsLength, second->scoreDocsLength);
+    for (int32_t i = 0; i < first->scoreDocsLength; i++) {
+        CuAssertIntEquals(tc, _T("doc"), first->scoreDocs[i].doc, second->scoreDocs[i].doc);
+        CLUCENE_ASSERT(first->scoreDocs[i].score == second->scoreDocs[i].score);
+    }
+    _CLLDELETE(first);
+    _CLLDELETE(second);
+
+    // a different number of hits is a different key
+    TopDocs* third = searcher._search(query, NULL, NULL, 10);
+    CuAssertIntEquals(tc, _T("nDocs is part of the key"), 2, (int)cache.getMissCount());
+    _CLLDELETE(third);
+
+    // sorted results are keyed by the sort
+    Sort sort(_T("num"));
+    Hits* hits = searcher.search(query, NULL, &sort);
+    Hits* hits2 = searcher.search(query2, NULL, &sort);
+    CuAssertIntEquals(tc, _T("sorted search hits"), 2, (int)cache.getHitCount());
+    CuAssertIntEquals(tc, _T("sorted length"), hits->length(), hits2->length());
+    for (size_t i = 0; i < hits->length(); i++)
+        CuAssertIntEquals(tc, _T("sorted doc"), hits->id(i), hits2->id(i));
+    _CLLDELETE(hits);
+    _CLLDELETE(hits2);
+    CuAssertIntEquals(tc, _T("cached results"), 3, (int)cache.size());
+
+    // filtered searches and searches with another similarity are not cached
+    QueryFilter filter(query);
+    TopDocs* filtered = searcher._search(query, NULL, &filter, 5);
+    _CLLDELETE(filtered);
+    filtered = searcher._search(query, NULL, &filter, 5);
+    _CLLDELETE(filtered);
+    DefaultSimilarity similarity;
+    TopDocs* scored = searcher._search(query, &similarity, NULL, 5);
+    _CLLDELETE(scored);
+    CuAssertIntEquals(tc, _T("uncached hits"), 2, (int)cache.getHitCount());
+    CuAssertIntEquals(tc, _T("uncached misses"), 3, (int)cache.getMissCount());
+    CuAssertIntEquals(tc, _T("uncached results"), 3, (int)cache.size());
+
+    // deleting documents through the reader makes its results stale
+    reader->deleteDocument(0);
+    TopDocs* fourth = searcher._search(query, NULL, NULL, 5);
+    CuAssertIntEquals(tc, _T("stale result misses"), 4, (int)cache.getMissCount());
+    _CLLDELETE(fourth);
+
+    // so does undeleting all, then deleting another doc, which keeps numDocs()
+    TopDocs* before = searcher._search(query, NULL, NULL, 5);
+    CuAssertIntEquals(tc, _T("fresh result hits"), 3, (int)cache.getHitCount());
+    CuAssertIntEquals(tc, _T("fresh result length"), 1, before->scoreDocsLength);
+    const int32_t top = before->scoreDocs[0].doc;
+    const int32_t numDocs = reader->numDocs();
+    reader->undeleteAll();
+    reader->deleteDocument(top);
+    CuAssertIntEquals(tc, _T("numDocs"), numDocs, reader->numDocs());
+    TopDocs* undeleted = searcher._search(query, NULL, NULL, 5);
+    CuAssertIntEquals(tc, _T("undeleteAll misses"), 5, (int)cache.getMissCount());
+    CuAssertIntEquals(tc, _T("deleted doc length"), 0, undeleted->scoreDocsLength);
+    _CLLDELETE(undeleted);
+
+    // and so does setting a norm, which changes the scores but not the matches
+    reader->undeleteAll();
+    _CLLDELETE(before);
+    before = searcher._search(query, NULL, NULL, 5);
+    _CLLDELETE(before);
+    before = searcher._search(query, NULL, NULL, 5);
+    CuAssertIntEquals(tc, _T("undeleted result hits"), 4, (int)cache.getHitCount());
+    CuAssertIntEquals(tc, _T("undeleted doc length"), 1, before->scoreDocsLength);
+    reader->setNorm(top, _T("content"), 0.0f);
+    TopDocs* after = searcher._search(query, NULL, NULL, 5);
+    CuAssertIntEquals(tc, _T("setNorm misses"), 7, (int)cache.getMissCount());
+    CuAssertIntEquals(tc, _T("zero norm length"), 0, after->scoreDocsLength);
+    _CLLDELETE(before);
+    _CLLDELETE(after);
+
+    // a second cache of the same reader
+    QueryResultCache* cache2 = _CLNEW QueryResultCache();
+    IndexSearcher searcher2(reader);
+    searcher2.setQueryResultCache(cache2);
+    TopDocs* fifth = searcher2._search(query, NULL, NULL, 5);
+    _CLLDELETE(fifth);
+    CuAssertIntEquals(tc, _T("second cache results"), 1, (int)cache2->size());
+
+    // a third one that is deleted before the reader is closed
+    QueryResultCache* cache3 = _CLNEW QueryResultCache();
+    searcher2.setQueryResultCache(cache3);
+    TopDocs* sixth = searcher2._search(query, NULL, NULL, 5);
+    _CLLDELETE(sixth);
+    searcher2.setQueryResultCache(NULL);
+    _CLLDELETE(cache3);
+
+    // closing the reader drops its results from every cache
+    searcher.close();
+    searcher2.close();
+    reader->close();
+    CuAssertIntEquals(tc, _T("closed reader results"), 0, (int)cache.size());
+    CLUCENE_ASSERT(cache.getBytes() == 0);
+    CuAssertIntEquals(tc, _T("closed reader results of the second cache"), 0, (int)cache2->size());
+    _CLLDELETE(cache2);
+    _CLLDELETE(reader);
+
+    _CLLDELETE(query);
+    _CLLDELETE(query2);
+    ram.close();
+}
+
+void testSearchAfter(CuTest *tc) {
+    RAMDirectory ram;
+    WhitespaceAnalyzer an;
+    IndexWriter* writer = _CLNEW IndexWriter(&ram, &an, true);
+    Document doc;
+    for (int i = 0; i < 200; i++) {
+        TCHAR * tmp = English::IntToEnglish(i);
+        doc.add(* _CLNEW Field(_T("content"), tmp, Field::STORE_NO | Field::INDEX_TOKENIZED));
+        writer->addDocument(&doc);
+        doc.clear();
+        _CLDELETE_ARRAY( tmp );
+    }
+    writer->close();
+    _CLLDELETE(writer);
+
+    IndexSearcher searcher(&ram);
+    // mixes several distinct scores with many ties
+    Query* query = QueryParser::parse(_T("one hundred seven"), _T("content"), &an);
+    TopDocs* all = searcher._search(query, NULL, NULL, 1000);
+    CLUCENE_ASSERT(all->scoreDocsLength > 20);
+
+    const int32_t pageSize = 7;
+    int32_t seen = 0;
+    ScoreDoc last;
+    TopDocs* page = searcher.searchAfter(NULL, query, NULL, NULL, pageSize);
+    while (page->scoreDocsLength > 0) {
+        CuAssertIntEquals(tc, _T("totalHits"), all->totalHits, page->totalHits);
+        CLUCENE_ASSERT(page->scoreDocsLength <= pageSize);
+        for (int32_t i = 0; i < page->scoreDocsLength; i++, seen++) {
+            CuAssertIntEquals(tc, _T("paged doc"), all->scoreDocs[seen].doc, page->scoreDocs[i].doc);
+            CLUCENE_ASSERT(all->scoreDocs[seen].score == page->scoreDocs[i].score);
+        }
+        last = page->scoreDocs[page->scoreDocsLength-1];
+        _CLLDELETE(page);
+        page = searcher.searchAfter(&last, query, NULL, NULL, pageSize);
+    }
+    _CLLDELETE(page);
+    CuAssertIntEquals(tc, _T("all hits paged"), all->scoreDocsLength, seen);
+
+    _CLLDELETE(all);
+    _CLLDELETE(query);
+    searcher.close();
+    ram.close();
+}
+
+
+void testArena(CuTest *tc) {
+    RAMDirectory ram;
+    WhitespaceAnalyzer an;
+    IndexWriter* writer = _CLNEW IndexWriter(&ram, &an, true);
+    Document doc;
+    for (int i = 0; i < 200; i++) {
+        TCHAR * tmp = English::IntToEnglish(i);
+        doc.add(* _CLNEW Field(_T("content"), tmp, Field::STORE_YES | Field::INDEX_TOKENIZED));
+        writer->addDocument(&doc);
+        doc.clear();
+        _CLDELETE_ARRAY( tmp );
+    }
+    writer->close();
+    _CLLDELETE(writer);
+
+    IndexReader* reader = IndexReader::open(&ram);
+    IndexSearcher searcher(reader);
+    IndexSearcher arenaSearcher(reader);
+    arenaSearcher.setUseArena(true);
+    CLUCENE_ASSERT( arenaSearcher.getUseArena() );
+
+    const TCHAR* queries[] = { _T("t* OR one"), _T("\"ninety nine\" OR hundred"), _T("+s* -seven"), NULL };
+    for (int32_t q = 0; queries[q] != NULL; q++) {
+        Query* query = QueryParser::parse(queries[q], _T("content"), &an);
+        TopDocs* expected = searcher._search(query, NULL, NULL, 20);
+        TopDocs* actual = arenaSearcher._search(query, NULL, NULL, 20);
+        CLUCENE_ASSERT( expected->totalHits > 0 );
+        CuAssertIntEquals(tc, _T("totalHits"), expected->totalHits, actual->totalHits);
+        CuAssertIntEquals(tc, _T("length"), expected->scoreDocsLength, actual->scoreDocsLength);
+        for (int32_t i = 0; i < expected->scoreDocsLength; i++) {
+            CuAssertIntEquals(tc, _T("doc"), expected->scoreDocs[i].doc, actual->scoreDocs[i].doc);
+            CLUCENE_ASSERT(expected->scoreDocs[i].score == actual->scoreDocs[i].score);
+        }
+        int32_t totalHits = expected->totalHits;
+        _CLLDELETE(expected);
+        _CLLDELETE(actual);
+
+        Hits* hits = arenaSearcher.search(query, arenaSearcher.getSimilarity());
+        CuAssertIntEquals(tc, _T("hits"), totalHits, (int32_t)hits->length());
+        _CLLDELETE(hits);
+        _CLLDELETE(query);
+    }
+
+    // the objects of a search come from the arena, if it is compiled in,
+    // and may outlive it
+    Query* query = QueryParser::parse(_T("t* OR one"), _T("content"), &an);
+    Arena* arena = Arena::begin();
+    CLUCENE_ASSERT( Arena::current() == arena );
+    Weight* weight = query->weight(&searcher, searcher.getSimilarity());
+    Scorer* scorer = weight->scorer(reader);
+#ifdef LUCENE_ENABLE_ARENA
+    CLUCENE_ASSERT( arena->getObjectCount() > 10 );
+    CLUCENE_ASSERT( arena->getBlockCount() < arena->getObjectCount() );
+#else
+    CuAssertIntEquals(tc, _T("objects"), 0, arena->getObjectCount());
+#endif
+    arena->end();
+    CLUCENE_ASSERT( Arena::current() == NULL );
+    CLUCENE_ASSERT( scorer->next() );
+    _CLLDELETE(scorer);
+    Query* wq = weight->getQuery();
+    if ( wq != query )
+        _CLLDELETE(wq);
+    _CLLDELETE(weight);
+    _CLLDELETE(query);
+
+    searcher.close();
+    arenaSearcher.close();
+    reader->close();
+    _CLLDELETE(reader);
+}
+
+void testQueryProfile(CuTest *tc) {
+    RAMDirectory ram;
+    WhitespaceAnalyzer an;
+    IndexWriter* writer = _CLNEW IndexWriter(&ram, &an, true);
+    Document doc;
+    for (int i = 0; i < 200; i++) {
+        TCHAR * tmp = English::IntToEnglish(i);
+        doc.add(* _CLNEW Field(_T("content"), tmp, Field::STORE_YES | Field::INDEX_TOKENIZED));
+        writer->addDocument(&doc);
+        doc.clear();
+        _CLDELETE_ARRAY( tmp );
+    }
+    writer->close();
+    _CLLDELETE(writer);
+
+    IndexSearcher searcher(&ram);
+    Query* query = QueryParser::parse(_T("+t* +hundred"), _T("content"), &an);
+    TopDocs* expected = searcher._search(query, NULL, NULL, 20);
+    CLUCENE_ASSERT( expected->totalHits > 0 );
+
+    QueryProfile profile;
+    TopDocs* actual = searcher._search(query, NULL, NULL, 20, profile);
+    CLUCENE_ASSERT( QueryProfile::current() == NULL );
+    CuAssertIntEquals(tc, _T("totalHits"), expected->totalHits, actual->totalHits);
+    CuAssertIntEquals(tc, _T("length"), expected->scoreDocsLength, actual->scoreDocsLength);
+    for (int32_t i = 0; i < expected->scoreDocsLength; i++) {
+        CuAssertIntEquals(tc, _T("doc"), expected->scoreDocs[i].doc, actual->scoreDocs[i].doc);
+        CLUCENE_ASSERT(expected->scoreDocs[i].score == actual->scoreDocs[i].score);
+    }
+
+    // the phases happen within the search
+    int64_t phases = 0;
+    for (int32_t i = 0; i < QueryProfile::PHASE_COUNT; i++) {
+        CLUCENE_ASSERT( profile.getPhaseMicros((QueryProfile::Phase)i) >= 0 );
+        phases += profile.getPhaseMicros((QueryProfile::Phase)i);
+    }
+    CLUCENE_ASSERT( phases <= profile.getTotalMicros() );
+    CLUCENE_ASSERT( profile.getTermLookups() > 0 );
+    CLUCENE_ASSERT( profile.getBytesRead() > 0 );
+
+    // +t* +hundred: a conjunction of the expanded prefix and a term
+    QueryProfile::Node* root = profile.getRoot();
+    CLUCENE_ASSERT( root != NULL );
+    CLUCENE_ASSERT( strcmp(root->getQueryClass(), "BooleanQuery") == 0 );
+    CuAssertIntEquals(tc, _T("root matches"), expected->totalHits, root->docsMatched);
+    CuAssertIntEquals(tc, _T("clauses"), 2, (int32_t)root->getChildCount());
+    QueryProfile::Node* prefix = root->getChild(0);
+    QueryProfile::Node* term = root->getChild(1);
+    CLUCENE_ASSERT( prefix->termsExpanded > 1 );
+    CuAssertIntEquals(tc, _T("expanded terms"), prefix->termsExpanded, (int32_t)prefix->getChildCount());
+    CuAssertStrEquals(tc, _T("term node"), _T("content:hundred"), term->getQuery());
+    CLUCENE_ASSERT( term->nextCalls + term->skipToCalls > 0 );
+    CLUCENE_ASSERT( term->docsMatched >= expected->totalHits );
+    CLUCENE_ASSERT( term->termLookups > 0 );
+
+    TCHAR* str = profile.toString();
+    CLUCENE_ASSERT( _tcsstr(str, _T("content:hundred")) != NULL );
+    _CLDELETE_LCARRAY(str);
+    _CLLDELETE(expected);
+    _CLLDELETE(actual);
+
+    // any search can be profiled between begin() and end()
+    Sort sort(_T("content"));
+    profile.begin();
+    CLUCENE_ASSERT( QueryProfile::current() == &profile );
+    Hits* hits = searcher.search(query, NULL, &sort);
+    profile.end();
+    CLUCENE_ASSERT( QueryProfile::current() == NULL );
+    CLUCENE_ASSERT( profile.getRoot() != NULL );
+    CuAssertIntEquals(tc, _T("sorted matches"), (int32_t)hits->length(), profile.getRoot()->docsMatched);
+    _CLLDELETE(hits);
+
+    _CLLDELETE(query);
+    searcher.close();
+    ram.close();
+}
 
 CuSuite *testIndexSearcher(void)
 {
     CuSuite *suite = CuSuiteNew(_T("CLucene IndexSearcher Test"));
 
     SUITE_ADD_TEST(suite, testEndThreadException);
+    SUITE_ADD_TEST(suite, testQueryResultCache);
+    SUITE_ADD_TEST(suite, testSearchAfter);
+    SUITE_ADD_TEST(suite, testArena);
+    SUITE_ADD_TEST(suite, testQueryProfile);
 
     return suite;
   }
@@ -336,6 +336,54 @@ void testFuzzyQuery(CuTest *tc){
 	}
 #endif
 
+static int32_t _countPhraseHits(IndexSearcher& searcher, const TCHAR** words, int32_t slop){
+	PhraseQuery* query = _CLNEW PhraseQuery();
+	for ( int32_t i = 0; words[i] != NULL; i++ ){
+		Term* t = _CLNEW Term(_T("field"), words[i]);
+		query->add(t);
+		_CLDECDELETE(t);
+	}
+	query->setSlop(slop);
+	Hits* hits = searcher.search(query, NULL);
+	int32_t ret = (int32_t)hits->length();
+	_CLLDELETE(hits);
+	_CLLDELETE(query);
+	return ret;
+}
+
+void testPhraseQuery(CuTest *tc){
+	WhitespaceAnalyzer analyzer;
+	RAMDirectory directory;
+	const TCHAR* docs[] = {_T("a b c a b"), _T("b a c"), _T("a a b"), _T("x y z"), _T("a x b")};
+
+	IndexWriter writer( &directory, &analyzer, true);
+	for (int i = 0; i < 5; i++) {
+		Document doc;
+		doc.add(*_CLNEW Field(_T("field"), docs[i], Field::STORE_YES | Field::INDEX_TOKENIZED));
+		writer.addDocument(&doc);
+	}
+	writer.close();
+
+	IndexSearcher searcher(&directory);
+	const TCHAR* ab[] = {_T("a"), _T("b"), NULL};
+	const TCHAR* aa[] = {_T("a"), _T("a"), NULL};
+	const TCHAR* ba[] = {_T("b"), _T("a"), NULL};
+	const TCHAR* ac[] = {_T("a"), _T("c"), NULL}; // rare term last
+	const TCHAR* cab[] = {_T("c"), _T("a"), _T("b"), NULL};
+	const TCHAR* za[] = {_T("z"), _T("a"), NULL};
+
+	CLUCENE_ASSERT(2 == _countPhraseHits(searcher, ab, 0));
+	CLUCENE_ASSERT(1 == _countPhraseHits(searcher, aa, 0));
+	CLUCENE_ASSERT(1 == _countPhraseHits(searcher, ba, 0));
+	CLUCENE_ASSERT(1 == _countPhraseHits(searcher, ac, 0));
+	CLUCENE_ASSERT(1 == _countPhraseHits(searcher, cab, 0));
+	CLUCENE_ASSERT(0 == _countPhraseHits(searcher, za, 0));
+	CLUCENE_ASSERT(3 == _countPhraseHits(searcher, ab, 1));
+	CLUCENE_ASSERT(4 == _countPhraseHits(searcher, ab, 2));
+
+	searcher.close();
+}
+
 void testMultiPhraseQuery( CuTest * tc )
 {
     MultiPhraseQuery * pQuery = _CLNEW MultiPhraseQuery();
@@ -370,6 +418,7 @@ CuSuite *testqueries(void)
 	CuSuite *suite = CuSuiteNew(_T("CLucene Queries Test"));
 
 	SUITE_ADD_TEST(suite, testPrefixQuery);
+	SUITE_ADD_TEST(suite, testPhraseQuery);
 	SUITE_ADD_TEST(suite, testMultiPhraseQuery);
 	#ifndef NO_FUZZY_QUERY
 		SUITE_ADD_TEST(suite, testFuzzyQuery);
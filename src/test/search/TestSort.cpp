@@ -525,6 +525,71 @@ void testNormalizedScores(CuTest *tc) {
 	_CLDELETE(scoresA);
 }
 
+// compares two sorts that must produce the same hits in the same order
+void sortSameOrder (CuTest* tc, Searcher* searcher, Query* query, Sort* sort1, Sort* sort2){
+	Hits* h1 = searcher->search (query, NULL, sort1);
+	Hits* h2 = searcher->search (query, NULL, sort2);
+	CuAssertIntEquals (tc, _T("hit count"), h1->length(), h2->length());
+	for (size_t i=0; i<h1->length(); ++i) {
+		CuAssertIntEquals (tc, _T("hit order"), h1->id(i), h2->id(i));
+		CuAssert (tc, _T("hit score"), h1->score(i) == h2->score(i));
+	}
+	_CLDELETE(h1);
+	_CLDELETE(h2);
+}
+
+// the single field sorts are collected by a specialized collector, sorts with
+// more criteria by FieldSortedHitQueue. Both must agree.
+void testSingleFieldSorts(CuTest *tc) {
+	RAMDirectory dir;
+	WhitespaceAnalyzer an;
+	IndexWriter writer(&dir, &an, true);
+	TCHAR buf[32];
+	for (int i=0; i<300; ++i) {
+		Document doc;
+		_itot((i*7)%13, buf, 10);
+		doc.add (*_CLNEW Field (_T("int"), buf, Field::INDEX_UNTOKENIZED));
+		_sntprintf(buf, 32, _T("%d.5"), (i*11)%17);
+		doc.add (*_CLNEW Field (_T("float"), buf, Field::INDEX_UNTOKENIZED));
+		_sntprintf(buf, 32, _T("s%d"), (i*5)%23);
+		doc.add (*_CLNEW Field (_T("string"), buf, Field::INDEX_UNTOKENIZED));
+		doc.add (*_CLNEW Field (_T("contents"), (i%3)==0 ? _T("a a b") : ((i%3)==1 ? _T("a b c d") : _T("a")), Field::INDEX_TOKENIZED));
+		writer.addDocument (&doc);
+	}
+	writer.close();
+
+	IndexSearcher searcher(&dir);
+	Term* t = _CLNEW Term (_T("contents"), _T("a"));
+	TermQuery query(t);
+	_CLDECDELETE(t);
+
+	const TCHAR* names[3] = { _T("int"), _T("float"), _T("string") };
+	int32_t types[3] = { SortField::INT, SortField::FLOAT, SortField::STRING };
+	for (int f=0; f<3; ++f) {
+		for (int r=0; r<2; ++r) {
+			// secondary criterion: none, score, index order, reversed score
+			for (int x=0; x<4; ++x) {
+				int32_t tieType = x == 1 || x == 3 ? SortField::DOCSCORE : SortField::DOC;
+				SortField* fast[3] = { _CLNEW SortField (names[f], f==0 ? SortField::AUTO : types[f], r==1), NULL, NULL };
+				SortField* slow[4] = { _CLNEW SortField (names[f], types[f], r==1), NULL, NULL, NULL };
+				if ( x == 0 ){
+					slow[1] = _CLNEW SortField (NULL, SortField::DOC, false);
+					slow[2] = _CLNEW SortField (NULL, SortField::DOC, false);
+				}else{
+					fast[1] = _CLNEW SortField (NULL, tieType, x==3);
+					slow[1] = _CLNEW SortField (NULL, tieType, x==3);
+					slow[2] = _CLNEW SortField (NULL, SortField::DOC, false);
+				}
+				Sort fastSort(fast);
+				Sort slowSort(slow);
+				sortSameOrder(tc, &searcher, &query, &fastSort, &slowSort);
+			}
+		}
+	}
+	searcher.close();
+	dir.close();
+}
+
 CuSuite *testsort(void)
 {
 	CuSuite *suite = CuSuiteNew(_T("CLucene Sort Test"));
@@ -540,6 +605,7 @@ CuSuite *testsort(void)
 	SUITE_ADD_TEST(suite, testMultiSort);
 	SUITE_ADD_TEST(suite, testNormalizedScores);
 	SUITE_ADD_TEST(suite, testReverseSort);
+	SUITE_ADD_TEST(suite, testSingleFieldSorts);
 
     SUITE_ADD_TEST(suite, testSortCleanup);
     return suite;
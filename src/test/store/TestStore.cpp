@@ -7,6 +7,8 @@
 #include "test.h"
 #include "CLucene/store/Directory.h"
 #include "CLucene/store/IndexInput.h"
+#include "CLucene/store/StatsDirectory.h"
+#include "CLucene/search/TermQuery.h"
 #include <stdlib.h>
 
 
@@ -110,6 +112,228 @@ void mmaptest(CuTest *tc){
 	StoreTest(tc,100,3);
 }
 
+/** copyBytes between two FSDirectory files must behave like the buffered copy */
+void fscopybytestest(CuTest *tc){
+	char fsdir[CL_MAX_PATH];
+	_snprintf(fsdir, CL_MAX_PATH, "%s/%s",cl_tempDir, "test.copybytes");
+	Directory* store = FSDirectory::getDirectory(fsdir);
+	const int32_t length = 100000;
+
+	IndexOutput* src = store->createOutput("src.dat");
+	for (int32_t i = 0; i < length; i++)
+		src->writeByte((uint8_t)(i % 251));
+	src->close();
+	_CLDELETE(src);
+
+	IndexInput* in = store->openInput("src.dat");
+	IndexOutput* out = store->createOutput("dst.dat");
+	out->writeInt(12345);          // still buffered when the copy starts
+	in->seek(10);
+	in->readByte();                // the input has its own buffer too
+	out->copyBytes(in, 50000);
+	CuAssertIntEquals(tc, _T("input position"), 50011, (int32_t)in->getFilePointer());
+	CuAssertIntEquals(tc, _T("output position"), 50004, (int32_t)out->getFilePointer());
+	CuAssertIntEquals(tc, _T("next byte"), 50011 % 251, in->readByte());
+	out->copyBytes(in, length - 50012); // up to the end of the input
+	CuAssertIntEquals(tc, _T("input position"), length, (int32_t)in->getFilePointer());
+	out->writeInt(54321);
+	out->close();
+	_CLDELETE(out);
+	in->close();
+	_CLDELETE(in);
+
+	in = store->openInput("dst.dat");
+	CuAssertIntEquals(tc, _T("copied length"), 4 + (length - 12) + 4, (int32_t)in->length());
+	CuAssertIntEquals(tc, _T("head"), 12345, in->readInt());
+	for (int32_t i = 11; i < length; i++){
+		if ( i == 50011 )
+			continue;
+		if ( in->readByte() != (uint8_t)(i % 251) )
+			CuFail(tc, _T("copied bytes differ"));
+	}
+	CuAssertIntEquals(tc, _T("tail"), 54321, in->readInt());
+	in->close();
+	_CLDELETE(in);
+
+	store->deleteFile("src.dat");
+	store->deleteFile("dst.dat");
+	store->close();
+	_CLDECDELETE(store);
+}
+
+/** strings must survive the bulk UTF-8 conversion, also when split over buffers */
+void StringsTest(CuTest *tc, int mode){
+	char fsdir[CL_MAX_PATH];
+	_snprintf(fsdir, CL_MAX_PATH, "%s/%s",cl_tempDir, "test.strings");
+	Directory* store;
+	if ( mode == 1 )
+		store = _CLNEW RAMDirectory();
+	else{
+		store = FSDirectory::getDirectory(fsdir);
+		((FSDirectory*)store)->setUseMMap(mode == 3);
+	}
+
+	const int32_t count = 3000;
+	TCHAR str[100];
+	int64_t bytes = 0;
+	IndexOutput* out = store->createOutput("strings.dat");
+	for (int32_t i = 0; i < count; i++){
+		int32_t len = i % 97;
+		for (int32_t j = 0; j < len; j++){
+#ifdef _UCS2
+			switch ( (i + j) % 11 ){
+				case 3: str[j] = 0xE9; bytes += 2; break;
+				case 7: str[j] = 0x20AC; bytes += 3; break;
+				default: str[j] = _T('a') + j % 26; bytes++;
+			}
+#else
+			str[j] = _T('a') + j % 26;
+			bytes++;
+#endif
+		}
+		out->writeString(str, len);
+		bytes++; //the length
+	}
+	out->close();
+	_CLDELETE(out);
+
+	IndexInput* in = store->openInput("strings.dat");
+	CuAssertIntEquals(tc, _T("encoded length"), (int32_t)bytes, (int32_t)in->length());
+	TCHAR expected[100];
+	TCHAR buf[10];
+	for (int32_t i = 0; i < count; i++){
+		int32_t len = i % 97;
+		for (int32_t j = 0; j < len; j++){
+#ifdef _UCS2
+			switch ( (i + j) % 11 ){
+				case 3: expected[j] = 0xE9; break;
+				case 7: expected[j] = 0x20AC; break;
+				default: expected[j] = _T('a') + j % 26;
+			}
+#else
+			expected[j] = _T('a') + j % 26;
+#endif
+		}
+		expected[len] = 0;
+		if ( i % 3 == 0 ){
+			//truncated read, the rest of the string is skipped
+			int32_t l = in->readString(buf, 10);
+			CuAssertIntEquals(tc, _T("truncated length"), len < 9 ? len : 9, l);
+			if ( _tcsncmp(buf, expected, l) != 0 )
+				CuFail(tc, _T("truncated string %d differs"), i);
+		}else{
+			TCHAR* read = in->readString();
+			if ( _tcscmp(read, expected) != 0 )
+				CuFail(tc, _T("string %d differs"), i);
+			_CLDELETE_LCARRAY(read);
+		}
+	}
+	CuAssertIntEquals(tc, _T("position"), (int32_t)bytes, (int32_t)in->getFilePointer());
+	in->close();
+	_CLDELETE(in);
+
+	store->deleteFile("strings.dat");
+	store->close();
+	_CLDECDELETE(store);
+}
+void stringstest(CuTest *tc){
+	StringsTest(tc,1);
+	StringsTest(tc,2);
+	StringsTest(tc,3);
+}
+
+void statsdirtest(CuTest *tc){
+	CuAssertTrue(tc, IOStats::fileType("_0.tis") == "tis", _T("file type of _0.tis"));
+	CuAssertTrue(tc, IOStats::fileType("_1_2.s13") == "sN", _T("file type of _1_2.s13"));
+	CuAssertTrue(tc, IOStats::fileType("_1.f0") == "fN", _T("file type of _1.f0"));
+	CuAssertTrue(tc, IOStats::fileType("segments_a") == "segments", _T("file type of segments_a"));
+	CuAssertTrue(tc, IOStats::fileType("segments.gen") == "gen", _T("file type of segments.gen"));
+
+	RAMDirectory* ram = _CLNEW RAMDirectory();
+	StatsDirectory* dir = _CLNEW StatsDirectory(ram);
+	IOStats* stats = dir->getStats();
+
+	// a file that spans several buffers
+	const int32_t LENGTH = 50000;
+	IndexOutput* out = dir->createOutput("_1.frq");
+	for ( int32_t i=0;i<LENGTH;i++ )
+		out->writeByte((uint8_t)(i % 251));
+	out->close();
+	_CLDELETE(out);
+	CuAssertTrue(tc, dir->fileLength("_1.frq") == LENGTH, _T("file length"));
+
+	IndexInput* in = ((Directory*)dir)->openInput("_1.frq");
+	for ( int32_t i=0;i<LENGTH;i++ ){
+		if ( in->readByte() != (uint8_t)(i % 251) )
+			CuFail(tc, _T("byte %d differs"), i);
+	}
+	in->seek(LENGTH - 10);	// inside the last buffer
+	CuAssertIntEquals(tc, _T("byte after seek"), (LENGTH - 10) % 251, in->readByte());
+	in->seek(100);			// needs a read
+	CuAssertIntEquals(tc, _T("byte after seek"), 100, in->readByte());
+	IndexInput* clone = in->clone();
+	CuAssertIntEquals(tc, _T("byte of clone"), 101, clone->readByte());
+	clone->close();
+	_CLDELETE(clone);
+	in->close();
+	_CLDELETE(in);
+
+	IOStats::Snapshot snapshot;
+	stats->snapshot(snapshot);
+	CuAssertIntEquals(tc, _T("file types"), 1, (int32_t)snapshot.size());
+	const IOStats::Counters& frq = snapshot["frq"];
+	CuAssertIntEquals(tc, _T("creates"), 1, (int32_t)frq.creates);
+	CuAssertIntEquals(tc, _T("write bytes"), LENGTH, (int32_t)frq.writeBytes);
+	CuAssertIntEquals(tc, _T("opens"), 1, (int32_t)frq.opens);
+	CuAssertTrue(tc, frq.readBytes > LENGTH, _T("read bytes include the read after the seek"));
+	CuAssertIntEquals(tc, _T("seeks"), 2, (int32_t)frq.seeks);
+	CuAssertIntEquals(tc, _T("seek hits"), 1, (int32_t)frq.seekHits);
+	int64_t histogram = 0;
+	for ( int32_t i=0;i<IOStats::LATENCY_BUCKETS;i++ )
+		histogram += frq.readLatency[i];
+	CuAssertTrue(tc, histogram == frq.readCalls, _T("every read is in the histogram"));
+	CuAssertTrue(tc, IOStats::Counters::percentile(frq.readLatency, 99) >= 1, _T("read percentile"));
+
+	stats->reset();
+	CuAssertTrue(tc, stats->getTotal().readBytes == 0, _T("read bytes after reset"));
+
+	// an index in a compound file: its files count for their own type
+	WhitespaceAnalyzer an;
+	IndexWriter* writer = _CLNEW IndexWriter(dir, &an, true);
+	for ( int32_t i=0;i<100;i++ ){
+		Document doc;
+		doc.add(*_CLNEW Field(_T("content"), i % 2 == 0 ? _T("even number") : _T("odd number"), Field::STORE_YES | Field::INDEX_TOKENIZED));
+		writer->addDocument(&doc);
+	}
+	writer->close();
+	_CLDELETE(writer);
+
+	stats->reset();
+	IndexReader* reader = IndexReader::open(dir);
+	IndexSearcher searcher(reader);
+	Term* t = _CLNEW Term(_T("content"), _T("even"));
+	TermQuery q(t);
+	_CLDECDELETE(t);
+	Hits* hits = searcher.search(&q, NULL);
+	CuAssertIntEquals(tc, _T("hits"), 50, (int32_t)hits->length());
+	_CLDELETE(hits);
+	searcher.close();
+	reader->close();
+	_CLDELETE(reader);
+
+	snapshot.clear();
+	stats->snapshot(snapshot);
+	CuAssertTrue(tc, snapshot["tis"].readBytes > 0, _T("term infos read"));
+	CuAssertTrue(tc, snapshot["frq"].readBytes > 0, _T("frequencies read"));
+	CuAssertTrue(tc, snapshot["cfs"].readBytes == 0, _T("compound file not counted twice"));
+	CuAssertTrue(tc, stats->toString().find("tis: opens=") != std::string::npos, _T("toString"));
+
+	dir->close();
+	_CLDECDELETE(dir);
+	ram->close();
+	_CLDECDELETE(ram);
+}
+
 CuSuite *teststore(void)
 {
 	CuSuite *suite = CuSuiteNew(_T("CLucene Store Test"));
@@ -117,6 +341,9 @@ CuSuite *teststore(void)
     SUITE_ADD_TEST(suite, ramtest);
     SUITE_ADD_TEST(suite, fstest);
     SUITE_ADD_TEST(suite, mmaptest);
+    SUITE_ADD_TEST(suite, fscopybytestest);
+    SUITE_ADD_TEST(suite, stringstest);
+    SUITE_ADD_TEST(suite, statsdirtest);
 
     return suite;
 }